@@ -0,0 +1,344 @@
+/*
+ * Copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Micro benchmarks of SampleBuffer operations and dsp library kernels for all
+ *        supported chunk sizes. Use --benchmark_format=json or --benchmark_out=<file>
+ *        for machine readable output.
+ * @copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "library/sample_buffer.h"
+#include "dsp_library/biquad_filter.h"
+#include "dsp_library/multichannel_biquad_filter.h"
+#include "dsp_library/master_limiter.h"
+#include "dsp_library/value_smoother.h"
+
+using namespace sushi;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+constexpr int   NOISE_SEED = 5;
+
+template <int size>
+void fill_with_noise(SampleBuffer<size>& buffer)
+{
+    std::ranlux24 rand_gen;
+    rand_gen.seed(NOISE_SEED);
+    std::uniform_real_distribution<float> dist(-1.1f, 1.1f);
+    for (int c = 0; c < buffer.channel_count(); ++c)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            buffer.channel(c)[i] = dist(rand_gen);
+        }
+    }
+}
+
+template <int size>
+void set_processed_samples(benchmark::State& state, int channels)
+{
+    state.SetItemsProcessed(state.iterations() * size * channels);
+    state.counters["chunk_size"] = size;
+}
+
+/*
+ * SampleBuffer kernels
+ */
+template <int size>
+void BM_SampleBufferAddWithGain(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> source(channels);
+    SampleBuffer<size> dest(channels);
+    fill_with_noise(source);
+    /* Alternating the sign of the gain keeps dest bounded */
+    float gain = 0.5f;
+    for (auto _ : state)
+    {
+        gain = -gain;
+        dest.add_with_gain(source, gain);
+        benchmark::DoNotOptimize(dest.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_SampleBufferAddWithRamp(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> source(channels);
+    SampleBuffer<size> dest(channels);
+    fill_with_noise(source);
+    float sign = 1.0f;
+    for (auto _ : state)
+    {
+        sign = -sign;
+        dest.add_with_ramp(source, 0.2f * sign, 0.8f * sign);
+        benchmark::DoNotOptimize(dest.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_SampleBufferRamp(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    fill_with_noise(buffer);
+    /* Unity gain keeps the data stable, volatile so the ramp is not optimised away */
+    volatile float gain = 1.0f;
+    for (auto _ : state)
+    {
+        buffer.ramp(gain, gain);
+        benchmark::DoNotOptimize(buffer.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_SampleBufferFromInterleaved(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    std::vector<float> interleaved(size * channels, 0.5f);
+    for (auto _ : state)
+    {
+        buffer.from_interleaved(interleaved.data());
+        benchmark::DoNotOptimize(buffer.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_SampleBufferToInterleaved(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    fill_with_noise(buffer);
+    std::vector<float> interleaved(size * channels);
+    for (auto _ : state)
+    {
+        buffer.to_interleaved(interleaved.data());
+        benchmark::DoNotOptimize(interleaved.data());
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_SampleBufferCountClippedSamples(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    fill_with_noise(buffer);
+    for (auto _ : state)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            benchmark::DoNotOptimize(buffer.count_clipped_samples(c));
+        }
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_SampleBufferCalcPeakValue(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    fill_with_noise(buffer);
+    for (auto _ : state)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            benchmark::DoNotOptimize(buffer.calc_peak_value(c));
+        }
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_SampleBufferCalcRmsValue(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    fill_with_noise(buffer);
+    for (auto _ : state)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            benchmark::DoNotOptimize(buffer.calc_rms_value(c));
+        }
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+/*
+ * Dsp library kernels, processed per channel as in the plugins using them
+ */
+template <int size>
+void BM_BiquadFilterProcess(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    SampleBuffer<size> output(channels);
+    fill_with_noise(buffer);
+    dsp::biquad::Coefficients coefficients;
+    dsp::biquad::calc_biquad_peak(coefficients, TEST_SAMPLE_RATE, 1000.0f, 1.0f, 2.0f);
+    std::vector<dsp::biquad::BiquadFilter> filters(channels);
+    for (auto& filter : filters)
+    {
+        filter.set_smoothing(size);
+        filter.set_coefficients(coefficients);
+    }
+    for (auto _ : state)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            filters[c].process(buffer.channel(c), output.channel(c), size);
+        }
+        benchmark::DoNotOptimize(output.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_MultiChannelBiquadFilterProcess(benchmark::State& state)
+{
+    constexpr int MAX_CHANNELS = 8;
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    SampleBuffer<size> output(channels);
+    fill_with_noise(buffer);
+    dsp::biquad::Coefficients coefficients;
+    dsp::biquad::calc_biquad_peak(coefficients, TEST_SAMPLE_RATE, 1000.0f, 1.0f, 2.0f);
+    dsp::biquad::MultiChannelBiquadFilter<MAX_CHANNELS> filter;
+    filter.set_coefficients(coefficients);
+    filter.reset();
+    const float* in_ptrs[MAX_CHANNELS];
+    float* out_ptrs[MAX_CHANNELS];
+    for (int c = 0; c < channels; ++c)
+    {
+        in_ptrs[c] = buffer.channel(c);
+        out_ptrs[c] = output.channel(c);
+    }
+    for (auto _ : state)
+    {
+        filter.process(in_ptrs, out_ptrs, channels, size);
+        benchmark::DoNotOptimize(output.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_MasterLimiterProcess(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    SampleBuffer<size> output(channels);
+    fill_with_noise(buffer);
+    std::vector<dsp::MasterLimiter<size>> limiters(channels);
+    for (auto& limiter : limiters)
+    {
+        limiter.init(TEST_SAMPLE_RATE);
+    }
+    for (auto _ : state)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            limiters[c].process(buffer.channel(c), output.channel(c));
+        }
+        benchmark::DoNotOptimize(output.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size, class Smoother>
+void BM_ValueSmoother(benchmark::State& state)
+{
+    int channels = state.range(0);
+    SampleBuffer<size> buffer(channels);
+    SampleBuffer<size> output(channels);
+    fill_with_noise(buffer);
+    Smoother smoother(std::chrono::milliseconds(10), TEST_SAMPLE_RATE);
+    float target = 1.0f;
+    for (auto _ : state)
+    {
+        target = 1.0f - target;
+        smoother.set(target);
+        for (int c = 0; c < channels; ++c)
+        {
+            const float* in = buffer.channel(c);
+            float* out = output.channel(c);
+            for (int i = 0; i < size; ++i)
+            {
+                out[i] = in[i] * smoother.next_value();
+            }
+        }
+        benchmark::DoNotOptimize(output.channel(0));
+        benchmark::ClobberMemory();
+    }
+    set_processed_samples<size>(state, channels);
+}
+
+template <int size>
+void BM_ValueSmootherRamp(benchmark::State& state)
+{
+    BM_ValueSmoother<size, ValueSmootherRamp<float>>(state);
+}
+
+template <int size>
+void BM_ValueSmootherFilter(benchmark::State& state)
+{
+    BM_ValueSmoother<size, ValueSmootherFilter<float>>(state);
+}
+
+/* Register a benchmark for all supported chunk sizes (8 - 512) with 1, 2 and 8 channels */
+#define SUSHI_KERNEL_BENCHMARK(function) \
+    BENCHMARK_TEMPLATE(function, 8)->Arg(1)->Arg(2)->Arg(8); \
+    BENCHMARK_TEMPLATE(function, 16)->Arg(1)->Arg(2)->Arg(8); \
+    BENCHMARK_TEMPLATE(function, 32)->Arg(1)->Arg(2)->Arg(8); \
+    BENCHMARK_TEMPLATE(function, 64)->Arg(1)->Arg(2)->Arg(8); \
+    BENCHMARK_TEMPLATE(function, 128)->Arg(1)->Arg(2)->Arg(8); \
+    BENCHMARK_TEMPLATE(function, 256)->Arg(1)->Arg(2)->Arg(8); \
+    BENCHMARK_TEMPLATE(function, 512)->Arg(1)->Arg(2)->Arg(8)
+
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferAddWithGain);
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferAddWithRamp);
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferRamp);
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferFromInterleaved);
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferToInterleaved);
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferCountClippedSamples);
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferCalcPeakValue);
+SUSHI_KERNEL_BENCHMARK(BM_SampleBufferCalcRmsValue);
+SUSHI_KERNEL_BENCHMARK(BM_BiquadFilterProcess);
+SUSHI_KERNEL_BENCHMARK(BM_MultiChannelBiquadFilterProcess);
+SUSHI_KERNEL_BENCHMARK(BM_MasterLimiterProcess);
+SUSHI_KERNEL_BENCHMARK(BM_ValueSmootherRamp);
+SUSHI_KERNEL_BENCHMARK(BM_ValueSmootherFilter);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Headless benchmark that runs the engine as fast as possible with a given
+ *        configuration and reports throughput and processing costs.
+ * @copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include <unistd.h>
+
+#pragma GCC diagnostic ignored "-Wtype-limits"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#pragma GCC diagnostic pop
+
+#include "engine/audio_engine.h"
+#include "engine/json_configurator.h"
+#include "compile_time_settings.h"
+
+using namespace sushi;
+
+constexpr int   DEFAULT_CHUNKS = 10000;
+constexpr int   DEFAULT_WARMUP_CHUNKS = 100;
+constexpr int   BENCH_CHANNELS = 10;
+constexpr float INPUT_NOISE_LEVEL = 0.063f; // -24 dB input noise
+constexpr int   NOISE_SEED = 5;
+
+enum BenchOptionIndex
+{
+    BENCH_IDX_UNKNOWN,
+    BENCH_IDX_HELP,
+    BENCH_IDX_CONFIG_FILE,
+    BENCH_IDX_CHUNKS,
+    BENCH_IDX_WARMUP,
+    BENCH_IDX_CORES,
+    BENCH_IDX_TRACK_COPIES,
+    BENCH_IDX_TIMINGS
+};
+
+const optionparser::Descriptor bench_usage[] =
+{
+    {BENCH_IDX_UNKNOWN, 0, "", "", SushiArg::Unknown,
+     "\nUSAGE: sushi_bench -c <config file> [options]\n\n"
+     "Runs the engine as fast as possible and reports its performance.\n\nOptions:"},
+    {BENCH_IDX_HELP, 0, "h?", "help", SushiArg::Optional,
+     "\t\t-h --help \tPrint usage and exit."},
+    {BENCH_IDX_CONFIG_FILE, 0, "c", "config-file", SushiArg::NonEmpty,
+     "\t\t-c <filename>, --config-file=<filename> \tSpecify configuration JSON file."},
+    {BENCH_IDX_CHUNKS, 0, "n", "chunks", SushiArg::Numeric,
+     "\t\t-n <n>, --chunks=<n> \tNumber of audio chunks to process [default n=10000]."},
+    {BENCH_IDX_WARMUP, 0, "w", "warmup", SushiArg::Numeric,
+     "\t\t-w <n>, --warmup=<n> \tNumber of chunks to process before measuring [default n=100]."},
+    {BENCH_IDX_CORES, 0, "m", "multicore-processing", SushiArg::Numeric,
+     "\t\t-m <n>, --multicore-processing=<n> \tProcess audio multithreaded with n cores [default n=1 (off)]."},
+    {BENCH_IDX_TRACK_COPIES, 0, "t", "track-copies", SushiArg::Numeric,
+     "\t\t-t <n>, --track-copies=<n> \tInstantiate every track in the configuration n times [default n=1]."},
+    {BENCH_IDX_TIMINGS, 0, "", "timing-statistics", SushiArg::Optional,
+     "\t\t--timing-statistics \tMeasure and print the processing cost of every track and processor."},
+    {0, 0, 0, 0, 0, 0}
+};
+
+void error_exit(const std::string& message)
+{
+    std::cerr << message << std::endl;
+    std::exit(1);
+}
+
+/**
+ * @brief Write a copy of a config file where every track, and the plugins on it, are
+ *        instantiated copies times, with the copies' names suffixed with their index.
+ *        The copy is written next to the original, so that relative paths in it still
+ *        resolve, and its name includes the process id so that concurrent runs don't
+ *        clash. The caller should delete it when loaded.
+ * @return The path of the new config file
+ */
+std::string replicate_tracks(const std::string& config_filename, int copies)
+{
+    std::ifstream in_file(config_filename);
+    if (!in_file.good())
+    {
+        error_exit("Failed to open config file: " + config_filename);
+    }
+    std::string config_file_contents((std::istreambuf_iterator<char>(in_file)), std::istreambuf_iterator<char>());
+    rapidjson::Document config;
+    config.Parse(config_file_contents.c_str());
+    if (config.HasParseError() || config.HasMember("tracks") == false)
+    {
+        error_exit("Invalid config file: " + config_filename);
+    }
+
+    auto& allocator = config.GetAllocator();
+    auto& tracks = config["tracks"];
+    auto original_track_count = tracks.Size();
+    for (int copy = 1; copy < copies; ++copy)
+    {
+        auto suffix = "_" + std::to_string(copy);
+        for (rapidjson::SizeType i = 0; i < original_track_count; ++i)
+        {
+            rapidjson::Value track(tracks[i], allocator);
+            auto name = std::string(track["name"].GetString()) + suffix;
+            track["name"].SetString(name.c_str(), allocator);
+            for (auto& plugin : track["plugins"].GetArray())
+            {
+                name = std::string(plugin["name"].GetString()) + suffix;
+                plugin["name"].SetString(name.c_str(), allocator);
+            }
+            tracks.PushBack(track, allocator);
+        }
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    config.Accept(writer);
+
+    auto path = std::filesystem::path(config_filename);
+    path.replace_filename("." + path.stem().string() + "_bench_" + std::to_string(getpid()) + ".json");
+    std::ofstream out_file(path);
+    out_file << buffer.GetString();
+    if (!out_file.good())
+    {
+        error_exit("Failed to write config file: " + path.string());
+    }
+    return path.string();
+}
+
+void print_node_timings(performance::BasePerformanceTimer* timer, int id, const std::string& name, double period_us)
+{
+    auto timings = timer->timings_for_node(id);
+    if (timings.has_value())
+    {
+        std::cout << std::setw(32) << name
+                  << std::setw(14) << timings->avg_case * period_us
+                  << std::setw(14) << timings->avg_case * 100.0
+                  << std::setw(14) << timings->p99_case * 100.0
+                  << std::setw(14) << timings->max_case * 100.0 << "\n";
+    }
+}
+
+void print_timings(engine::AudioEngine* engine, double period_us)
+{
+    auto timer = engine->performance_timer();
+    auto processors = engine->processor_container();
+    std::cout << "\nProcessing cost per chunk:\n" << std::left
+              << std::setw(32) << "" << std::setw(14) << "average(us)" << std::setw(14) << "average(%)"
+              << std::setw(14) << "p99(%)" << std::setw(14) << "maximum(%)" << "\n";
+
+    for (const auto& track : processors->all_tracks())
+    {
+        std::cout << "Track: " << track->name() << "\n";
+        for (const auto& processor : processors->processors_on_track(track->id()))
+        {
+            print_node_timings(timer, processor->id(), "    " + processor->name(), period_us);
+        }
+        print_node_timings(timer, track->id(), "    Track total", period_us);
+    }
+    print_node_timings(timer, engine::ENGINE_TIMING_ID, "Engine total", period_us);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 0)
+    {
+        argc--;
+        argv++;
+    }
+
+    optionparser::Stats cl_stats(bench_usage, argc, argv);
+    std::vector<optionparser::Option> cl_options(cl_stats.options_max);
+    std::vector<optionparser::Option> cl_buffer(cl_stats.buffer_max);
+    optionparser::Parser cl_parser(bench_usage, argc, argv, &cl_options[0], &cl_buffer[0]);
+
+    if (cl_parser.error())
+    {
+        return 1;
+    }
+    if (cl_options[BENCH_IDX_HELP] || cl_options[BENCH_IDX_CONFIG_FILE] == nullptr)
+    {
+        optionparser::printUsage(fwrite, stdout, bench_usage);
+        return cl_options[BENCH_IDX_HELP] ? 0 : 1;
+    }
+
+    std::string config_filename = cl_options[BENCH_IDX_CONFIG_FILE].last()->arg;
+    int chunks = cl_options[BENCH_IDX_CHUNKS] ? atoi(cl_options[BENCH_IDX_CHUNKS].last()->arg) : DEFAULT_CHUNKS;
+    int warmup_chunks = cl_options[BENCH_IDX_WARMUP] ? atoi(cl_options[BENCH_IDX_WARMUP].last()->arg) : DEFAULT_WARMUP_CHUNKS;
+    int cores = cl_options[BENCH_IDX_CORES] ? atoi(cl_options[BENCH_IDX_CORES].last()->arg) : 1;
+    int track_copies = cl_options[BENCH_IDX_TRACK_COPIES] ? atoi(cl_options[BENCH_IDX_TRACK_COPIES].last()->arg) : 1;
+    bool enable_timings = cl_options[BENCH_IDX_TIMINGS] != nullptr;
+
+    if (chunks < 1 || cores < 1 || track_copies < 1 || warmup_chunks < 0)
+    {
+        error_exit("Invalid benchmark arguments");
+    }
+    std::string load_filename = config_filename;
+    if (track_copies > 1)
+    {
+        load_filename = replicate_tracks(config_filename, track_copies);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Set up engine and load configuration //
+    ////////////////////////////////////////////////////////////////////////////////
+
+    auto engine = std::make_unique<engine::AudioEngine>(CompileTimeSettings::sample_rate_default, cores);
+    auto midi_dispatcher = std::make_unique<midi_dispatcher::MidiDispatcher>(engine->event_dispatcher());
+    auto configurator = std::make_unique<jsonconfig::JsonConfigurator>(engine.get(),
+                                                                       midi_dispatcher.get(),
+                                                                       engine->processor_container(),
+                                                                       load_filename);
+
+    auto [audio_config_status, audio_config] = configurator->load_audio_config();
+    /* The configurator reads the whole file on the first load */
+    if (load_filename != config_filename)
+    {
+        std::filesystem::remove(load_filename);
+    }
+    if (audio_config_status != jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        error_exit("Error reading config file: " + config_filename);
+    }
+    engine->set_audio_input_channels(BENCH_CHANNELS);
+    engine->set_audio_output_channels(BENCH_CHANNELS);
+    engine->set_cv_input_channels(audio_config.cv_inputs.value_or(0));
+    engine->set_cv_output_channels(audio_config.cv_outputs.value_or(0));
+    engine->set_output_latency(std::chrono::microseconds(0));
+
+    if (configurator->load_host_config() != jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        error_exit("Failed to load host configuration from config file");
+    }
+    if (configurator->load_tracks() != jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        error_exit("Failed to load tracks from config file");
+    }
+    configurator.reset();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Run //
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ChunkSampleBuffer in_buffer(BENCH_CHANNELS);
+    ChunkSampleBuffer out_buffer(BENCH_CHANNELS);
+    engine::ControlBuffer in_controls;
+    engine::ControlBuffer out_controls;
+
+    std::ranlux24 rand_gen;
+    rand_gen.seed(NOISE_SEED);
+    std::normal_distribution<float> normal_dist(0.0f, INPUT_NOISE_LEVEL);
+    for (int c = 0; c < in_buffer.channel_count(); ++c)
+    {
+        for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+        {
+            in_buffer.channel(c)[i] = normal_dist(rand_gen);
+        }
+    }
+
+    double period_us = AUDIO_CHUNK_SIZE * 1'000'000.0 / engine->sample_rate();
+    engine->event_dispatcher()->run();
+    engine->enable_realtime(true);
+
+    int samplecount = 0;
+    auto process = [&](int chunk_count)
+    {
+        for (int i = 0; i < chunk_count; ++i)
+        {
+            auto process_time = std::chrono::microseconds(static_cast<int64_t>(samplecount / AUDIO_CHUNK_SIZE * period_us));
+            engine->process_chunk(&in_buffer, &out_buffer, &in_controls, &out_controls, process_time, samplecount);
+            samplecount += AUDIO_CHUNK_SIZE;
+        }
+    };
+
+    process(warmup_chunks);
+    if (enable_timings)
+    {
+        engine->performance_timer()->enable(true);
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    process(chunks);
+    std::chrono::duration<double> run_time = std::chrono::steady_clock::now() - start_time;
+    if (enable_timings)
+    {
+        engine->performance_timer()->enable(false);
+    }
+
+    engine->enable_realtime(false);
+    engine->event_dispatcher()->stop();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Report //
+    ////////////////////////////////////////////////////////////////////////////////
+
+    double audio_time = chunks * period_us / 1'000'000.0;
+    std::cout << std::left
+              << "Configuration:      " << config_filename << "\n"
+              << "Tracks:             " << engine->processor_container()->all_tracks().size() << "\n"
+              << "Cores:              " << cores << "\n"
+              << "Audio chunk size:   " << AUDIO_CHUNK_SIZE << " samples (" << period_us << "us)\n"
+              << "Chunks processed:   " << chunks << "\n"
+              << "Processing time:    " << run_time.count() << "s\n"
+              << "Chunks/second:      " << chunks / run_time.count() << "\n"
+              << "Time per chunk:     " << run_time.count() * 1'000'000.0 / chunks << "us\n"
+              << "Realtime factor:    " << audio_time / run_time.count() << "x" << std::endl;
+
+    if (enable_timings)
+    {
+        print_timings(engine.get(), period_us);
+    }
+    return 0;
+}
@@ -69,6 +69,21 @@ struct CpuTimings
     float avg;
     float min;
     float max;
+    float p50;
+    float p90;
+    float p99;
+    float p999;
+    int   overruns;
+};
+
+struct RtEventQueueStatistics
+{
+    int input_capacity;
+    int input_high_water_mark;
+    int input_overflows;
+    int input_deferrals;
+    int output_overflows;
+    int track_overflows;
 };
 
 enum class PluginType
@@ -98,6 +113,13 @@ struct ParameterInfo
     float           max_domain_value;
 };
 
+struct ParameterValueChange
+{
+    int   processor_id;
+    int   parameter_id;
+    float value;
+};
+
 struct PropertyInfo
 {
     int         id;
@@ -288,6 +310,7 @@ public:
     virtual ControlStatus                           reset_all_timings() = 0;
     virtual ControlStatus                           reset_track_timings(int track_id) = 0;
     virtual ControlStatus                           reset_processor_timings(int processor_id) = 0;
+    virtual RtEventQueueStatistics                  get_rt_event_queue_statistics() const = 0;
 
 protected:
     TimingController() = default;
@@ -367,6 +390,7 @@ public:
     virtual std::pair<ControlStatus, float>                       get_parameter_value_in_domain(int processor_id, int parameter_id) const = 0;
     virtual std::pair<ControlStatus, std::string>                 get_parameter_value_as_string(int processor_id, int parameter_id) const = 0;
     virtual ControlStatus                                         set_parameter_value(int processor_id, int parameter_id, float value) = 0;
+    virtual ControlStatus                                         set_parameter_values(const std::vector<ParameterValueChange>& changes) = 0;
 
     virtual std::pair<ControlStatus, std::vector<PropertyInfo>>   get_processor_properties(int processor_id) const = 0;
     virtual std::pair<ControlStatus, std::vector<PropertyInfo>>   get_track_properties(int processor_id) const = 0;
@@ -246,4 +246,115 @@ void SubscribeToParameterUpdatesCallData::_populate_blocklist()
     }
 }
 
+StreamParameterValuesCallData::StreamParameterValuesCallData(ParameterControlService* service,
+                                                             grpc::ServerCompletionQueue* async_rpc_queue)
+        : CallData(async_rpc_queue),
+          _service(service),
+          _reader(&_ctx),
+          _flush_alarm(this, async_rpc_queue),
+          _flush_interval(service->stream_coalescing_interval())
+{
+    proceed();
+}
+
+void StreamParameterValuesCallData::proceed()
+{
+    if (_status == CallStatus::CREATE)
+    {
+        _status = CallStatus::PROCESS;
+        _service->RequestStreamParameterValues(&_ctx,
+                                               &_reader,
+                                               _async_rpc_queue,
+                                               _async_rpc_queue,
+                                               this);
+        _service->register_stream(this);
+    }
+    else if (_status == CallStatus::PROCESS)
+    {
+        if (_first_iteration)
+        {
+            // A client connected, spawn a new instance to serve the next one
+            new StreamParameterValuesCallData(_service, _async_rpc_queue);
+            _first_iteration = false;
+        }
+        else
+        {
+            _add_change(_value);
+        }
+        _reader.Read(&_value, this);
+    }
+    else
+    {
+        assert(_status == CallStatus::FINISH);
+        if (_first_iteration == false && _finish_requested == false)
+        {
+            // The client closed the stream, send what is left and end the call
+            _flush();
+            _finish_requested = true;
+            _reader.Finish(GenericVoidValue(), grpc::Status::OK, this);
+            return;
+        }
+        _call_done = true;
+        if (_flush_alarm_set)
+        {
+            // Deleted when the cancelled alarm comes back from the completion queue
+            _flush_alarm.cancel();
+            return;
+        }
+        _service->unregister_stream(this);
+        delete this;
+    }
+}
+
+void StreamParameterValuesCallData::flush_alarm_expired()
+{
+    _flush_alarm_set = false;
+    if (_call_done)
+    {
+        _service->unregister_stream(this);
+        delete this;
+        return;
+    }
+    _flush();
+}
+
+void StreamParameterValuesCallData::_add_change(const ParameterValue& value)
+{
+    auto key = _map_key(value.parameter().parameter_id(), value.parameter().processor_id());
+    auto pending = _pending_index.find(key);
+    if (pending != _pending_index.end())
+    {
+        _pending_changes[pending->second].value = value.value();
+    }
+    else
+    {
+        _pending_index[key] = _pending_changes.size();
+        _pending_changes.push_back({value.parameter().processor_id(), value.parameter().parameter_id(), value.value()});
+    }
+
+    // The first change after a pause is sent right away, changes following
+    // closely after it are held back until one chunk has passed
+    auto since_last_flush = std::chrono::steady_clock::now() - _last_flush;
+    if (since_last_flush >= _flush_interval)
+    {
+        _flush();
+    }
+    else if (_flush_alarm_set == false)
+    {
+        _flush_alarm.set(std::chrono::system_clock::now() + (_flush_interval - since_last_flush));
+        _flush_alarm_set = true;
+    }
+}
+
+void StreamParameterValuesCallData::_flush()
+{
+    if (_pending_changes.empty() == false)
+    {
+        _service->controller()->set_parameter_values(_pending_changes);
+        _pending_changes.clear();
+        _pending_index.clear();
+    }
+    _last_flush = std::chrono::steady_clock::now();
+}
+
 } // namespace sushi_rpc
@@ -21,6 +21,10 @@
 #ifndef SUSHI_ASYNCSERVICECALLDATA_H
 #define SUSHI_ASYNCSERVICECALLDATA_H
 
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
 #include <grpc++/alarm.h>
 #include <grpcpp/grpcpp.h>
 
@@ -37,9 +41,7 @@ namespace sushi_rpc {
 class CallData
 {
 public:
-    CallData(NotificationControlService* service,
-             grpc::ServerCompletionQueue* async_rpc_queue) : _service(service),
-                                                             _async_rpc_queue(async_rpc_queue),
+    CallData(grpc::ServerCompletionQueue* async_rpc_queue) : _async_rpc_queue(async_rpc_queue),
                                                              _in_completion_queue(false),
                                                              _status(CallStatus::CREATE) {}
 
@@ -54,7 +56,6 @@ public:
     void stop();
 
 protected:
-    NotificationControlService* _service;
     grpc::ServerCompletionQueue* _async_rpc_queue;
     grpc::ServerContext _ctx;
 
@@ -86,7 +87,8 @@ class SubscribeToUpdatesCallData : public CallData
 public:
     SubscribeToUpdatesCallData(NotificationControlService* service,
                                grpc::ServerCompletionQueue* async_rpc_queue)
-            : CallData(service, async_rpc_queue),
+            : CallData(async_rpc_queue),
+              _service(service),
               _responder(&_ctx)
     {
         // Classes inheriting from this, should call proceed() in their constructor.
@@ -108,6 +110,7 @@ protected:
     virtual bool _check_if_blocklisted(const ValueType& reply) = 0;
     virtual void _populate_blocklist() = 0;
 
+    NotificationControlService* _service;
     BlocklistType _notification_blocklist;
     grpc::ServerAsyncWriter<ValueType> _responder;
 
@@ -226,5 +229,71 @@ private:
     std::unordered_map<int64_t, bool> _blocklist;
 };
 
+/**
+ * @brief Receives a stream of parameter changes from a client. Repeated changes to
+ *        the same parameter that arrive within the duration of one audio chunk are
+ *        coalesced so only the latest value is passed on, and all changes collected
+ *        during that time are sent to the engine as one batch.
+ */
+class StreamParameterValuesCallData : public CallData
+{
+public:
+    StreamParameterValuesCallData(ParameterControlService* service,
+                                  grpc::ServerCompletionQueue* async_rpc_queue);
+
+    ~StreamParameterValuesCallData() = default;
+
+    void proceed() override;
+
+    /**
+     * @brief Called when the flush alarm has expired or has been cancelled.
+     */
+    void flush_alarm_expired();
+
+private:
+    /* The alarm needs a tag of its own to be told apart from completed reads */
+    class FlushAlarm : public CallData
+    {
+    public:
+        FlushAlarm(StreamParameterValuesCallData* parent,
+                   grpc::ServerCompletionQueue* async_rpc_queue) : CallData(async_rpc_queue),
+                                                                   _parent(parent) {}
+
+        void proceed() override {_parent->flush_alarm_expired();}
+
+        void set(std::chrono::system_clock::time_point deadline) {_alarm.Set(_async_rpc_queue, deadline, this);}
+
+        void cancel() {_alarm.Cancel();}
+
+    private:
+        StreamParameterValuesCallData* _parent;
+    };
+
+    void _add_change(const ParameterValue& value);
+
+    void _flush();
+
+    int64_t _map_key(int parameter_id, int processor_id) const
+    {
+        return (static_cast<int64_t>(parameter_id) << 32) | processor_id;
+    }
+
+    ParameterControlService* _service;
+    grpc::ServerAsyncReader<GenericVoidValue, ParameterValue> _reader;
+    ParameterValue _value;
+
+    std::vector<sushi::ext::ParameterValueChange> _pending_changes;
+    std::unordered_map<int64_t, size_t> _pending_index;
+
+    FlushAlarm _flush_alarm;
+    std::chrono::nanoseconds _flush_interval;
+    std::chrono::steady_clock::time_point _last_flush;
+
+    bool _first_iteration{true};
+    bool _flush_alarm_set{false};
+    bool _finish_requested{false};
+    bool _call_done{false};
+};
+
 }
 #endif // SUSHI_ASYNCSERVICECALLDATA_H
@@ -22,6 +22,7 @@
 #include "control_notifications.h"
 
 #include "async_service_call_data.h"
+#include "library/constants.h"
 
 namespace sushi_rpc {
 
@@ -253,6 +254,11 @@ inline void to_grpc(sushi_rpc::CpuTimings& dest, const sushi::ext::CpuTimings& s
     dest.set_average(src.avg);
     dest.set_min(src.min);
     dest.set_max(src.max);
+    dest.set_p50(src.p50);
+    dest.set_p90(src.p90);
+    dest.set_p99(src.p99);
+    dest.set_p999(src.p999);
+    dest.set_overruns(src.overruns);
 }
 
 inline void to_grpc(sushi_rpc::AudioConnection& dest, const sushi::ext::AudioConnection& src)
@@ -792,6 +798,53 @@ grpc::Status ParameterControlService::SetParameterValue(grpc::ServerContext* /*c
     return to_grpc_status(status);
 }
 
+grpc::Status ParameterControlService::SetParameterValues(grpc::ServerContext* /*context*/,
+                                                         const sushi_rpc::ParameterValueList* request,
+                                                         sushi_rpc::GenericVoidValue* /*response*/)
+{
+    std::vector<sushi::ext::ParameterValueChange> changes;
+    changes.reserve(request->values_size());
+    for (const auto& value : request->values())
+    {
+        changes.push_back({value.parameter().processor_id(), value.parameter().parameter_id(), value.value()});
+    }
+    auto status = _controller->set_parameter_values(changes);
+    return to_grpc_status(status);
+}
+
+std::chrono::nanoseconds ParameterControlService::stream_coalescing_interval() const
+{
+    float samplerate = _transport_controller->get_samplerate();
+    if (samplerate <= 0.0f)
+    {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::nanoseconds(static_cast<int64_t>(AUDIO_CHUNK_SIZE * 1'000'000'000.0 / samplerate));
+}
+
+void ParameterControlService::register_stream(StreamParameterValuesCallData* stream)
+{
+    std::scoped_lock lock(_stream_lock);
+    _streams.push_back(stream);
+}
+
+void ParameterControlService::unregister_stream(StreamParameterValuesCallData* stream)
+{
+    std::scoped_lock lock(_stream_lock);
+    _streams.erase(std::remove(_streams.begin(), _streams.end(), stream), _streams.end());
+}
+
+void ParameterControlService::delete_all_streams()
+{
+    /* Only safe to call after the completion queue has been shut down and emptied */
+    std::scoped_lock lock(_stream_lock);
+    for (auto& stream : _streams)
+    {
+        delete stream;
+    }
+    _streams.clear();
+}
+
 grpc::Status ProgramControlService::GetProcessorCurrentProgram(grpc::ServerContext* /*context*/,
                                                                const sushi_rpc::ProcessorIdentifier* request,
                                                                sushi_rpc::ProgramIdentifier* response)
@@ -1621,10 +1674,7 @@ void NotificationControlService::_forward_cpu_timing_notification_to_subscribers
 {
     auto typed_notification = static_cast<const sushi::ext::CpuTimingNotification*>(notification);
     auto notification_content = std::make_shared<CpuTimings>();
-    auto timings = typed_notification->cpu_timings();
-    notification_content->set_average(timings.avg);
-    notification_content->set_min(timings.min);
-    notification_content->set_max(timings.max);
+    to_grpc(*notification_content, typed_notification->cpu_timings());
 
     std::scoped_lock lock(_timing_subscriber_lock);
     for (auto& subscriber : _timing_subscribers)
@@ -38,6 +38,7 @@ class SubscribeToCpuTimingUpdatesCallData;
 class SubscribeToTrackChangesCallData;
 class SubscribeToProcessorChangesCallData;
 class SubscribeToParameterUpdatesCallData;
+class StreamParameterValuesCallData;
 
 class SystemControlService : public SystemController::Service
 {
@@ -131,10 +132,14 @@ private:
     sushi::ext::AudioGraphController* _controller;
 };
 
-class ParameterControlService : public ParameterController::Service
+using AsyncParameterService = sushi_rpc::ParameterController::WithAsyncMethod_StreamParameterValues<
+                              sushi_rpc::ParameterController::Service>;
+
+class ParameterControlService : public AsyncParameterService
 {
 public:
-    ParameterControlService(sushi::ext::SushiControl* controller) : _controller{controller->parameter_controller()} {}
+    ParameterControlService(sushi::ext::SushiControl* controller) : _controller{controller->parameter_controller()},
+                                                                    _transport_controller{controller->transport_controller()} {}
 
     grpc::Status GetTrackParameters(grpc::ServerContext* context, const sushi_rpc::TrackIdentifier* request, sushi_rpc::ParameterInfoList* response) override;
     grpc::Status GetProcessorParameters(grpc::ServerContext* context, const sushi_rpc::ProcessorIdentifier* request, sushi_rpc::ParameterInfoList* response) override;
@@ -144,6 +149,7 @@ public:
     grpc::Status GetParameterValueInDomain(grpc::ServerContext* context, const sushi_rpc::ParameterIdentifier* request, sushi_rpc::GenericFloatValue* response) override;
     grpc::Status GetParameterValueAsString(grpc::ServerContext* context, const sushi_rpc::ParameterIdentifier* request, sushi_rpc::GenericStringValue* response) override;
     grpc::Status SetParameterValue(grpc::ServerContext* context, const sushi_rpc::ParameterValue* request, sushi_rpc::GenericVoidValue* response) override;
+    grpc::Status SetParameterValues(grpc::ServerContext* context, const sushi_rpc::ParameterValueList* request, sushi_rpc::GenericVoidValue* response) override;
 
     grpc::Status GetTrackProperties(grpc::ServerContext* context, const sushi_rpc::TrackIdentifier* request, sushi_rpc::PropertyInfoList* response) override;
     grpc::Status GetProcessorProperties(grpc::ServerContext* context, const sushi_rpc::ProcessorIdentifier* request, sushi_rpc::PropertyInfoList* response) override;
@@ -152,9 +158,22 @@ public:
     grpc::Status GetPropertyValue(grpc::ServerContext* context, const sushi_rpc::PropertyIdentifier* request, sushi_rpc::GenericStringValue* response) override;
     grpc::Status SetPropertyValue(grpc::ServerContext* context, const sushi_rpc::PropertyValue* request, sushi_rpc::GenericVoidValue* response) override;
 
+    sushi::ext::ParameterController* controller() {return _controller;}
+
+    /* Time window within which repeated changes from a parameter stream are coalesced */
+    std::chrono::nanoseconds stream_coalescing_interval() const;
+
+    void register_stream(StreamParameterValuesCallData* stream);
+    void unregister_stream(StreamParameterValuesCallData* stream);
+
+    void delete_all_streams();
 
 private:
     sushi::ext::ParameterController* _controller;
+    sushi::ext::TransportController* _transport_controller;
+
+    std::vector<StreamParameterValuesCallData*> _streams;
+    std::mutex _stream_lock;
 };
 
 class ProgramControlService : public ProgramController::Service
@@ -54,6 +54,7 @@ void GrpcServer::AsyncRpcLoop()
     new SubscribeToTrackChangesCallData(_notification_control_service.get(), _async_rpc_queue.get());
     new SubscribeToProcessorChangesCallData(_notification_control_service.get(), _async_rpc_queue.get());
     new SubscribeToParameterUpdatesCallData(_notification_control_service.get(), _async_rpc_queue.get());
+    new StreamParameterValuesCallData(_parameter_control_service.get(), _async_rpc_queue.get());
 
     while (_running.load())
     {
@@ -108,6 +109,7 @@ void GrpcServer::stop()
     // Empty completion queue
     while(_async_rpc_queue->Next(&tag, &ok));
     _notification_control_service->delete_all_subscribers();
+    _parameter_control_service->delete_all_streams();
 }
 
 void GrpcServer::waitForCompletion()
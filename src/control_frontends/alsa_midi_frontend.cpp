@@ -225,6 +225,23 @@ void AlsaMidiFrontend::_poll_function()
 }
 
 void AlsaMidiFrontend::send_midi(int output, MidiDataByte data, Time timestamp)
+{
+    _output_event(output, data, timestamp);
+    snd_seq_drain_output(_seq_handle);
+}
+
+void AlsaMidiFrontend::send_midi_batch(const std::vector<MidiOutputMessage>& messages)
+{
+    /* All events are put in the sequencer's output buffer with their scheduled times
+     * and then sent to the sequencer queue together */
+    for (const auto& message : messages)
+    {
+        _output_event(message.output, message.data, message.timestamp);
+    }
+    snd_seq_drain_output(_seq_handle);
+}
+
+void AlsaMidiFrontend::_output_event(int output, MidiDataByte data, Time timestamp)
 {
     snd_seq_event ev;
     snd_seq_ev_clear(&ev);
@@ -237,7 +254,6 @@ void AlsaMidiFrontend::send_midi(int output, MidiDataByte data, Time timestamp)
     snd_seq_real_time_t ev_time = _to_alsa_time(timestamp);
     snd_seq_ev_schedule_real(&ev, _queue, false, &ev_time);
     bytes = snd_seq_event_output(_seq_handle, &ev);
-    snd_seq_drain_output(_seq_handle);
 
     SUSHI_LOG_WARNING_IF(bytes <= 0, "Event output returned: {}, type {}", strerror(-bytes), ev.type);
 }
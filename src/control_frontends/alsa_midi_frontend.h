@@ -51,10 +51,13 @@ public:
 
     void send_midi(int input, MidiDataByte data, Time timestamp) override;
 
+    void send_midi_batch(const std::vector<MidiOutputMessage>& messages) override;
+
 private:
 
     bool _init_ports();
     bool _init_time();
+    void _output_event(int output, MidiDataByte data, Time timestamp);
     Time _to_sushi_time(const snd_seq_real_time_t* alsa_time);
     snd_seq_real_time_t _to_alsa_time(Time timestamp);
 
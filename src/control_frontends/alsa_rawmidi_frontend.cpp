@@ -0,0 +1,298 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Alsa rawmidi frontend
+ * @copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#include <pthread.h>
+
+#include "alsa_rawmidi_frontend.h"
+#include "logging.h"
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("rawmidi");
+
+namespace sushi {
+namespace midi_frontend {
+
+constexpr auto RAWMIDI_POLL_TIMEOUT = std::chrono::milliseconds(200);
+/* Below the priority of the audio thread, but above any non-realtime thread */
+constexpr int RAWMIDI_THREAD_PRIORITY = 70;
+constexpr int RAWMIDI_READ_BUFFER_SIZE = 256;
+
+AlsaRawMidiFrontend::AlsaRawMidiFrontend(int inputs,
+                                         int outputs,
+                                         const std::vector<std::string>& devices,
+                                         midi_receiver::MidiReceiver* dispatcher)
+        : BaseMidiFrontend(dispatcher),
+          _inputs(inputs),
+          _outputs(outputs),
+          _devices(devices)
+{}
+
+AlsaRawMidiFrontend::~AlsaRawMidiFrontend()
+{
+    stop();
+    for (auto& input : _input_devices)
+    {
+        snd_rawmidi_close(input.handle);
+    }
+    for (auto output : _output_devices)
+    {
+        snd_rawmidi_close(output);
+    }
+}
+
+bool AlsaRawMidiFrontend::init()
+{
+    SUSHI_LOG_WARNING_IF(static_cast<int>(_devices.size()) < std::max(_inputs, _outputs),
+                         "{} rawmidi devices given for {} midi inputs and {} outputs, "
+                         "inputs and outputs without a device will be unused", _devices.size(), _inputs, _outputs);
+
+    for (int i = 0; i < static_cast<int>(_devices.size()); ++i)
+    {
+        bool is_input = i < _inputs;
+        bool is_output = i < _outputs;
+        if (is_input == false && is_output == false)
+        {
+            SUSHI_LOG_WARNING("No midi input or output for rawmidi device {}, ignoring it", _devices[i]);
+            continue;
+        }
+        snd_rawmidi_t* input_handle{nullptr};
+        snd_rawmidi_t* output_handle{nullptr};
+        /* Non-blocking, as reads are done after polling and a full output
+         * buffer should not block the thread sending midi. In append mode a
+         * write is either done completely or not at all, so a full output
+         * buffer can't truncate messages. */
+        int mode = is_output ? SND_RAWMIDI_NONBLOCK | SND_RAWMIDI_APPEND : SND_RAWMIDI_NONBLOCK;
+        int alsamidi_ret = snd_rawmidi_open(is_input ? &input_handle : nullptr,
+                                            is_output ? &output_handle : nullptr,
+                                            _devices[i].c_str(), mode);
+        if (alsamidi_ret < 0)
+        {
+            SUSHI_LOG_ERROR("Error opening rawmidi device {}: {}", _devices[i], strerror(-alsamidi_ret));
+            return false;
+        }
+        if (is_input)
+        {
+            _input_devices.push_back({input_handle, midi::MidiStreamParser()});
+        }
+        if (is_output)
+        {
+            _output_devices.push_back(output_handle);
+        }
+        SUSHI_LOG_INFO("Opened rawmidi device {}", _devices[i]);
+    }
+    _output_buffers.resize(_output_devices.size());
+    return true;
+}
+
+void AlsaRawMidiFrontend::run()
+{
+    if (_input_devices.empty() == false)
+    {
+        _running = true;
+        _worker = std::thread(&AlsaRawMidiFrontend::_read_function, this);
+    }
+    SUSHI_LOG_INFO_IF(_input_devices.empty(), "No rawmidi inputs, not starting read thread");
+}
+
+void AlsaRawMidiFrontend::stop()
+{
+    _running.store(false);
+    if (_worker.joinable())
+    {
+        _worker.join();
+    }
+}
+
+void AlsaRawMidiFrontend::send_midi(int output, MidiDataByte data, Time /*timestamp*/)
+{
+    int size = midi::decode_message_size(data[0]);
+    if (size > 0 && output < static_cast<int>(_output_devices.size()))
+    {
+        [[maybe_unused]] auto bytes = _write_output(output, data.data(), size);
+        SUSHI_LOG_WARNING_IF(bytes == -EAGAIN, "Rawmidi output buffer full, dropped midi message");
+    }
+}
+
+void AlsaRawMidiFrontend::send_midi_batch(const std::vector<MidiOutputMessage>& messages)
+{
+    /* Messages are gathered per device and written with one call each */
+    for (auto& buffer : _output_buffers)
+    {
+        buffer.clear();
+    }
+    for (const auto& message : messages)
+    {
+        int size = midi::decode_message_size(message.data[0]);
+        if (message.output < static_cast<int>(_output_buffers.size()) && size > 0)
+        {
+            auto& buffer = _output_buffers[message.output];
+            buffer.insert(buffer.end(), message.data.begin(), message.data.begin() + size);
+        }
+    }
+    for (int i = 0; i < static_cast<int>(_output_buffers.size()); ++i)
+    {
+        const auto& buffer = _output_buffers[i];
+        if (buffer.empty() == false && _write_output(i, buffer.data(), buffer.size()) < 0)
+        {
+            /* No room for the whole batch, write as many whole messages as fit */
+            _write_messages(i, buffer.data(), buffer.size());
+        }
+    }
+}
+
+void AlsaRawMidiFrontend::_read_function()
+{
+    sched_param param{};
+    param.sched_priority = RAWMIDI_THREAD_PRIORITY;
+    [[maybe_unused]] int res = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    SUSHI_LOG_WARNING_IF(res != 0, "Failed to set realtime priority of rawmidi read thread: {}", strerror(res));
+
+    /* Devices can have more than one descriptor each, keep track of which belong to which device */
+    int input_count = static_cast<int>(_input_devices.size());
+    std::vector<int> descriptor_offsets(input_count);
+    std::vector<int> descriptor_counts(input_count);
+    int descr_count = 0;
+    for (int i = 0; i < input_count; ++i)
+    {
+        descriptor_offsets[i] = descr_count;
+        descriptor_counts[i] = snd_rawmidi_poll_descriptors_count(_input_devices[i].handle);
+        descr_count += descriptor_counts[i];
+    }
+    auto descriptors = std::make_unique<pollfd[]>(descr_count);
+    for (int i = 0; i < input_count; ++i)
+    {
+        snd_rawmidi_poll_descriptors(_input_devices[i].handle, descriptors.get() + descriptor_offsets[i], descriptor_counts[i]);
+    }
+
+    /* Failed devices are dropped, as poll returns at once for them on every call
+     * and the thread would otherwise spin at realtime priority */
+    std::vector<bool> active(input_count, true);
+    int active_inputs = input_count;
+    while (_running && active_inputs > 0)
+    {
+        if (poll(descriptors.get(), descr_count, RAWMIDI_POLL_TIMEOUT.count()) > 0)
+        {
+            for (int i = 0; i < input_count; ++i)
+            {
+                if (active[i] == false)
+                {
+                    continue;
+                }
+                pollfd* device_descriptors = descriptors.get() + descriptor_offsets[i];
+                unsigned short revents = 0;
+                snd_rawmidi_poll_descriptors_revents(_input_devices[i].handle, device_descriptors,
+                                                     descriptor_counts[i], &revents);
+                bool failed = false;
+                for (int d = 0; d < descriptor_counts[i]; ++d)
+                {
+                    failed |= (device_descriptors[d].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+                }
+                if (revents & POLLIN)
+                {
+                    failed |= _read_input(i) == false;
+                }
+                if (failed)
+                {
+                    SUSHI_LOG_ERROR("Rawmidi input {} failed or was disconnected, no longer reading from it", i);
+                    for (int d = 0; d < descriptor_counts[i]; ++d)
+                    {
+                        /* Poll ignores negative descriptors */
+                        device_descriptors[d].fd = -1;
+                    }
+                    active[i] = false;
+                    active_inputs--;
+                }
+            }
+        }
+    }
+    if (active_inputs == 0)
+    {
+        SUSHI_LOG_ERROR("No rawmidi inputs left, stopping read thread");
+        _running = false;
+    }
+}
+
+bool AlsaRawMidiFrontend::_read_input(int input)
+{
+    auto& device = _input_devices[input];
+    uint8_t buffer[RAWMIDI_READ_BUFFER_SIZE];
+    ssize_t byte_count;
+    while ((byte_count = snd_rawmidi_read(device.handle, buffer, sizeof(buffer))) > 0)
+    {
+        /* Rawmidi has no timestamps, all messages read in one go are given the time they were read */
+        _parse_input(input, buffer, byte_count, get_current_time());
+    }
+    if (byte_count < 0 && byte_count != -EAGAIN)
+    {
+        SUSHI_LOG_ERROR("Error reading from rawmidi input {}: {}", input, strerror(-byte_count));
+        return false;
+    }
+    return true;
+}
+
+void AlsaRawMidiFrontend::_parse_input(int input, const uint8_t* data, ssize_t size, Time timestamp)
+{
+    auto& parser = _input_devices[input].parser;
+    for (ssize_t i = 0; i < size; ++i)
+    {
+        if (parser.parse(data[i]))
+        {
+            _receiver->send_midi(input, parser.message(), timestamp);
+
+            SUSHI_LOG_DEBUG("Received midi message: [{:x} {:x} {:x} {:x}], port{}, timestamp: {}",
+                            parser.message()[0], parser.message()[1],
+                            parser.message()[2], parser.message()[3], input, timestamp.count());
+        }
+    }
+}
+
+ssize_t AlsaRawMidiFrontend::_write_output(int output, const uint8_t* data, size_t size)
+{
+    auto bytes = snd_rawmidi_write(_output_devices[output], data, size);
+    SUSHI_LOG_WARNING_IF(bytes < 0 && bytes != -EAGAIN, "Rawmidi write returned: {}", strerror(-bytes));
+    /* Should not happen in append mode, unless the device doesn't support it */
+    SUSHI_LOG_WARNING_IF(bytes >= 0 && bytes < static_cast<ssize_t>(size), "Rawmidi device only wrote {} of {} bytes, "
+                         "midi output may be truncated", bytes, size);
+    return bytes;
+}
+
+void AlsaRawMidiFrontend::_write_messages(int output, const uint8_t* data, size_t size)
+{
+    int dropped = 0;
+    size_t pos = 0;
+    while (pos < size)
+    {
+        /* The buffer only holds complete messages, so each one starts with a status byte */
+        size_t message_size = midi::decode_message_size(data[pos]);
+        if (_write_output(output, data + pos, message_size) < 0)
+        {
+            dropped++;
+        }
+        pos += message_size;
+    }
+    SUSHI_LOG_WARNING_IF(dropped > 0, "Rawmidi output buffer full, dropped {} midi messages", dropped);
+}
+
+} // end namespace midi_frontend
+} // end namespace sushi
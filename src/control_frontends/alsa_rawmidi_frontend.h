@@ -0,0 +1,97 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+ /**
+ * @brief Alsa rawmidi frontend, reads midi directly from rawmidi devices, bypassing
+ *        the Alsa sequencer, for lower input latency.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_ALSA_RAWMIDI_FRONTEND_H
+#define SUSHI_ALSA_RAWMIDI_FRONTEND_H
+
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <alsa/asoundlib.h>
+
+#include "base_midi_frontend.h"
+#include "library/midi_decoder.h"
+#include "library/time.h"
+
+namespace sushi {
+namespace midi_frontend {
+
+/**
+ * @brief Midi frontend that opens a list of rawmidi devices, e.g. "hw:1,0,0", by name.
+ *        Device n is used as midi input n and midi output n. Input is read from a
+ *        dedicated realtime priority thread and parsed in sushi, output is written
+ *        directly to the device as soon as it is sent, so output timestamps are not
+ *        used. Only whole messages are written, messages that don't fit in the output
+ *        buffer are dropped. The device name "virtual" creates a virtual rawmidi device
+ *        that shows up as an Alsa sequencer client, useful for testing without midi
+ *        hardware. A device that fails or is disconnected is no longer read from, the read
+ *        thread ends when no input devices are left.
+ */
+class AlsaRawMidiFrontend : public BaseMidiFrontend
+{
+public:
+    AlsaRawMidiFrontend(int inputs,
+                        int outputs,
+                        const std::vector<std::string>& devices,
+                        midi_receiver::MidiReceiver* dispatcher);
+
+    ~AlsaRawMidiFrontend();
+
+    bool init() override;
+
+    void run() override;
+
+    void stop() override;
+
+    void send_midi(int output, MidiDataByte data, Time timestamp) override;
+
+    void send_midi_batch(const std::vector<MidiOutputMessage>& messages) override;
+
+private:
+    struct InputDevice
+    {
+        snd_rawmidi_t*          handle;
+        midi::MidiStreamParser  parser;
+    };
+
+    void _read_function();
+    /* Returns false if the device failed and should no longer be read */
+    bool _read_input(int input);
+    void _parse_input(int input, const uint8_t* data, ssize_t size, Time timestamp);
+    ssize_t _write_output(int output, const uint8_t* data, size_t size);
+    void _write_messages(int output, const uint8_t* data, size_t size);
+
+    std::thread                       _worker;
+    std::atomic<bool>                 _running{false};
+    int                               _inputs;
+    int                               _outputs;
+    std::vector<std::string>          _devices;
+    std::vector<InputDevice>          _input_devices;
+    std::vector<snd_rawmidi_t*>       _output_devices;
+    std::vector<std::vector<uint8_t>> _output_buffers;
+};
+
+} // end namespace midi_frontend
+} // end namespace sushi
+
+#endif //SUSHI_ALSA_RAWMIDI_FRONTEND_H
@@ -23,12 +23,21 @@
 #ifndef SUSHI_BASE_MIDI_FRONTEND_H
 #define SUSHI_BASE_MIDI_FRONTEND_H
 
+#include <vector>
+
 #include "library/types.h"
 #include "engine/midi_receiver.h"
 
 namespace sushi {
 namespace midi_frontend {
 
+struct MidiOutputMessage
+{
+    int          output;
+    MidiDataByte data;
+    Time         timestamp;
+};
+
 class BaseMidiFrontend
 {
 public:
@@ -44,6 +53,19 @@ public:
 
     virtual void send_midi(int input, MidiDataByte data, Time timestamp) = 0;
 
+    /**
+     * @brief Send several midi messages at once. Frontends that can schedule messages
+     *        ahead of time should override this to hand over the whole batch in one go.
+     * @param messages The messages to send, each with the time it should be output
+     */
+    virtual void send_midi_batch(const std::vector<MidiOutputMessage>& messages)
+    {
+        for (const auto& message : messages)
+        {
+            send_midi(message.output, message.data, message.timestamp);
+        }
+    }
+
 protected:
     midi_receiver::MidiReceiver* _receiver;
 };
@@ -19,6 +19,7 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include <lo/lo_types.h>
@@ -34,6 +35,12 @@ SUSHI_GET_LOGGER_WITH_MODULE_NAME("osc frontend");
 
 namespace {
 
+/* The maximum number of arguments of any osc message handled through a connection */
+constexpr int MAX_OSC_ARGUMENTS = 4;
+
+/* Characters that make an incoming path an osc address pattern */
+constexpr char OSC_PATTERN_CHARACTERS[] = "*?[]{}";
+
 static void osc_error(int num, const char* msg, const char* path)
 {
     if (msg && path) // Sometimes liblo passes a nullpointer for msg
@@ -51,12 +58,98 @@ static int osc_send_parameter_change_event(const char* /*path*/,
 {
     auto connection = static_cast<OscConnection*>(user_data);
     float value = argv[0]->f;
-    auto ctrl = connection->controller->parameter_controller();
-    ctrl->set_parameter_value(connection->processor, connection->parameter, value);
+    connection->instance->send_parameter_change(connection->processor, connection->parameter, value);
     SUSHI_LOG_DEBUG("Sending parameter {} on processor {} change to {}.", connection->parameter, connection->processor, value);
     return 0;
 }
 
+/**
+ * @brief Match the arguments of a message to the type spec of a connection. Numerical
+ *        arguments are converted if the types differ, the same way liblo does for
+ *        methods registered with a type spec.
+ * @return true if the arguments matched, in which case coerced_args points to the
+ *         arguments to use, stored either in argv or in coerced_values.
+ */
+static bool coerce_arguments(const std::string& expected_types,
+                             const char* types,
+                             lo_arg** argv,
+                             int argc,
+                             lo_arg* coerced_values,
+                             lo_arg** coerced_args)
+{
+    if (argc != static_cast<int>(expected_types.size()) || argc > MAX_OSC_ARGUMENTS)
+    {
+        return false;
+    }
+    for (int i = 0; i < argc; ++i)
+    {
+        auto expected_type = static_cast<lo_type>(expected_types[i]);
+        auto type = static_cast<lo_type>(types[i]);
+        if (expected_type == type || (lo_is_string_type(expected_type) && lo_is_string_type(type)))
+        {
+            coerced_args[i] = argv[i];
+        }
+        else if (lo_is_numerical_type(expected_type) && lo_is_numerical_type(type))
+        {
+            lo_coerce(expected_type, &coerced_values[i], type, argv[i]);
+            coerced_args[i] = &coerced_values[i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Call a connection with the arguments of a message if they match its type spec
+ * @return true if the connection was called
+ */
+static bool call_connection(OscConnection* connection,
+                            const char* path,
+                            const char* types,
+                            lo_arg** argv,
+                            int argc,
+                            lo_message data)
+{
+    if (connection->types == types)
+    {
+        connection->callback(path, types, argv, argc, data, connection);
+        return true;
+    }
+    lo_arg coerced_values[MAX_OSC_ARGUMENTS];
+    lo_arg* coerced_args[MAX_OSC_ARGUMENTS];
+    if (coerce_arguments(connection->types, types, argv, argc, coerced_values, coerced_args))
+    {
+        connection->callback(path, connection->types.c_str(), coerced_args, argc, data, connection);
+        return true;
+    }
+    return false;
+}
+
+static int osc_dispatch_message(const char* path,
+                                const char* types,
+                                lo_arg** argv,
+                                int argc,
+                                lo_message data,
+                                void* user_data)
+{
+    return static_cast<OSCFrontend*>(user_data)->dispatch_message(path, types, argv, argc, data);
+}
+
+static int osc_bundle_start(lo_timetag /*time*/, void* user_data)
+{
+    static_cast<OSCFrontend*>(user_data)->begin_parameter_batch();
+    return 0;
+}
+
+static int osc_bundle_end(void* user_data)
+{
+    static_cast<OSCFrontend*>(user_data)->end_parameter_batch();
+    return 0;
+}
+
 static int osc_send_property_change_event(const char* /*path*/,
                                           const char* /*types*/,
                                           lo_arg** argv,
@@ -366,6 +459,11 @@ ControlFrontendStatus OSCFrontend::init()
     _osc_out_address = lo_address_new(nullptr, send_port_stream.str().c_str());
 
     _setup_engine_control();
+    /* Catches everything not handled by the engine control methods, liblo tries methods
+     * in the order they were added. This way liblo doesn't have to match every message
+     * against the path of every parameter, which gets slow with many parameters */
+    lo_server_thread_add_method(_osc_server, nullptr, nullptr, osc_dispatch_message, this);
+    lo_server_add_bundle_handlers(lo_server_thread_get_server(_osc_server), osc_bundle_start, osc_bundle_end, this);
     _osc_initialized = true;
     _event_dispatcher->subscribe_to_parameter_change_notifications(this);
     _event_dispatcher->subscribe_to_engine_notifications(this);
@@ -401,22 +499,17 @@ bool OSCFrontend::_connect_to_parameter(const std::string& processor_name,
         return false;
     }
 
-    std::string osc_path = "/parameter/" + osc::make_safe_path(processor_name) + "/" + osc::make_safe_path(parameter_name);
-    auto connection = new OscConnection;
+    auto connection = std::make_unique<OscConnection>();
     connection->processor = processor_id;
     connection->parameter = parameter_id;
     connection->instance = this;
     connection->controller = _controller;
+    connection->path = "/parameter/" + osc::make_safe_path(processor_name) + "/" + osc::make_safe_path(parameter_name);
+    connection->types = "f";
+    connection->callback = osc_send_parameter_change_event;
 
-    auto cb = lo_server_thread_add_method(_osc_server,
-                                          osc_path.c_str(),
-                                          "f",
-                                          osc_send_parameter_change_event,
-                                          connection);
-
-    connection->liblo_cb = cb;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    SUSHI_LOG_DEBUG("Added osc callback {}", osc_path);
+    SUSHI_LOG_DEBUG("Added osc callback {}", connection->path);
+    _add_connection(std::move(connection));
     return true;
 }
 
@@ -431,21 +524,17 @@ bool OSCFrontend::_connect_to_property(const std::string& processor_name,
         return false;
     }
 
-    std::string osc_path = "/property/" + osc::make_safe_path(processor_name) + "/" + osc::make_safe_path(property_name);
-    auto connection = new OscConnection;
+    auto connection = std::make_unique<OscConnection>();
     connection->processor = processor_id;
     connection->parameter = property_id;
     connection->instance = this;
     connection->controller = _controller;
+    connection->path = "/property/" + osc::make_safe_path(processor_name) + "/" + osc::make_safe_path(property_name);
+    connection->types = "s";
+    connection->callback = osc_send_property_change_event;
 
-    auto cb = lo_server_thread_add_method(_osc_server,
-                                          osc_path.c_str(),
-                                          "s",
-                                          osc_send_property_change_event,
-                                          connection);
-    connection->liblo_cb = cb;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
+    SUSHI_LOG_INFO("Added osc callback {}", connection->path);
+    _add_connection(std::move(connection));
     return true;
 }
 
@@ -488,25 +577,65 @@ bool OSCFrontend::disconnect_from_parameter(const std::string& processor_name, c
     return true;
 }
 
-std::pair<OscConnection*, std::string> OSCFrontend::_create_processor_connection(const std::string& processor_name,
-                                                                                 const std::string& osc_path_prefix)
+std::unique_ptr<OscConnection> OSCFrontend::_create_processor_connection(const std::string& processor_name,
+                                                                         const std::string& osc_path_prefix)
 {
-    std::string osc_path = osc_path_prefix;
     auto [processor_status, processor_id] = _graph_controller->get_processor_id(processor_name);
     if (processor_status != ext::ControlStatus::OK)
     {
-        return {nullptr, ""};
+        return nullptr;
     }
-    osc_path = osc_path + osc::make_safe_path(processor_name);
-    auto connection = new OscConnection;
+    auto connection = std::make_unique<OscConnection>();
     connection->processor = processor_id;
     connection->parameter = 0;
     connection->instance = this;
     connection->controller = _controller;
-    return {connection, osc_path};
+    connection->path = osc_path_prefix + osc::make_safe_path(processor_name);
+    return connection;
+}
+
+void OSCFrontend::_add_connection(std::unique_ptr<OscConnection> connection)
+{
+    std::scoped_lock lock(_connections_lock);
+    std::string_view path = connection->path;
+    _connections.emplace(path, std::move(connection));
+}
+
+void OSCFrontend::_publish_connections()
+{
+    std::scoped_lock lock(_connections_lock);
+    _published_connections.update(std::make_unique<OscConnectionTable>(_connections));
 }
 
 bool OSCFrontend::connect_to_bypass_state(const std::string& processor_name)
+{
+    bool connected = _connect_to_bypass_state(processor_name);
+    _publish_connections();
+    return connected;
+}
+
+bool OSCFrontend::connect_kb_to_track(const std::string& track_name)
+{
+    bool connected = _connect_kb_to_track(track_name);
+    _publish_connections();
+    return connected;
+}
+
+bool OSCFrontend::connect_to_program_change(const std::string& processor_name)
+{
+    bool connected = _connect_to_program_change(processor_name);
+    _publish_connections();
+    return connected;
+}
+
+bool OSCFrontend::connect_to_parameters_and_properties(const std::string& processor_name, int processor_id)
+{
+    bool connected = _connect_to_parameters_and_properties(processor_name, processor_id);
+    _publish_connections();
+    return connected;
+}
+
+bool OSCFrontend::_connect_to_bypass_state(const std::string& processor_name)
 {
     assert(_osc_initialized);
     if (_osc_initialized == false)
@@ -514,19 +643,19 @@ bool OSCFrontend::connect_to_bypass_state(const std::string& processor_name)
         return false;
     }
 
-    auto [connection, osc_path] = _create_processor_connection(processor_name, "/bypass/");
+    auto connection = _create_processor_connection(processor_name, "/bypass/");
     if (connection == nullptr)
     {
         return false;
     }
-    auto cb = lo_server_thread_add_method(_osc_server, osc_path.c_str(), "i", osc_send_bypass_state_event, connection);
-    connection->liblo_cb = cb;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
+    connection->types = "i";
+    connection->callback = osc_send_bypass_state_event;
+    SUSHI_LOG_INFO("Added osc callback {}", connection->path);
+    _add_connection(std::move(connection));
     return true;
 }
 
-bool OSCFrontend::connect_kb_to_track(const std::string& track_name)
+bool OSCFrontend::_connect_kb_to_track(const std::string& track_name)
 {
     assert(_osc_initialized);
     if (_osc_initialized == false)
@@ -534,24 +663,23 @@ bool OSCFrontend::connect_kb_to_track(const std::string& track_name)
         return false;
     }
 
-    auto [connection, osc_path] = _create_processor_connection(track_name, "/keyboard_event/");
+    auto connection = _create_processor_connection(track_name, "/keyboard_event/");
     if (connection == nullptr)
     {
         return false;
     }
-    auto cb = lo_server_thread_add_method(_osc_server, osc_path.c_str(), "siif", osc_send_keyboard_note_event, connection);
-    connection->liblo_cb = cb;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-
-    auto dupl_conn = new OscConnection(*connection);
-    cb = lo_server_thread_add_method(_osc_server, osc_path.c_str(), "sif", osc_send_keyboard_modulation_event, connection);
-    dupl_conn->liblo_cb = cb;
-    _connections.push_back(std::unique_ptr<OscConnection>(dupl_conn));
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
+    auto modulation_connection = std::make_unique<OscConnection>(*connection);
+    connection->types = "siif";
+    connection->callback = osc_send_keyboard_note_event;
+    modulation_connection->types = "sif";
+    modulation_connection->callback = osc_send_keyboard_modulation_event;
+    SUSHI_LOG_INFO("Added osc callback {}", connection->path);
+    _add_connection(std::move(connection));
+    _add_connection(std::move(modulation_connection));
     return true;
 }
 
-bool OSCFrontend::connect_to_program_change(const std::string& processor_name)
+bool OSCFrontend::_connect_to_program_change(const std::string& processor_name)
 {
     assert(_osc_initialized);
     if (_osc_initialized == false)
@@ -559,19 +687,19 @@ bool OSCFrontend::connect_to_program_change(const std::string& processor_name)
         return false;
     }
 
-    auto [connection, osc_path] = _create_processor_connection(processor_name, "/program/");
+    auto connection = _create_processor_connection(processor_name, "/program/");
     if (connection == nullptr)
     {
         return false;
     }
-    auto cb = lo_server_thread_add_method(_osc_server, osc_path.c_str(), "i", osc_send_program_change_event, connection);
-    connection->liblo_cb = cb;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
+    connection->types = "i";
+    connection->callback = osc_send_program_change_event;
+    SUSHI_LOG_INFO("Added osc callback {}", connection->path);
+    _add_connection(std::move(connection));
     return true;
 }
 
-bool OSCFrontend::connect_to_parameters_and_properties(const std::string& processor_name, int processor_id)
+bool OSCFrontend::_connect_to_parameters_and_properties(const std::string& processor_name, int processor_id)
 {
     auto [parameters_status, parameters] = _param_controller->get_processor_parameters(processor_id);
     if (parameters_status == ext::ControlStatus::OK)
@@ -634,23 +762,24 @@ void OSCFrontend::connect_to_all()
     auto tracks = _graph_controller->get_all_tracks();
     for (auto& track : tracks)
     {
-        connect_to_parameters_and_properties(track.name, track.id);
+        _connect_to_parameters_and_properties(track.name, track.id);
         auto [processors_status, processors] = _graph_controller->get_track_processors(track.id);
         if (processors_status != ext::ControlStatus::OK)
         {
-            return;
+            break;
         }
         for (auto& processor : processors)
         {
-            connect_to_parameters_and_properties(processor.name, processor.id);
+            _connect_to_parameters_and_properties(processor.name, processor.id);
             if (processor.program_count > 0)
             {
-                connect_to_program_change(processor.name);
+                _connect_to_program_change(processor.name);
             }
-            connect_to_bypass_state(processor.name);
+            _connect_to_bypass_state(processor.name);
         }
-        connect_kb_to_track(track.name);
+        _connect_kb_to_track(track.name);
     }
+    _publish_connections();
 }
 
 void OSCFrontend::connect_from_all_parameters()
@@ -704,6 +833,19 @@ int OSCFrontend::process(Event* event)
     return EventStatus::HANDLED_OK;
 }
 
+void OSCFrontend::engine_notification_batch_done()
+{
+    /* Connections added or removed by a whole batch of notifications, i.e. all processors
+     * created when loading a configuration, are published together, as every publish
+     * copies the table. Removed connections are deleted once no longer used by the osc
+     * server thread */
+    if (_connections_changed)
+    {
+        _publish_connections();
+        _connections_changed = false;
+    }
+}
+
 int OSCFrontend::receive_port() const
 {
     return _receive_port;
@@ -729,6 +871,71 @@ std::vector<std::string> OSCFrontend::get_enabled_parameter_outputs()
     return outputs;
 }
 
+void OSCFrontend::send_parameter_change(ObjectId processor_id, ObjectId parameter_id, float value)
+{
+    if (_bundle_depth > 0)
+    {
+        _parameter_batch.push_back({static_cast<int>(processor_id), static_cast<int>(parameter_id), value});
+    }
+    else
+    {
+        _param_controller->set_parameter_value(processor_id, parameter_id, value);
+    }
+}
+
+int OSCFrontend::dispatch_message(const char* path, const char* types, lo_arg** argv, int argc, lo_message data)
+{
+    auto connections = _published_connections.read();
+    if (std::strpbrk(path, OSC_PATTERN_CHARACTERS) == nullptr)
+    {
+        auto [begin, end] = connections->equal_range(path);
+        for (auto i = begin; i != end; ++i)
+        {
+            if (call_connection(i->second.get(), path, types, argv, argc, data))
+            {
+                return 0;
+            }
+        }
+        SUSHI_LOG_DEBUG("No osc connection matching {} with types {}", path, types);
+        return 1;
+    }
+
+    /* An address pattern can match any number of paths, so like liblo, check it against
+     * every registered path and call all matching connections. Registered paths never
+     * contain pattern characters, see make_safe_path() */
+    bool handled = false;
+    for (const auto& [connection_path, connection] : *connections)
+    {
+        if (lo_pattern_match(connection->path.c_str(), path) &&
+            call_connection(connection.get(), path, types, argv, argc, data))
+        {
+            handled = true;
+        }
+    }
+    if (handled == false)
+    {
+        SUSHI_LOG_DEBUG("No osc connection matching pattern {} with types {}", path, types);
+        return 1;
+    }
+    return 0;
+}
+
+void OSCFrontend::begin_parameter_batch()
+{
+    _bundle_depth++;
+}
+
+void OSCFrontend::end_parameter_batch()
+{
+    /* Bundles can be nested, send everything when the outermost one ends */
+    if (_bundle_depth > 0 && --_bundle_depth == 0 && _parameter_batch.empty() == false)
+    {
+        SUSHI_LOG_DEBUG("Sending {} parameter changes from osc bundle", _parameter_batch.size());
+        _param_controller->set_parameter_values(_parameter_batch);
+        _parameter_batch.clear();
+    }
+}
+
 void OSCFrontend::_setup_engine_control()
 {
     lo_server_thread_add_method(_osc_server, "/engine/set_tempo", "f", osc_set_tempo, this->_controller);
@@ -775,19 +982,21 @@ bool OSCFrontend::_remove_processor_connections(ObjectId processor_id)
     assert(_osc_initialized);
 
     int count = 0;
-    for (const auto& c : _connections)
     {
-        if (c->processor == processor_id)
+        std::scoped_lock lock(_connections_lock);
+        for (auto i = _connections.begin(); i != _connections.end();)
         {
-            lo_server_thread_del_lo_method(_osc_server, c->liblo_cb);
-            count++;
+            if (i->second->processor == processor_id)
+            {
+                i = _connections.erase(i);
+                count++;
+            }
+            else
+            {
+                ++i;
+            }
         }
     }
-    _connections.erase(std::remove_if(_connections.begin(),
-                                      _connections.end(),
-                                      [&](const auto& c) { return c->processor == processor_id; }),
-                       _connections.end());
-
     count += _outgoing_connections.erase(static_cast<ObjectId>(processor_id));
 
     SUSHI_LOG_ERROR_IF(count == 0, "Failed to remove any connections for processor {}", processor_id);
@@ -842,9 +1051,10 @@ void OSCFrontend::_handle_audio_graph_notification(const AudioGraphNotificationE
             auto [status, info] = _graph_controller->get_processor_info(event->processor());
             if (status == ext::ControlStatus::OK)
             {
-                connect_to_bypass_state(info.name);
-                connect_to_program_change(info.name);
-                connect_to_parameters_and_properties(info.name, event->processor());
+                _connect_to_bypass_state(info.name);
+                _connect_to_program_change(info.name);
+                _connect_to_parameters_and_properties(info.name, event->processor());
+                _connections_changed = true;
                 if(_connect_from_all_parameters)
                 {
                     connect_from_processor_parameters(info.name, event->processor());
@@ -860,9 +1070,10 @@ void OSCFrontend::_handle_audio_graph_notification(const AudioGraphNotificationE
             auto [status, info] = _graph_controller->get_track_info(event->track());
             if (status == ext::ControlStatus::OK)
             {
-                connect_kb_to_track(info.name);
-                connect_to_bypass_state(info.name);
-                connect_to_parameters_and_properties(info.name, event->track());
+                _connect_kb_to_track(info.name);
+                _connect_to_bypass_state(info.name);
+                _connect_to_parameters_and_properties(info.name, event->track());
+                _connections_changed = true;
                 if(_connect_from_all_parameters)
                 {
                     connect_from_processor_parameters(info.name, event->processor());
@@ -874,12 +1085,12 @@ void OSCFrontend::_handle_audio_graph_notification(const AudioGraphNotificationE
 
         case AudioGraphNotificationEvent::Action::PROCESSOR_DELETED:
             SUSHI_LOG_DEBUG("Received a PROCESSOR_DELETED notification for processor {}", event->processor());
-            _remove_processor_connections(event->processor());
+            _connections_changed |= _remove_processor_connections(event->processor());
             break;
 
         case AudioGraphNotificationEvent::Action::TRACK_DELETED:
             SUSHI_LOG_DEBUG("Received a TRACK_DELETED notification for processor {}", event->track());
-            _remove_processor_connections(event->track());
+            _connections_changed |= _remove_processor_connections(event->track());
             break;
 
         default:
@@ -27,11 +27,17 @@
 
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "lo/lo.h"
 
 #include "control_interface.h"
 #include "base_control_frontend.h"
+#include "library/rcu_pointer.h"
 
 namespace sushi {
 namespace control_frontend {
@@ -44,9 +50,18 @@ struct OscConnection
     ObjectId           parameter;
     OSCFrontend*       instance;
     ext::SushiControl* controller;
-    lo_method          liblo_cb;
+    std::string        path;
+    std::string        types;
+    lo_method_handler  callback;
 };
 
+/**
+ * @brief Osc paths mapped to the connections registered on them. A path can have several
+ *        connections with different type specs. Keys point into the connections' own path
+ *        strings, which is safe as connections are never modified after being added.
+ */
+using OscConnectionTable = std::unordered_multimap<std::string_view, std::shared_ptr<OscConnection>>;
+
 class OSCFrontend : public BaseControlFrontend
 {
 public:
@@ -147,6 +162,31 @@ public:
      */
     std::vector<std::string> get_enabled_parameter_outputs();
 
+    /**
+     * @brief Send a parameter change received over osc. Changes received inside an
+     *        osc bundle are collected and sent as a single batch when the bundle ends.
+     *        Only called from the osc server thread.
+     */
+    void send_parameter_change(ObjectId processor_id, ObjectId parameter_id, float value);
+
+    /**
+     * @brief Find the connections registered on the path of an incoming osc message and
+     *        call them. If the path is an osc address pattern, all connections on paths
+     *        matching it are called. Only called from the osc server thread.
+     * @return 0 if the message was handled, 1 otherwise
+     */
+    int dispatch_message(const char* path, const char* types, lo_arg** argv, int argc, lo_message data);
+
+    /**
+     * @brief Called from the osc server thread when the start of a bundle is received
+     */
+    void begin_parameter_batch();
+
+    /**
+     * @brief Called from the osc server thread when the end of a bundle is received
+     */
+    void end_parameter_batch();
+
     void run() override {_start_server();}
 
     void stop() override {_stop_server();}
@@ -156,6 +196,8 @@ public:
     /* Inherited from EventPoster */
     int process(Event* event) override;
 
+    void engine_notification_batch_done() override;
+
     int poster_id() override {return EventPosterId::OSC_FRONTEND;}
 
     int receive_port() const;
@@ -177,6 +219,15 @@ private:
                               ObjectId processor_id,
                               ObjectId property_id);
 
+    /* Same as the public connect functions, but the new connections are not published */
+    bool _connect_to_bypass_state(const std::string& processor_name);
+
+    bool _connect_kb_to_track(const std::string& track_name);
+
+    bool _connect_to_program_change(const std::string& processor_name);
+
+    bool _connect_to_parameters_and_properties(const std::string& processor_name, int processor_id);
+
     void _completion_callback(Event* event, int return_status) override;
 
     void _start_server();
@@ -187,8 +238,12 @@ private:
 
     bool _remove_processor_connections(ObjectId processor_id);
 
-    std::pair<OscConnection*, std::string> _create_processor_connection(const std::string& processor_name,
-                                                                        const std::string& osc_path_prefix);
+    std::unique_ptr<OscConnection> _create_processor_connection(const std::string& processor_name,
+                                                                const std::string& osc_path_prefix);
+
+    void _add_connection(std::unique_ptr<OscConnection> connection);
+
+    void _publish_connections();
 
     void _handle_param_change_notification(const ParameterChangeNotificationEvent* event);
 
@@ -213,8 +268,19 @@ private:
     sushi::ext::AudioGraphController* _graph_controller {nullptr};
     sushi::ext::ParameterController*  _param_controller {nullptr};
 
-    /* Currently only stored here so they can be deleted */
-    std::vector<std::unique_ptr<OscConnection>> _connections;
+    /* Parameter changes from the osc bundle currently being received */
+    std::vector<ext::ParameterValueChange> _parameter_batch;
+    int _bundle_depth {0};
+
+    /* All incoming messages are handled by a single liblo method that looks up their path
+     * here. Connections are added to _connections and then published as a new copy of the
+     * table, which the osc server thread reads without locking */
+    OscConnectionTable             _connections;
+    std::mutex                     _connections_lock;
+    RcuPointer<OscConnectionTable> _published_connections{std::make_unique<OscConnectionTable>()};
+    /* Set when audio graph notifications changed _connections, which are then published
+     * at the end of the notification batch */
+    bool                           _connections_changed {false};
 
     std::map<ObjectId, std::map<ObjectId, std::string>> _outgoing_connections;
 };
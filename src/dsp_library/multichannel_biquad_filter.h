@@ -0,0 +1,173 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Multichannel biquad filter implementation
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * A biquad filter processing several channels with a shared set of coefficients.
+ * Channels are mapped to the lanes of simd vectors so that 4 (8 with avx) channels
+ * are filtered with the same instructions as 1.
+ */
+
+#ifndef SUSHI_MULTICHANNEL_BIQUAD_FILTER_H
+#define SUSHI_MULTICHANNEL_BIQUAD_FILTER_H
+
+#include <algorithm>
+
+#include "biquad_filter.h"
+
+namespace dsp {
+namespace biquad {
+
+#if defined(__AVX__)
+constexpr int SIMD_LANES = 8;
+#else
+constexpr int SIMD_LANES = 4;
+#endif
+
+/* Gcc and clang vector extension, compiles to sse/avx on x86 and neon on arm */
+typedef float LaneVector __attribute__((vector_size(SIMD_LANES * sizeof(float))));
+
+template <int MAX_CHANNELS>
+class MultiChannelBiquadFilter
+{
+public:
+    MultiChannelBiquadFilter() = default;
+
+    MultiChannelBiquadFilter(const Coefficients &coefficients) : _coefficient_targets(coefficients) {}
+
+    ~MultiChannelBiquadFilter() = default;
+
+    /**
+     * @brief Resets the processing state of all channels
+     */
+    void reset()
+    {
+        for (int v = 0; v < VECTORS; ++v)
+        {
+            _z1[v] = LaneVector{};
+            _z2[v] = LaneVector{};
+        }
+        _coefficients = _coefficient_targets;
+    }
+
+    /**
+     * @brief Set new target coefficients, the filter will interpolate linearly to
+     *        these over the next call to process()
+     */
+    void set_coefficients(const Coefficients &coefficients)
+    {
+        _coefficient_targets = coefficients;
+    }
+
+    /**
+     * @brief Filter a number of channels, input and output may point to the same buffers.
+     * @param input An array of channels pointers to read from
+     * @param output An array of channels pointers to write to
+     * @param channels The number of channels to process, must be <= MAX_CHANNELS
+     * @param samples The number of samples to process in each channel
+     */
+    void process(const float* const* input, float* const* output, int channels, int samples)
+    {
+        channels = std::min(channels, MAX_CHANNELS);
+        /* Only filter the vectors holding the channels in use, MAX_CHANNELS is an upper
+         * bound and often much larger than the channel count of the track */
+        int vectors = (channels + SIMD_LANES - 1) / SIMD_LANES;
+        for (int v = _active_vectors; v < vectors; ++v)
+        {
+            /* Vectors that were not processed since a previous call with more channels
+             * would otherwise resume from stale state */
+            _z1[v] = LaneVector{};
+            _z2[v] = LaneVector{};
+        }
+        _active_vectors = vectors;
+        if (_stationary())
+        {
+            _process<false>(input, output, channels, vectors, samples);
+        }
+        else
+        {
+            _process<true>(input, output, channels, vectors, samples);
+            _coefficients = _coefficient_targets;
+        }
+    }
+
+private:
+    static constexpr int VECTORS = (MAX_CHANNELS + SIMD_LANES - 1) / SIMD_LANES;
+
+    bool _stationary() const
+    {
+        return _coefficients.b0 == _coefficient_targets.b0 && _coefficients.b1 == _coefficient_targets.b1 &&
+               _coefficients.b2 == _coefficient_targets.b2 && _coefficients.a1 == _coefficient_targets.a1 &&
+               _coefficients.a2 == _coefficient_targets.a2;
+    }
+
+    template <bool interpolate>
+    void _process(const float* const* input, float* const* output, int channels, int vectors, int samples)
+    {
+        Coefficients c = _coefficients;
+        Coefficients step{0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        if constexpr (interpolate)
+        {
+            float inv_samples = 1.0f / samples;
+            step.b0 = (_coefficient_targets.b0 - c.b0) * inv_samples;
+            step.b1 = (_coefficient_targets.b1 - c.b1) * inv_samples;
+            step.b2 = (_coefficient_targets.b2 - c.b2) * inv_samples;
+            step.a1 = (_coefficient_targets.a1 - c.a1) * inv_samples;
+            step.a2 = (_coefficient_targets.a2 - c.a2) * inv_samples;
+        }
+
+        /* Unused lanes are fed zeroes and so stay at zero */
+        LaneVector x[VECTORS]{};
+        LaneVector y[VECTORS];
+        for (int n = 0; n < samples; ++n)
+        {
+            if constexpr (interpolate)
+            {
+                c.b0 += step.b0;
+                c.b1 += step.b1;
+                c.b2 += step.b2;
+                c.a1 += step.a1;
+                c.a2 += step.a2;
+            }
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                x[ch / SIMD_LANES][ch % SIMD_LANES] = input[ch][n];
+            }
+            for (int v = 0; v < vectors; ++v)
+            {
+                y[v] = c.b0 * x[v] + _z1[v];
+                _z1[v] = c.b1 * x[v] - c.a1 * y[v] + _z2[v];
+                _z2[v] = c.b2 * x[v] - c.a2 * y[v];
+            }
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                output[ch][n] = y[ch / SIMD_LANES][ch % SIMD_LANES];
+            }
+        }
+    }
+
+    Coefficients _coefficients{0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    Coefficients _coefficient_targets{0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    LaneVector _z1[VECTORS]{};
+    LaneVector _z2[VECTORS]{};
+    int _active_vectors{VECTORS};
+};
+
+} // end namespace biquad
+} // end namespace dsp
+
+#endif //SUSHI_MULTICHANNEL_BIQUAD_FILTER_H
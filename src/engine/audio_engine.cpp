@@ -18,6 +18,7 @@
  * @copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <functional>
@@ -34,8 +35,19 @@ namespace engine {
 constexpr auto CLIPPING_DETECTION_INTERVAL = std::chrono::milliseconds(500);
 
 constexpr auto RT_EVENT_TIMEOUT = std::chrono::milliseconds(200);
+/* Same as the capacity of the keyboard event buffers in tracks. Shared by all events passed
+ * to processors during one chunk, from the input queue and from the event scheduler, so that
+ * they can't overflow them. Excess events wait for the next chunk */
+constexpr int MAX_RT_EVENTS_PER_CHUNK = MAX_EVENTS_IN_QUEUE;
+/* Max number of chunks to let sync events pile up in the output queue before waking the dispatcher */
+constexpr uint32_t MAX_UNSIGNALED_CHUNKS = MAX_EVENTS_IN_QUEUE / 4;
 constexpr char TIMING_FILE_NAME[] = "timings.txt";
+constexpr int  FLIGHT_RECORDER_CHUNKS = 16;
+constexpr int  MAX_RECORDED_DEADLINE_MISSES = 100;
 constexpr int  TIMING_LOG_PRINT_INTERVAL = 15;
+constexpr int  TRACK_BALANCING_INTERVAL = 5;
+// Only move tracks if the most loaded core would get at least this much less load
+constexpr float TRACK_BALANCING_THRESHOLD = 0.1f;
 
 constexpr int  MAX_TRACKS = 32;
 constexpr int  MAX_AUDIO_CONNECTIONS = MAX_TRACKS * TRACK_MAX_CHANNELS;
@@ -97,12 +109,18 @@ AudioEngine::AudioEngine(float sample_rate,
                                              _audio_graph(rt_cpu_cores, MAX_TRACKS),
                                              _audio_in_connections(MAX_AUDIO_CONNECTIONS),
                                              _audio_out_connections(MAX_AUDIO_CONNECTIONS),
+                                             _event_scheduler(sample_rate),
                                              _transport(sample_rate, &_main_out_queue),
+                                             /* One timing queue for every worker thread plus the main audio thread */
+                                             _process_timer(rt_cpu_cores + 1),
                                              _clip_detector(sample_rate)
 {
     if(event_dispatcher == nullptr)
     {
-        _event_dispatcher = std::make_unique<dispatcher::EventDispatcher>(this, &_main_out_queue, &_main_in_queue);
+        _event_dispatcher = std::make_unique<dispatcher::EventDispatcher>(this,
+                                                                              &_main_out_queue,
+                                                                              &_main_in_queue,
+                                                                              &_scheduled_in_queue);
     }
     else
     {
@@ -113,6 +131,10 @@ AudioEngine::AudioEngine(float sample_rate,
     this->set_sample_rate(sample_rate);
     _cv_in_connections.reserve(MAX_CV_CONNECTIONS);
     _gate_in_connections.reserve(MAX_GATE_CONNECTIONS);
+    _input_aliases.reserve(MAX_AUDIO_CONNECTIONS);
+    _output_aliases.reserve(MAX_AUDIO_CONNECTIONS);
+    _copied_input_connections.reserve(MAX_AUDIO_CONNECTIONS);
+    _copied_output_connections.reserve(MAX_AUDIO_CONNECTIONS);
 }
 
 AudioEngine::~AudioEngine()
@@ -135,6 +157,7 @@ void AudioEngine::set_sample_rate(float sample_rate)
     _transport.set_sample_rate(sample_rate);
     _process_timer.set_timing_period(sample_rate, AUDIO_CHUNK_SIZE);
     _clip_detector.set_sample_rate(sample_rate);
+    _event_scheduler.set_sample_rate(sample_rate);
     for (auto& limiter : _master_limiters)
     {
         limiter.init(sample_rate);
@@ -449,7 +472,19 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
     _transport.set_time(timestamp, samplecount);
 
     _process_internal_rt_events();
-    _send_rt_events_to_processors();
+    int sent_events = _send_rt_events_to_processors(MAX_RT_EVENTS_PER_CHUNK);
+    sent_events += _send_scheduled_rt_events(MAX_RT_EVENTS_PER_CHUNK - sent_events);
+    if (sent_events == MAX_RT_EVENTS_PER_CHUNK &&
+        (_main_in_queue.empty() == false || _event_scheduler.has_due_event(_transport.current_process_time())))
+    {
+        // The remaining events are deferred to the next chunk rather than overflowing track buffers
+        _input_deferrals.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (_audio_routing_changed.exchange(false))
+    {
+        _update_audio_routing();
+    }
 
     if (_cv_inputs > 0)
     {
@@ -464,6 +499,8 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
         _clip_detector.detect_clipped_samples(*in_buffer, _main_out_queue, true);
     }
     _copy_audio_to_tracks(in_buffer);
+    /* Tracks can't render directly into the output if it shares memory with the input */
+    _alias_audio_from_tracks(out_buffer, in_buffer->channel(0) != out_buffer->channel(0));
 
     // Render all tracks
     _audio_graph.render();
@@ -488,9 +525,24 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
     {
         _clip_detector.detect_clipped_samples(*out_buffer, _main_out_queue, false);
     }
+    _signal_output_events();
     _process_timer.stop_timer(engine_timestamp, ENGINE_TIMING_ID);
 }
 
+void AudioEngine::_signal_output_events()
+{
+    /* Every chunk queues exactly one sync event. The dispatcher only needs those when
+     * processing other events, so it is left sleeping while there is nothing else */
+    _unsignaled_chunks++;
+    uint32_t unsignaled_events = _main_out_queue.pushed_events() - _signaled_events;
+    if (unsignaled_events > _unsignaled_chunks || _unsignaled_chunks >= MAX_UNSIGNALED_CHUNKS)
+    {
+        _event_dispatcher->signal_rt_events();
+        _signaled_events += unsignaled_events;
+        _unsignaled_chunks = 0;
+    }
+}
+
 void AudioEngine::set_tempo(float tempo)
 {
     bool realtime_running = _state != RealtimeState::STOPPED;
@@ -535,17 +587,49 @@ void AudioEngine::set_tempo_sync_mode(SyncMode mode)
     }
 }
 
+EngineReturnStatus AudioEngine::set_rt_event_queue_capacity(int capacity)
+{
+    if (realtime() || capacity <= 0)
+    {
+        return EngineReturnStatus::ERROR;
+    }
+    _main_in_queue.set_capacity(capacity);
+    _input_deferrals.store(0);
+    SUSHI_LOG_INFO("Rt event queue capacity set to {}", _main_in_queue.capacity());
+    return EngineReturnStatus::OK;
+}
+
+RtEventQueueStatistics AudioEngine::rt_event_queue_statistics() const
+{
+    RtEventQueueStatistics statistics;
+    statistics.input_capacity = _main_in_queue.capacity();
+    statistics.input_high_water_mark = _main_in_queue.high_water_mark();
+    statistics.input_overflows = _main_in_queue.overflows();
+    statistics.input_deferrals = _input_deferrals.load(std::memory_order_relaxed);
+    statistics.output_overflows = _main_out_queue.overflows();
+    for (const auto& track : _processors.all_tracks())
+    {
+        statistics.track_overflows += track->dropped_keyboard_events();
+    }
+    return statistics;
+}
+
 EngineReturnStatus AudioEngine::send_rt_event(const RtEvent& event)
 {
     auto status = _main_in_queue.push(event);
     return status? EngineReturnStatus::OK : EngineReturnStatus::QUEUE_FULL;
 }
 
+EngineReturnStatus AudioEngine::send_scheduled_rt_event(const RtEvent& event, Time timestamp)
+{
+    auto status = _direct_scheduled_in_queue.push({timestamp, event});
+    return status? EngineReturnStatus::OK : EngineReturnStatus::QUEUE_FULL;
+}
+
 EngineReturnStatus AudioEngine::_send_control_event(RtEvent& event)
 {
     // This queue will only handle engine control events, not processor events
     assert(event.type() >= RtEventType::STOP_ENGINE);
-    std::lock_guard<std::mutex> lock(_in_queue_lock);
     if (_control_queue_in.push(event))
     {
         return EngineReturnStatus::OK;
@@ -553,6 +637,107 @@ EngineReturnStatus AudioEngine::_send_control_event(RtEvent& event)
     return EngineReturnStatus::QUEUE_FULL;
 }
 
+bool AudioEngine::_send_graph_events(std::initializer_list<RtEvent> events, std::function<void()> rollback)
+{
+    if (_in_graph_transaction())
+    {
+        // Sent to the rt domain and checked when the transaction is committed
+        GraphTransactionEdit edit{{}, std::move(rollback)};
+        for (const auto& event : events)
+        {
+            edit.event_ids.push_back(event.returnable_event()->event_id());
+        }
+        _graph_transaction->insert(_graph_transaction->end(), events);
+        _graph_transaction_edits.push_back(std::move(edit));
+        return true;
+    }
+    std::vector<EventId> ids;
+    for (auto event : events)
+    {
+        _send_control_event(event);
+        ids.push_back(event.returnable_event()->event_id());
+    }
+    return _event_receiver.wait_for_responses(ids, RT_EVENT_TIMEOUT, true);
+}
+
+EngineReturnStatus AudioEngine::begin_graph_transaction()
+{
+    std::thread::id no_thread;
+    if (_graph_transaction_thread.compare_exchange_strong(no_thread, std::this_thread::get_id()) == false)
+    {
+        SUSHI_LOG_ERROR("A graph transaction is already open");
+        return EngineReturnStatus::ERROR;
+    }
+    _graph_transaction = std::make_unique<std::vector<RtEvent>>();
+    _graph_transaction_edits.clear();
+    return EngineReturnStatus::OK;
+}
+
+EngineReturnStatus AudioEngine::commit_graph_transaction()
+{
+    if (_in_graph_transaction() == false)
+    {
+        SUSHI_LOG_ERROR("No graph transaction to commit");
+        return EngineReturnStatus::ERROR;
+    }
+    auto edits = std::move(_graph_transaction_edits);
+    _graph_transaction_edits.clear();
+    auto graph_events = std::move(_graph_transaction);
+    _graph_transaction_thread.store(std::thread::id());
+    if (graph_events->empty())
+    {
+        return EngineReturnStatus::OK;
+    }
+
+    SUSHI_LOG_DEBUG("Committing graph transaction with {} events", graph_events->size());
+    /* Ownership of the events passes to the rt thread, they are deleted by the
+     * event receiver when returned, also if that happens after the timeout */
+    auto undo_events = std::make_unique<std::vector<RtEvent>>();
+    undo_events->reserve(graph_events->size());
+    auto event = RtEvent::make_graph_transaction_event(graph_events.release(), undo_events.release());
+    if (_send_control_event(event) != EngineReturnStatus::OK)
+    {
+        event.graph_transaction_event()->delete_events();
+        SUSHI_LOG_ERROR("Failed to send graph transaction");
+        return EngineReturnStatus::ERROR;
+    }
+    if (_event_receiver.wait_for_response(event.returnable_event()->event_id(), RT_EVENT_TIMEOUT))
+    {
+        /* Consume the responses of the individual events */
+        for (const auto& edit : edits)
+        {
+            _event_receiver.wait_for_responses(edit.event_ids, std::chrono::milliseconds(0));
+        }
+        return EngineReturnStatus::OK;
+    }
+
+    if (_event_receiver.has_response(edits.front().event_ids.front()) == false)
+    {
+        /* The rt thread may still apply the edits, so nothing can be rolled back. Their
+         * responses are returned together with the transaction, so none are received yet */
+        SUSHI_LOG_ERROR("Graph transaction timed out");
+        std::vector<EventId> ids{event.returnable_event()->event_id()};
+        for (const auto& edit : edits)
+        {
+            ids.insert(ids.end(), edit.event_ids.begin(), edit.event_ids.end());
+        }
+        _event_receiver.discard_responses(ids);
+        return EngineReturnStatus::ERROR;
+    }
+    /* The rt thread reverted the whole transaction if any edit failed, so the non-rt
+     * side of every edit is undone, in reverse order */
+    SUSHI_LOG_ERROR("Graph transaction failed, rolling it back");
+    for (auto edit = edits.rbegin(); edit != edits.rend(); ++edit)
+    {
+        _event_receiver.wait_for_responses(edit->event_ids, std::chrono::milliseconds(0));
+        if (edit->rollback)
+        {
+            edit->rollback();
+        }
+    }
+    return EngineReturnStatus::ERROR;
+}
+
 std::pair<EngineReturnStatus, ObjectId> AudioEngine::create_multibus_track(const std::string& name,
                                                                            int input_busses,
                                                                            int output_busses)
@@ -600,25 +785,32 @@ EngineReturnStatus AudioEngine::delete_track(ObjectId track_id)
         SUSHI_LOG_ERROR("Couldn't delete track {}, track not empty", track_id);
         return EngineReturnStatus::ERROR;
     }
-
-    // First remove any audio connections, if realtime, this is done with RtEvents
-    _remove_connections_from_track(track->id());
+    if (_in_graph_transaction())
+    {
+        SUSHI_LOG_ERROR("Couldn't delete track {}, not possible during a graph transaction", track_id);
+        return EngineReturnStatus::ERROR;
+    }
 
     if (realtime())
     {
-        auto remove_event = RtEvent::make_remove_track_event(track->id());
-        auto delete_event = RtEvent::make_remove_processor_event(track->id());
-        _send_control_event(remove_event);
-        _send_control_event(delete_event);
-        bool removed = _event_receiver.wait_for_response(remove_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
-        bool deleted = _event_receiver.wait_for_response(delete_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
-        if (!removed || !deleted)
+        // Disconnect and remove the track from the rt domain in the same chunk
+        if (begin_graph_transaction() != EngineReturnStatus::OK)
         {
-            SUSHI_LOG_ERROR("Failed to remove processor {} from processing part", track->name());
+            SUSHI_LOG_ERROR("Couldn't delete track {}, another thread has a graph transaction open", track_id);
+            return EngineReturnStatus::ERROR;
+        }
+        _remove_connections_from_track(track->id());
+        _send_graph_events({RtEvent::make_remove_track_event(track->id()),
+                            RtEvent::make_remove_processor_event(track->id())});
+        if (commit_graph_transaction() != EngineReturnStatus::OK)
+        {
+            SUSHI_LOG_ERROR("Failed to remove track {} from processing part", track->name());
+            return EngineReturnStatus::ERROR;
         }
     }
     else
     {
+        _remove_connections_from_track(track->id());
         _audio_graph.remove(track.get());
         [[maybe_unused]] bool removed = _remove_processor_from_realtime_part(track->id());
         SUSHI_LOG_WARNING_IF(removed == false, "Plugin track {} was not in the audio graph", track_id);
@@ -652,9 +844,14 @@ std::pair<EngineReturnStatus, ObjectId> AudioEngine::create_processor(const Plug
     if (this->realtime())
     {
         // In realtime mode we need to handle this in the audio thread
-        auto insert_event = RtEvent::make_insert_processor_event(processor.get());
-        _send_control_event(insert_event);
-        bool inserted = _event_receiver.wait_for_response(insert_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
+        bool inserted = _send_graph_events({RtEvent::make_insert_processor_event(processor.get())}, [this, processor]()
+        {
+            _processors.remove_processor(processor->id());
+            _event_dispatcher->post_event(new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_DELETED,
+                                                                          processor->id(),
+                                                                          0,
+                                                                          IMMEDIATE_PROCESS));
+        });
         if (!inserted)
         {
             SUSHI_LOG_ERROR("Failed to insert processor {} to processing part", processor_name);
@@ -701,9 +898,15 @@ EngineReturnStatus AudioEngine::add_plugin_to_track(ObjectId plugin_id,
     if (this->realtime())
     {
         // In realtime mode we need to handle this in the audio thread
-        RtEvent add_event = RtEvent::make_add_processor_to_track_event(plugin_id, track_id, before_plugin_id);
-        _send_control_event(add_event);
-        bool added = _event_receiver.wait_for_response(add_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
+        bool added = _send_graph_events({RtEvent::make_add_processor_to_track_event(plugin_id, track_id, before_plugin_id)},
+                                        [this, plugin_id, track_id]()
+        {
+            _processors.remove_from_track(plugin_id, track_id);
+            _event_dispatcher->post_event(new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_REMOVED_FROM_TRACK,
+                                                                          plugin_id,
+                                                                          track_id,
+                                                                          IMMEDIATE_PROCESS));
+        });
         if (added == false)
         {
             SUSHI_LOG_ERROR("Failed to add processor {} to track {}", plugin->name(), track->name());
@@ -745,9 +948,29 @@ EngineReturnStatus AudioEngine::remove_plugin_from_track(ObjectId plugin_id, Obj
     if (realtime())
     {
         // Send events to handle this in the rt domain
-        auto remove_event = RtEvent::make_remove_processor_from_track_event(plugin_id, track_id);
-        _send_control_event(remove_event);
-        [[maybe_unused]] bool remove_ok = _event_receiver.wait_for_response(remove_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
+        /* Remember the position on the track in case the removal needs to be rolled back */
+        auto track_processors = _processors.processors_on_track(track_id);
+        auto position = std::find_if(track_processors.begin(), track_processors.end(),
+                                     [&](const auto& p) {return p->id() == plugin_id;});
+        std::function<void()> rollback;
+        if (position != track_processors.end())
+        {
+            std::optional<ObjectId> next_plugin_id;
+            if (position + 1 != track_processors.end())
+            {
+                next_plugin_id = (*(position + 1))->id();
+            }
+            rollback = [this, plugin_id, track_id, next_plugin_id]()
+            {
+                _processors.add_to_track(_processors.mutable_processor(plugin_id), track_id, next_plugin_id);
+                _event_dispatcher->post_event(new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_ADDED_TO_TRACK,
+                                                                              plugin_id,
+                                                                              track_id,
+                                                                              IMMEDIATE_PROCESS));
+            };
+        }
+        [[maybe_unused]] bool remove_ok = _send_graph_events({RtEvent::make_remove_processor_from_track_event(plugin_id, track_id)},
+                                                             std::move(rollback));
         SUSHI_LOG_ERROR_IF(remove_ok == false, "Failed to remove/delete processor {} from processing part", plugin_id);
     }
     else
@@ -783,12 +1006,15 @@ EngineReturnStatus AudioEngine::delete_plugin(ObjectId plugin_id)
         SUSHI_LOG_ERROR("Cannot delete processor {}, active on track", processor->name());
         return EngineReturnStatus::ERROR;
     }
+    if (_in_graph_transaction())
+    {
+        SUSHI_LOG_ERROR("Cannot delete processor {} during a graph transaction", processor->name());
+        return EngineReturnStatus::ERROR;
+    }
     if (realtime())
     {
         // Send events to handle this in the rt domain
-        auto delete_event = RtEvent::make_remove_processor_event(processor->id());
-        _send_control_event(delete_event);
-        [[maybe_unused]] bool delete_ok = _event_receiver.wait_for_response(delete_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
+        [[maybe_unused]] bool delete_ok = _send_graph_events({RtEvent::make_remove_processor_event(processor->id())});
         SUSHI_LOG_ERROR_IF(delete_ok == false, "Failed to remove/delete processor {} from processing part", plugin_id);
     }
     else
@@ -816,13 +1042,17 @@ EngineReturnStatus AudioEngine::_register_new_track(const std::string& name, std
 
     if (realtime())
     {
-        auto insert_event = RtEvent::make_insert_processor_event(track.get());
-        auto add_event = RtEvent::make_add_track_event(track->id());
-        _send_control_event(insert_event);
-        _send_control_event(add_event);
-        bool inserted = _event_receiver.wait_for_response(insert_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
-        bool added = _event_receiver.wait_for_response(add_event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
-        if (!inserted || !added)
+        bool added = _send_graph_events({RtEvent::make_insert_processor_event(track.get()),
+                                         RtEvent::make_add_track_event(track->id())}, [this, track]()
+        {
+            _processors.remove_track(track->id());
+            _processors.remove_processor(track->id());
+            _event_dispatcher->post_event(new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::TRACK_DELETED,
+                                                                          0,
+                                                                          track->id(),
+                                                                          IMMEDIATE_PROCESS));
+        });
+        if (!added)
         {
             SUSHI_LOG_ERROR("Failed to insert/add track {} to processing part", name);
             return EngineReturnStatus::INVALID_PROCESSOR;
@@ -901,8 +1131,7 @@ EngineReturnStatus AudioEngine::_connect_audio_channel(int engine_channel,
     {
         auto event = direction == Direction::INPUT ? RtEvent::make_add_audio_input_connection_event(con) :
                                                      RtEvent::make_add_audio_output_connection_event(con);
-        _send_control_event(event);
-        added = _event_receiver.wait_for_response(event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
+        added = _send_graph_events({event}, [&storage, con]() {storage.remove(con, false);});
         if (added == false)
         {
             storage.remove(con, false);
@@ -915,6 +1144,7 @@ EngineReturnStatus AudioEngine::_connect_audio_channel(int engine_channel,
         return EngineReturnStatus::ERROR;
     }
 
+    _audio_routing_changed = true;
     SUSHI_LOG_INFO("Connected engine {} {} to channel {} of track \"{}\"",
                         direction == Direction::INPUT ? "input" : "output", engine_channel, track_channel, track_id);
     return EngineReturnStatus::OK;
@@ -941,8 +1171,7 @@ EngineReturnStatus AudioEngine::_disconnect_audio_channel(int engine_channel,
     {
         auto event = direction == Direction::INPUT ? RtEvent::make_remove_audio_input_connection_event(con) :
                                                      RtEvent::make_remove_audio_output_connection_event(con);
-        _send_control_event(event);
-        removed = _event_receiver.wait_for_response(event.returnable_event()->event_id(), RT_EVENT_TIMEOUT);
+        removed = _send_graph_events({event}, [&storage, con]() {storage.add(con, false);});
         SUSHI_LOG_ERROR_IF(removed == false, "Failed to remove audio connection in realtime thread");
     }
     else if (removed == false)
@@ -951,6 +1180,7 @@ EngineReturnStatus AudioEngine::_disconnect_audio_channel(int engine_channel,
         return EngineReturnStatus::ERROR;
     }
 
+    _audio_routing_changed = true;
     SUSHI_LOG_INFO("Removed {} audio connection from channel {} of track \"{}\" and engine channel {}",
                          direction == Direction::INPUT ? "input" : "output", track_channel, track->name(), engine_channel);
     return EngineReturnStatus::OK;
@@ -959,118 +1189,272 @@ EngineReturnStatus AudioEngine::_disconnect_audio_channel(int engine_channel,
 void AudioEngine::_process_internal_rt_events()
 {
     RtEvent event;
+    bool returned_events = false;
     while(_control_queue_in.pop(event))
     {
-        switch (event.type())
+        _process_control_event(event);
+        _control_queue_out.push(event); // Send event back to non-rt domain
+        returned_events = true;
+    }
+    if (returned_events)
+    {
+        _event_receiver.notify();
+    }
+}
+
+void AudioEngine::_process_control_event(RtEvent& event)
+{
+    switch (event.type())
+    {
+        case RtEventType::STOP_ENGINE:
+        {
+            auto typed_event = event.returnable_event();
+            _state.store(RealtimeState::STOPPING);
+            typed_event->set_handled(true);
+            break;
+        }
+        case RtEventType::TEMPO:
+        case RtEventType::TIME_SIGNATURE:
+        case RtEventType::PLAYING_MODE:
+        case RtEventType::SYNC_MODE:
+        {
+            _transport.process_event(event);
+            break;
+        }
+        case RtEventType::INSERT_PROCESSOR:
+        {
+            auto typed_event = event.processor_operation_event();
+            bool inserted = _insert_processor_in_realtime_part(typed_event->instance());
+            typed_event->set_handled(inserted);
+            break;
+        }
+        case RtEventType::REMOVE_PROCESSOR:
         {
-            case RtEventType::STOP_ENGINE:
+            auto typed_event = event.processor_reorder_event();
+            bool removed = _remove_processor_from_realtime_part(typed_event->processor());
+            typed_event->set_handled(removed);
+            break;
+        }
+        case RtEventType::ADD_PROCESSOR_TO_TRACK:
+        {
+            auto typed_event = event.processor_reorder_event();
+            Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
+            Processor*processor = static_cast<Processor*>(_realtime_processors[typed_event->processor()]);
+            bool added = false;
+            if (track && processor)
             {
-                auto typed_event = event.returnable_event();
-                _state.store(RealtimeState::STOPPING);
-                typed_event->set_handled(true);
-                break;
+                added = track->add(processor, typed_event->before_processor());
             }
-            case RtEventType::TEMPO:
-            case RtEventType::TIME_SIGNATURE:
-            case RtEventType::PLAYING_MODE:
-            case RtEventType::SYNC_MODE:
+            typed_event->set_handled(added);
+            break;
+        }
+        case RtEventType::REMOVE_PROCESSOR_FROM_TRACK:
+        {
+            auto typed_event = event.processor_reorder_event();
+            Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
+            bool removed = false;
+            if (track)
             {
-                _transport.process_event(event);
-                break;
+                removed = track->remove(typed_event->processor());
             }
-            case RtEventType::INSERT_PROCESSOR:
+            typed_event->set_handled(removed);
+            break;
+        }
+        case RtEventType::ADD_TRACK:
+        {
+            auto typed_event = event.add_track_event();
+            Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
+            bool added = false;
+            if (track && typed_event->core().has_value())
             {
-                auto typed_event = event.processor_operation_event();
-                bool inserted = _insert_processor_in_realtime_part(typed_event->instance());
-                typed_event->set_handled(inserted);
-                break;
+                int core = typed_event->core().value();
+                added = _audio_graph.move_to_core(track, core) || _audio_graph.add_to_core(track, core);
             }
-            case RtEventType::REMOVE_PROCESSOR:
+            else if (track)
             {
-                auto typed_event = event.processor_reorder_event();
-                bool removed = _remove_processor_from_realtime_part(typed_event->processor());
-                typed_event->set_handled(removed);
-                break;
+                added = _audio_graph.add(track);
             }
-            case RtEventType::ADD_PROCESSOR_TO_TRACK:
+            typed_event->set_handled(added);
+            break;
+        }
+        case RtEventType::REMOVE_TRACK:
+        {
+            auto typed_event = event.processor_reorder_event();
+            Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
+            bool removed = false;
+            if (track)
             {
-                auto typed_event = event.processor_reorder_event();
-                Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
-                Processor*processor = static_cast<Processor*>(_realtime_processors[typed_event->processor()]);
-                bool added = false;
-                if (track && processor)
-                {
-                    added = track->add(processor, typed_event->before_processor());
-                }
-                typed_event->set_handled(added);
-                break;
+                removed = _audio_graph.remove(track);
             }
-            case RtEventType::REMOVE_PROCESSOR_FROM_TRACK:
+            typed_event->set_handled(removed);
+            break;
+        }
+        case RtEventType::GRAPH_TRANSACTION:
+        {
+            auto typed_event = event.graph_transaction_event();
+            auto& undo_events = *typed_event->undo_events();
+            bool all_ok = true;
+            for (auto& graph_event : *typed_event->events())
             {
-                auto typed_event = event.processor_reorder_event();
-                Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
-                bool removed = false;
-                if (track)
+                auto undo_event = _make_graph_undo_event(graph_event);
+                _process_control_event(graph_event);
+                if (graph_event.returnable_event()->status() != ReturnableRtEvent::EventStatus::HANDLED_OK)
                 {
-                    removed = track->remove(typed_event->processor());
+                    all_ok = false;
+                    break;
                 }
-                typed_event->set_handled(removed);
-                break;
-            }
-            case RtEventType::ADD_TRACK:
-            {
-                auto typed_event = event.processor_reorder_event();
-                Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
-                bool added = false;
-                if (track)
+                if (undo_event.has_value())
                 {
-                    added = _audio_graph.add(track);
+                    undo_events.push_back(*undo_event);
                 }
-                typed_event->set_handled(added);
-                break;
             }
-            case RtEventType::REMOVE_TRACK:
+            if (all_ok == false)
             {
-                auto typed_event = event.processor_reorder_event();
-                Track* track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
-                bool removed = false;
-                if (track)
+                /* Revert the events applied so far, so that nothing from a failed transaction
+                 * stays in the rt part, and fail all of them so that every edit is rolled back */
+                for (auto undo_event = undo_events.rbegin(); undo_event != undo_events.rend(); ++undo_event)
+                {
+                    _process_control_event(*undo_event);
+                }
+                for (auto& graph_event : *typed_event->events())
                 {
-                    removed = _audio_graph.remove(track);
+                    graph_event.returnable_event()->set_handled(false);
                 }
-                typed_event->set_handled(removed);
-                break;
             }
-            case RtEventType::ADD_AUDIO_CONNECTION:
+            typed_event->set_handled(all_ok);
+            break;
+        }
+        case RtEventType::ADD_AUDIO_CONNECTION:
+        {
+            auto typed_event = event.audio_connection_event();
+            assert(_realtime_processors[typed_event->connection().track]);
+            auto& storage = typed_event->input_connection() ? _audio_in_connections : _audio_out_connections;
+            typed_event->set_handled(storage.add_rt(typed_event->connection()));
+            /* Routing is updated once after all control events in this chunk are handled */
+            _audio_routing_changed = true;
+            break;
+        }
+        case RtEventType::REMOVE_AUDIO_CONNECTION:
+        {
+            auto typed_event = event.audio_connection_event();
+            auto& storage = typed_event->input_connection() ? _audio_in_connections : _audio_out_connections;
+            typed_event->set_handled(storage.remove_rt(typed_event->connection()));
+            _audio_routing_changed = true;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+std::optional<RtEvent> AudioEngine::_make_graph_undo_event(const RtEvent& event)
+{
+    switch (event.type())
+    {
+        case RtEventType::INSERT_PROCESSOR:
+            return RtEvent::make_remove_processor_event(event.processor_operation_event()->instance()->id());
+
+        case RtEventType::REMOVE_PROCESSOR:
+        {
+            auto processor = _realtime_processors[event.processor_reorder_event()->processor()];
+            if (processor == nullptr)
+            {
+                return std::nullopt;
+            }
+            return RtEvent::make_insert_processor_event(processor);
+        }
+
+        case RtEventType::ADD_PROCESSOR_TO_TRACK:
+        {
+            auto typed_event = event.processor_reorder_event();
+            return RtEvent::make_remove_processor_from_track_event(typed_event->processor(), typed_event->track());
+        }
+
+        case RtEventType::REMOVE_PROCESSOR_FROM_TRACK:
+        {
+            auto typed_event = event.processor_reorder_event();
+            auto track = static_cast<Track*>(_realtime_processors[typed_event->track()]);
+            if (track == nullptr)
             {
-                auto typed_event = event.audio_connection_event();
-                assert(_realtime_processors[typed_event->connection().track]);
-                auto& storage = typed_event->input_connection() ? _audio_in_connections : _audio_out_connections;
-                typed_event->set_handled(storage.add_rt(typed_event->connection()));
-                break;
+                return std::nullopt;
             }
-            case RtEventType::REMOVE_AUDIO_CONNECTION:
+            return RtEvent::make_add_processor_to_track_event(typed_event->processor(),
+                                                              typed_event->track(),
+                                                              track->next_processor(typed_event->processor()));
+        }
+
+        case RtEventType::ADD_TRACK:
+        {
+            auto track_id = event.add_track_event()->track();
+            auto core = _audio_graph.core_of(static_cast<Track*>(_realtime_processors[track_id]));
+            if (core.has_value())
             {
-                auto typed_event = event.audio_connection_event();
-                auto& storage = typed_event->input_connection() ? _audio_in_connections : _audio_out_connections;
-                typed_event->set_handled(storage.remove_rt(typed_event->connection()));
-                break;
+                // The track was moved between cores, so move it back
+                return RtEvent::make_add_track_event(track_id, core);
             }
+            return RtEvent::make_remove_track_event(track_id);
+        }
 
-            default:
-                break;
+        case RtEventType::REMOVE_TRACK:
+        {
+            auto track_id = event.processor_reorder_event()->track();
+            auto core = _audio_graph.core_of(static_cast<Track*>(_realtime_processors[track_id]));
+            return RtEvent::make_add_track_event(track_id, core);
         }
-        _control_queue_out.push(event); // Send event back to non-rt domain
+
+        case RtEventType::ADD_AUDIO_CONNECTION:
+        {
+            auto typed_event = event.audio_connection_event();
+            return typed_event->input_connection() ? RtEvent::make_remove_audio_input_connection_event(typed_event->connection()) :
+                                                     RtEvent::make_remove_audio_output_connection_event(typed_event->connection());
+        }
+
+        case RtEventType::REMOVE_AUDIO_CONNECTION:
+        {
+            auto typed_event = event.audio_connection_event();
+            return typed_event->input_connection() ? RtEvent::make_add_audio_input_connection_event(typed_event->connection()) :
+                                                     RtEvent::make_add_audio_output_connection_event(typed_event->connection());
+        }
+
+        default:
+            return std::nullopt;
+    }
+}
+
+int AudioEngine::_send_rt_events_to_processors(int max_events)
+{
+    RtEvent event;
+    int count = 0;
+    while(count < max_events && _main_in_queue.pop(event))
+    {
+        _send_rt_event(event);
+        count++;
     }
+    return count;
 }
 
-void AudioEngine::_send_rt_events_to_processors()
+int AudioEngine::_send_scheduled_rt_events(int max_events)
 {
+    /* Events that don't fit in the scheduler stay in the queue until there is room */
+    ScheduledRtEvent scheduled_event;
+    while (_event_scheduler.full() == false && _direct_scheduled_in_queue.pop(scheduled_event))
+    {
+        _event_scheduler.schedule(scheduled_event);
+    }
+    while (_event_scheduler.full() == false && _scheduled_in_queue.pop(scheduled_event))
+    {
+        _event_scheduler.schedule(scheduled_event);
+    }
+    /* Due events beyond max_events stay in the scheduler and are sent with offset 0 next chunk */
     RtEvent event;
-    while(_main_in_queue.pop(event))
+    int count = 0;
+    while (count < max_events && _event_scheduler.pop_due_event(_transport.current_process_time(), event))
     {
         _send_rt_event(event);
+        count++;
     }
+    return count;
 }
 
 void AudioEngine::_send_rt_event(const RtEvent& event)
@@ -1113,9 +1497,84 @@ void AudioEngine::_retrieve_events_from_tracks(ControlBuffer& buffer)
     }
 }
 
+void AudioEngine::_update_audio_routing()
+{
+    for (const auto& alias : _input_aliases)
+    {
+        if (auto track = static_cast<Track*>(_realtime_processors[alias.track]); track)
+        {
+            track->clear_input_alias();
+        }
+    }
+    for (const auto& alias : _output_aliases)
+    {
+        if (auto track = static_cast<Track*>(_realtime_processors[alias.track]); track)
+        {
+            track->clear_output_alias();
+        }
+    }
+    _input_aliases.clear();
+    _output_aliases.clear();
+    _copied_input_connections.clear();
+    _copied_output_connections.clear();
+    _output_aliases_active = false;
+
+    auto is_aliased = [](const std::vector<TrackAudioAlias>& aliases, ObjectId track)
+    {
+        return std::any_of(aliases.begin(), aliases.end(), [&](const auto& a) {return a.track == track;});
+    };
+
+    /* Several tracks may read from the same engine input channel since inputs are
+     * never written to, but an output channel can only be written by one track */
+    const auto& inputs = _audio_in_connections.connections_rt();
+    for (const auto& c : inputs)
+    {
+        auto track = static_cast<Track*>(_realtime_processors[c.track]);
+        int channels = track->input_buffer_channels();
+        if (c.track_channel == 0 && can_alias_track_channels(inputs, c, channels, _audio_inputs, false))
+        {
+            _input_aliases.push_back({c.track, c.engine_channel, channels});
+        }
+    }
+    for (const auto& c : inputs)
+    {
+        if (is_aliased(_input_aliases, c.track) == false)
+        {
+            _copied_input_connections.push_back(c);
+        }
+    }
+
+    const auto& outputs = _audio_out_connections.connections_rt();
+    for (const auto& c : outputs)
+    {
+        auto track = static_cast<Track*>(_realtime_processors[c.track]);
+        int channels = track->output_buffer_channels();
+        if (c.track_channel == 0 && can_alias_track_channels(outputs, c, channels, _audio_outputs, true))
+        {
+            _output_aliases.push_back({c.track, c.engine_channel, channels});
+        }
+    }
+    for (const auto& c : outputs)
+    {
+        if (is_aliased(_output_aliases, c.track) == false)
+        {
+            _copied_output_connections.push_back(c);
+        }
+    }
+    /* Sorted so that the channels not written to by tracks can be cleared in one pass */
+    std::sort(_output_aliases.begin(), _output_aliases.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.engine_channel < rhs.engine_channel;
+    });
+}
+
 void AudioEngine::_copy_audio_to_tracks(ChunkSampleBuffer* input)
 {
-    for (const auto& c : _audio_in_connections.connections_rt())
+    for (const auto& alias : _input_aliases)
+    {
+        static_cast<Track*>(_realtime_processors[alias.track])->set_input_alias(*input, alias.engine_channel);
+    }
+    for (const auto& c : _copied_input_connections)
     {
         auto engine_in = ChunkSampleBuffer::create_non_owning_buffer(*input, c.engine_channel, 1);
         auto track_in = static_cast<Track*>(_realtime_processors[c.track])->input_channel(c.track_channel);
@@ -1123,10 +1582,47 @@ void AudioEngine::_copy_audio_to_tracks(ChunkSampleBuffer* input)
     }
 }
 
+void AudioEngine::_alias_audio_from_tracks(ChunkSampleBuffer* output, bool enabled)
+{
+    for (const auto& alias : _output_aliases)
+    {
+        auto track = static_cast<Track*>(_realtime_processors[alias.track]);
+        if (enabled)
+        {
+            track->set_output_alias(*output, alias.engine_channel);
+        }
+        else
+        {
+            track->clear_output_alias();
+        }
+    }
+    _output_aliases_active = enabled;
+}
+
 void AudioEngine::_copy_audio_from_tracks(ChunkSampleBuffer* output)
 {
-    output->clear();
-    for (const auto& c : _audio_out_connections.connections_rt())
+    if (_output_aliases_active == false)
+    {
+        output->clear();
+        for (const auto& c : _audio_out_connections.connections_rt())
+        {
+            auto track_out = static_cast<Track*>(_realtime_processors[c.track])->output_channel(c.track_channel);
+            auto engine_out = ChunkSampleBuffer::create_non_owning_buffer(*output, c.engine_channel, 1);
+            engine_out.add(track_out);
+        }
+        return;
+    }
+
+    /* Aliased tracks have already rendered into their output channels */
+    int channel = 0;
+    for (const auto& alias : _output_aliases)
+    {
+        ChunkSampleBuffer::create_non_owning_buffer(*output, channel, alias.engine_channel - channel).clear();
+        channel = alias.engine_channel + alias.channels;
+    }
+    ChunkSampleBuffer::create_non_owning_buffer(*output, channel, output->channel_count() - channel).clear();
+
+    for (const auto& c : _copied_output_connections)
     {
         auto track_out = static_cast<Track*>(_realtime_processors[c.track])->output_channel(c.track_channel);
         auto engine_out = ChunkSampleBuffer::create_non_owning_buffer(*output, c.engine_channel, 1);
@@ -1141,6 +1637,25 @@ void AudioEngine::update_timings()
         auto engine_timings = _process_timer.timings_for_node(ENGINE_TIMING_ID);
         _event_dispatcher->post_event(new EngineTimingNotificationEvent(*engine_timings, IMMEDIATE_PROCESS));
 
+        auto deadline_misses = _process_timer.deadline_misses();
+        if (deadline_misses.empty() == false)
+        {
+            int remaining = MAX_RECORDED_DEADLINE_MISSES - _written_deadline_misses;
+            if (static_cast<int>(deadline_misses.size()) > remaining)
+            {
+                SUSHI_LOG_WARNING_IF(remaining > 0, "Recorded {} deadline misses, not writing any more to {}",
+                                     MAX_RECORDED_DEADLINE_MISSES, _deadline_miss_file);
+                deadline_misses.resize(std::max(remaining, 0));
+            }
+            if (deadline_misses.empty() == false)
+            {
+                SUSHI_LOG_WARNING("Engine missed its deadline {} times, writing processing history to {}",
+                                  deadline_misses.size(), _deadline_miss_file);
+                print_deadline_misses_to_file(_deadline_miss_file, deadline_misses);
+                _written_deadline_misses += deadline_misses.size();
+            }
+        }
+
         _log_timing_print_counter += 1;
         if (_log_timing_print_counter > TIMING_LOG_PRINT_INTERVAL)
         {
@@ -1156,11 +1671,75 @@ void AudioEngine::update_timings()
             }
             if (engine_timings.has_value())
             {
-                SUSHI_LOG_INFO("Engine total: avg: {}%, min: {}%, max: {}%",
-                               engine_timings->avg_case * 100.0f, engine_timings->min_case * 100.0f, engine_timings->max_case * 100.0f);
+                SUSHI_LOG_INFO("Engine total: avg: {}%, min: {}%, max: {}%, p99: {}%, overruns: {}",
+                               engine_timings->avg_case * 100.0f, engine_timings->min_case * 100.0f, engine_timings->max_case * 100.0f,
+                               engine_timings->p99_case * 100.0f, engine_timings->overruns);
             }
             _log_timing_print_counter = 0;
         }
+
+        _track_balancing_counter += 1;
+        if (_track_balancing_counter >= TRACK_BALANCING_INTERVAL && _audio_graph.cores() > 1)
+        {
+            _balance_track_loads();
+            _track_balancing_counter = 0;
+        }
+    }
+}
+
+void AudioEngine::_balance_track_loads()
+{
+    if (realtime() == false)
+    {
+        return;
+    }
+    std::map<ObjectId, float> track_loads;
+    for (const auto& track : _processors.all_tracks())
+    {
+        auto timings = _process_timer.timings_for_node(track->id());
+        if (timings.has_value() == false)
+        {
+            // Wait until all tracks have been measured
+            return;
+        }
+        track_loads[track->id()] = timings->avg_case;
+    }
+
+    auto new_track_cores = balance_track_loads(track_loads, _audio_graph.cores());
+    bool all_assigned = std::all_of(track_loads.begin(), track_loads.end(), [&](const auto& t)
+                                    {return _track_cores.count(t.first) > 0;});
+    if (all_assigned)
+    {
+        float current_load = max_core_load(track_loads, _track_cores, _audio_graph.cores());
+        float new_load = max_core_load(track_loads, new_track_cores, _audio_graph.cores());
+        if (new_load > current_load * (1.0f - TRACK_BALANCING_THRESHOLD))
+        {
+            return;
+        }
+        SUSHI_LOG_INFO("Rebalancing tracks, max core load {}% -> {}%", current_load * 100.0f, new_load * 100.0f);
+    }
+
+    /* All moves are applied in the same chunk, with a single wait for the rt thread */
+    if (begin_graph_transaction() != EngineReturnStatus::OK)
+    {
+        // The graph is being edited from another thread, try again at the next update
+        return;
+    }
+    for (const auto& [track_id, core] : new_track_cores)
+    {
+        auto prev_core = _track_cores.find(track_id);
+        if (prev_core == _track_cores.end() || prev_core->second != core)
+        {
+            _send_graph_events({RtEvent::make_add_track_event(track_id, core)});
+        }
+    }
+    if (commit_graph_transaction() == EngineReturnStatus::OK)
+    {
+        _track_cores = new_track_cores;
+    }
+    else
+    {
+        SUSHI_LOG_ERROR("Failed to move tracks to new cores");
     }
 }
 
@@ -1171,7 +1750,12 @@ void print_single_timings_for_node(std::fstream& f, performance::PerformanceTime
     {
         f << std::setw(16) << timings.value().avg_case * 100.0
           << std::setw(16) << timings.value().min_case * 100.0
-          << std::setw(16) << timings.value().max_case * 100.0 <<"\n";
+          << std::setw(16) << timings.value().max_case * 100.0
+          << std::setw(16) << timings.value().p50_case * 100.0
+          << std::setw(16) << timings.value().p90_case * 100.0
+          << std::setw(16) << timings.value().p99_case * 100.0
+          << std::setw(16) << timings.value().p999_case * 100.0
+          << std::setw(16) << timings.value().overruns <<"\n";
     }
 }
 
@@ -1187,7 +1771,8 @@ void AudioEngine::print_timings_to_file(const std::string& filename)
     file.setf(std::ios::left);
     file << "Performance timings for all processors in percentages of audio buffer (100% = "<< 1000000.0 / _sample_rate * AUDIO_CHUNK_SIZE
          << "us)\n\n" << std::setw(24) << "" << std::setw(16) << "average(%)" << std::setw(16) << "minimum(%)"
-         << std::setw(16) << "maximum(%)" << std::endl;
+         << std::setw(16) << "maximum(%)" << std::setw(16) << "p50(%)" << std::setw(16) << "p90(%)"
+         << std::setw(16) << "p99(%)" << std::setw(16) << "p99.9(%)" << std::setw(16) << "overruns" << std::endl;
 
     for (const auto& track : _processors.all_tracks())
     {
@@ -1207,6 +1792,49 @@ void AudioEngine::print_timings_to_file(const std::string& filename)
     file.close();
 }
 
+void AudioEngine::enable_deadline_miss_recording(bool enabled, const std::string& filename)
+{
+    _deadline_miss_file = filename;
+    _written_deadline_misses = 0;
+    _process_timer.enable_flight_recorder(ENGINE_TIMING_ID, enabled ? FLIGHT_RECORDER_CHUNKS : 0);
+}
+
+void AudioEngine::print_deadline_misses_to_file(const std::string& filename,
+                                                const std::vector<performance::DeadlineMiss>& misses)
+{
+    std::fstream file;
+    file.open(filename, std::ios_base::out | std::ios_base::app);
+    if (!file.is_open())
+    {
+        SUSHI_LOG_WARNING("Couldn't write deadline misses to file");
+        return;
+    }
+    file.setf(std::ios::left);
+    for (const auto& miss : misses)
+    {
+        auto period = 1000000.0 / _sample_rate * AUDIO_CHUNK_SIZE;
+        file << "Deadline miss, engine processing took " << miss.trigger.delta_time.count() / 1000.0
+             << "us of " << period << "us, start times are relative to the start of that chunk\n"
+             << std::setw(16) << "start(us)" << std::setw(16) << "duration(us)"
+             << std::setw(16) << "duration(%)" << "processor\n";
+
+        for (const auto& record : miss.records)
+        {
+            std::string name = "Engine total";
+            if (record.id != ENGINE_TIMING_ID)
+            {
+                auto processor = _processors.processor(record.id);
+                name = processor ? processor->name() : std::to_string(record.id);
+            }
+            auto duration = record.delta_time.count() / 1000.0;
+            file << std::setw(16) << (record.start_time - miss.trigger.start_time).count() / 1000.0
+                 << std::setw(16) << duration << std::setw(16) << duration / period * 100.0 << name << "\n";
+        }
+        file << "\n";
+    }
+    file.close();
+}
+
 void AudioEngine::_route_cv_gate_ins(ControlBuffer& buffer)
 {
     for (const auto& r : _cv_in_connections)
@@ -1240,6 +1868,68 @@ void AudioEngine::_route_cv_gate_ins(ControlBuffer& buffer)
     _prev_gate_values = buffer.gate_values;
 }
 
+std::map<ObjectId, int> balance_track_loads(const std::map<ObjectId, float>& track_loads, int cores)
+{
+    std::vector<std::pair<ObjectId, float>> sorted_loads(track_loads.begin(), track_loads.end());
+    std::stable_sort(sorted_loads.begin(), sorted_loads.end(), [](const auto& lhs, const auto& rhs)
+                     {return lhs.second > rhs.second;});
+
+    std::vector<float> core_loads(cores, 0.0f);
+    std::map<ObjectId, int> track_cores;
+    for (const auto& [track_id, load] : sorted_loads)
+    {
+        auto least_loaded = std::min_element(core_loads.begin(), core_loads.end());
+        *least_loaded += load;
+        track_cores[track_id] = static_cast<int>(std::distance(core_loads.begin(), least_loaded));
+    }
+    return track_cores;
+}
+
+float max_core_load(const std::map<ObjectId, float>& track_loads, const std::map<ObjectId, int>& track_cores, int cores)
+{
+    std::vector<float> core_loads(cores, 0.0f);
+    for (const auto& [track_id, load] : track_loads)
+    {
+        auto core = track_cores.find(track_id);
+        if (core != track_cores.end() && core->second < cores)
+        {
+            core_loads[core->second] += load;
+        }
+    }
+    return *std::max_element(core_loads.begin(), core_loads.end());
+}
+
+bool can_alias_track_channels(const std::vector<AudioConnection>& connections, const AudioConnection& first,
+                              int track_channels, int engine_channels, bool exclusive)
+{
+    static_assert(TRACK_MAX_CHANNELS <= 32);
+    if (first.engine_channel < 0 || first.engine_channel + track_channels > engine_channels ||
+        track_channels > TRACK_MAX_CHANNELS)
+    {
+        return false;
+    }
+    uint32_t connected_channels = 0;
+    for (const auto& c : connections)
+    {
+        bool in_range = c.engine_channel >= first.engine_channel && c.engine_channel < first.engine_channel + track_channels;
+        if (c.track == first.track)
+        {
+            uint32_t channel_bit = 1u << c.track_channel;
+            if (c.track_channel >= track_channels || c.engine_channel != first.engine_channel + c.track_channel ||
+                connected_channels & channel_bit)
+            {
+                return false; // Fan-out, duplicates or a non-contiguous mapping
+            }
+            connected_channels |= channel_bit;
+        }
+        else if (exclusive && in_range)
+        {
+            return false; // Fan-in from several tracks
+        }
+    }
+    return connected_channels == (1u << track_channels) - 1;
+}
+
 RealtimeState update_state(RealtimeState current_state)
 {
     if (current_state == RealtimeState::STARTING)
@@ -24,6 +24,10 @@
 #include <vector>
 #include <utility>
 #include <mutex>
+#include <map>
+#include <functional>
+#include <thread>
+#include <optional>
 
 #include "twine/twine.h"
 
@@ -50,6 +54,17 @@
 namespace sushi {
 namespace engine {
 
+/**
+ * @brief A track whose input or output channels map directly onto a contiguous
+ *        range of engine channels starting at engine_channel
+ */
+struct TrackAudioAlias
+{
+    ObjectId track;
+    int engine_channel;
+    int channels;
+};
+
 class ClipDetector
 {
 public:
@@ -338,13 +353,25 @@ public:
     void set_tempo_sync_mode(SyncMode mode) override;
 
     /**
-     * @brief Send an RtEvent directly to the realtime thread, should normally only be used
-     *        from an rt thread or in a context where the engine is not running in realtime mode
+     * @brief Send an RtEvent directly to the realtime thread. Lock free and safe to call
+     *        concurrently from several non-rt threads, i.e. frontends can use it to bypass
+     *        the event dispatcher for events that don't need a timestamp
      * @param event The event to process
      * @return EngineReturnStatus::OK if the event was properly processed, error code otherwise
      */
     EngineReturnStatus send_rt_event(const RtEvent& event) override;
 
+    /**
+     * @brief Send an RtEvent directly to the realtime thread, to be processed at the sample
+     *        position corresponding to timestamp. Lock free and safe to call concurrently
+     *        from several non-rt threads, intended for low latency midi input.
+     * @param event The event to process
+     * @param timestamp The time at which the event should take effect. Events with a
+     *        timestamp in the past are processed at the start of the next chunk
+     * @return EngineReturnStatus::OK if the event was queued, error code otherwise
+     */
+    EngineReturnStatus send_scheduled_rt_event(const RtEvent& event, Time timestamp) override;
+
     /**
      * @brief Create an empty track
      * @param name The unique name of the track to be created.
@@ -409,6 +436,26 @@ public:
      */
     EngineReturnStatus delete_plugin(ObjectId plugin_id) override;
 
+    /**
+     * @brief Open a graph transaction. Until it is committed, track, processor and audio
+     *        connection edits made in realtime mode from the same thread are only prepared
+     *        and not sent to the rt thread, and report success immediately. If any edit fails
+     *        when the transaction is committed, all of them are rolled back. Tracks and processors can
+     *        not be deleted while a transaction is open. Edits from other threads are not
+     *        part of the transaction, and only one transaction can be open at a time.
+     * @return EngineReturnStatus::OK, or EngineReturnStatus::ERROR if a transaction is already open
+     */
+    EngineReturnStatus begin_graph_transaction() override;
+
+    /**
+     * @brief Apply all graph edits made since begin_graph_transaction() in the rt thread,
+     *        all in the same audio chunk, and wait for them to complete. Must be called
+     *        from the thread that opened the transaction.
+     * @return EngineReturnStatus::OK if all edits were applied, EngineReturnStatus::ERROR
+     *         if any edit failed and the whole transaction was rolled back
+     */
+    EngineReturnStatus commit_graph_transaction() override;
+
     /**
      * @brief Enable audio clip detection on engine inputs
      * @param enabled Enable if true, disable if false
@@ -451,16 +498,41 @@ public:
         return &_process_timer;
     }
 
+    /**
+     * @brief Set the capacity of the queue for events to processors. Can only be done
+     *        when the engine is not running in realtime mode.
+     * @param capacity Number of events, rounded up to the nearest power of 2
+     * @return EngineReturnStatus::OK if successful, error code otherwise
+     */
+    EngineReturnStatus set_rt_event_queue_capacity(int capacity) override;
+
+    /**
+     * @brief Get fill levels and overflow counts of the rt event queues
+     * @return An RtEventQueueStatistics struct
+     */
+    RtEventQueueStatistics rt_event_queue_statistics() const override;
+
     const BaseProcessorContainer* processor_container() override
     {
         return &_processors;
     }
 
     /**
-     * @brief Print the current processor timings (in enabled) in the log
+     * @brief Print the current processor timings (in enabled) in the log. If processing
+     *        on several cpu cores, also redistribute tracks over the cores based on
+     *        their measured processing times.
      */
     void update_timings() override;
 
+    /**
+     * @brief Record the processing history of chunks where the engine misses its
+     *        deadline and append it to a file. Requires timings to be enabled. At most
+     *        MAX_RECORDED_DEADLINE_MISSES misses are written, later ones are only counted.
+     * @param enabled Enabled if true, disable if false
+     * @param filename The file to append deadline misses to
+     */
+    void enable_deadline_miss_recording(bool enabled, const std::string& filename) override;
+
 private:
     enum class Direction : bool
     {
@@ -517,26 +589,86 @@ private:
     */
     EngineReturnStatus _send_control_event(RtEvent& event);
 
+    /**
+     * @brief Send graph editing events to the realtime thread and wait for them to be
+     *        handled, or if this thread has a graph transaction open, add them to the
+     *        transaction.
+     * @param events The events to send
+     * @param rollback Undoes the caller's non-rt bookkeeping for the edit, called if the
+     *        events fail when the transaction is committed
+     * @return true if all events were handled successfully or added to the transaction
+     */
+    bool _send_graph_events(std::initializer_list<RtEvent> events, std::function<void()> rollback = nullptr);
+
+    bool _in_graph_transaction() const
+    {
+        return _graph_transaction_thread.load() == std::this_thread::get_id();
+    }
+
     EngineReturnStatus _connect_audio_channel(int engine_channel, int track_channel, ObjectId track_id, Direction direction);
 
     EngineReturnStatus _disconnect_audio_channel(int engine_channel, int track_channel, ObjectId track_id, Direction direction);
 
     void _process_internal_rt_events();
 
-    void _send_rt_events_to_processors();
+    void _process_control_event(RtEvent& event);
+
+    /**
+     * @brief Create the event that reverts a graph editing event, called from the rt thread
+     *        before the event is applied so that the current state can be recorded
+     * @param event The graph editing event
+     * @return The undo event, or no value if the event can't be reverted
+     */
+    std::optional<RtEvent> _make_graph_undo_event(const RtEvent& event);
+
+    /**
+     * @brief Pass events from the input queue to processors
+     * @param max_events The max number of events to pass on
+     * @return The number of events passed on
+     */
+    int _send_rt_events_to_processors(int max_events);
+
+    /**
+     * @brief Move newly scheduled events to the event scheduler and pass the events that
+     *        are due in the current chunk to processors
+     * @param max_events The max number of events to pass on
+     * @return The number of events passed on
+     */
+    int _send_scheduled_rt_events(int max_events);
 
     void _send_rt_event(const RtEvent& event);
 
     inline void _retrieve_events_from_tracks(ControlBuffer& buffer);
 
+    void _signal_output_events();
+
+    /**
+     * @brief Rebuild the lists of aliased and copied audio connections after a change.
+     *        Tracks with all their channels connected 1:1 to engine channels read and
+     *        write directly from and to the engine's buffers, only fan-in and fan-out
+     *        connections are copied. Called from the rt thread.
+     */
+    void _update_audio_routing();
+
     inline void _copy_audio_to_tracks(ChunkSampleBuffer* input);
 
+    inline void _alias_audio_from_tracks(ChunkSampleBuffer* output, bool enabled);
+
     inline void _copy_audio_from_tracks(ChunkSampleBuffer* output);
 
     void print_timings_to_file(const std::string& filename);
 
+    void print_deadline_misses_to_file(const std::string& filename, const std::vector<performance::DeadlineMiss>& misses);
+
     void _route_cv_gate_ins(ControlBuffer& buffer);
 
+    /**
+     * @brief Move tracks between cpu cores based on their measured processing times,
+     *        if the resulting maximum load per core is significantly lower than the
+     *        current one. Called periodically from a non-rt thread.
+     */
+    void _balance_track_loads();
+
     ProcessorContainer _processors;
 
     // Processors in the realtime part indexed by their unique 32 bit id
@@ -546,6 +678,13 @@ private:
 
     ConnectionStorage<AudioConnection> _audio_in_connections;
     ConnectionStorage<AudioConnection> _audio_out_connections;
+    // Realtime routing derived from the above, only accessed from the rt thread
+    std::atomic_bool                   _audio_routing_changed{false};
+    std::vector<TrackAudioAlias>       _input_aliases;
+    std::vector<TrackAudioAlias>       _output_aliases;
+    std::vector<AudioConnection>       _copied_input_connections;
+    std::vector<AudioConnection>       _copied_output_connections;
+    bool                               _output_aliases_active{false};
     std::vector<CvConnection>    _cv_in_connections;
     std::vector<GateConnection>  _gate_in_connections;
 
@@ -554,11 +693,25 @@ private:
 
     std::atomic<RealtimeState> _state{RealtimeState::STOPPED};
 
-    RtSafeRtEventFifo _control_queue_in;
-    RtSafeRtEventFifo _main_in_queue;
+    RtSafeMpscRtEventFifo _control_queue_in;
+    RtSafeMpscRtEventFifo _main_in_queue;
     RtSafeRtEventFifo _main_out_queue;
+    RtSafeScheduledRtEventFifo _scheduled_in_queue;
+    RtSafeMpscScheduledRtEventFifo _direct_scheduled_in_queue;
+    RtEventScheduler<> _event_scheduler;
     RtSafeRtEventFifo _control_queue_out;
-    std::mutex _in_queue_lock;
+    std::atomic<int> _input_deferrals{0};
+    uint32_t _signaled_events{0};
+    uint32_t _unsignaled_chunks{0};
+    struct GraphTransactionEdit
+    {
+        std::vector<EventId> event_ids;
+        std::function<void()> rollback;
+    };
+    /* The thread with an open graph transaction, only that thread touches the transaction */
+    std::atomic<std::thread::id> _graph_transaction_thread;
+    std::unique_ptr<std::vector<RtEvent>> _graph_transaction;
+    std::vector<GraphTransactionEdit> _graph_transaction_edits;
     receiver::AsynchronousEventReceiver _event_receiver{&_control_queue_out};
     Transport _transport;
 
@@ -567,6 +720,11 @@ private:
 
     performance::PerformanceTimer _process_timer;
     int  _log_timing_print_counter{0};
+    std::string _deadline_miss_file;
+    int  _written_deadline_misses{0};
+    int  _track_balancing_counter{0};
+    // Cpu core assignment of tracks from the last balancing, only accessed from non-rt threads
+    std::map<ObjectId, int> _track_cores;
 
     bool _input_clip_detection_enabled{false};
     bool _output_clip_detection_enabled{false};
@@ -578,6 +736,38 @@ private:
     PluginRegistry _plugin_registry;
 };
 
+/**
+ * @brief Distribute tracks over a number of cpu cores so that the maximum total load
+ *        of any core is minimised. Uses the longest processing time first heuristic.
+ * @param track_loads The processing load of every track, indexed by track id
+ * @param cores The number of cpu cores to distribute the tracks over
+ * @return The assigned core of every track, indexed by track id
+ */
+std::map<ObjectId, int> balance_track_loads(const std::map<ObjectId, float>& track_loads, int cores);
+
+/**
+ * @brief Calculate the total load of the most loaded cpu core for a given assignment
+ * @param track_loads The processing load of every track, indexed by track id
+ * @param track_cores The assigned core of every track, indexed by track id
+ * @param cores The number of cpu cores
+ * @return The total load of the most loaded core
+ */
+float max_core_load(const std::map<ObjectId, float>& track_loads, const std::map<ObjectId, int>& track_cores, int cores);
+
+/**
+ * @brief Check if a track's channels can be mapped directly onto engine channels, i.e.
+ *        if every channel of the track has exactly one connection and these connect
+ *        to a contiguous range of engine channels in the same order.
+ * @param connections All audio connections in one direction
+ * @param first The connection to channel 0 of the track
+ * @param track_channels The number of channels the mapping needs to cover
+ * @param engine_channels The number of engine channels in this direction
+ * @param exclusive If true, the engine channels must not be connected to any other track
+ * @return True if the track's channels can be aliased
+ */
+bool can_alias_track_channels(const std::vector<AudioConnection>& connections, const AudioConnection& first,
+                              int track_channels, int engine_channels, bool exclusive);
+
 /**
  * @brief Helper function to encapsulate state changes from transient states
  * @param current_state The current state of the engine
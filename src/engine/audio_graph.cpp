@@ -19,6 +19,8 @@
  * @copyright 2017-2020 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+
 #include "twine/src/twine_internal.h"
 
 #include "audio_graph.h"
@@ -32,41 +34,43 @@ void external_render_callback(void* data)
     /* Signal that this is a realtime audio processing thread */
     twine::ThreadRtFlag rt_flag;
 
-    auto tracks = reinterpret_cast<std::vector<Track*>*>(data);
-    for (auto i : *tracks)
-    {
-        i->render();
-    }
+    auto worker_data = reinterpret_cast<AudioGraph::WorkerData*>(data);
+    worker_data->instance->_render_core(worker_data->core);
 }
 
 AudioGraph::AudioGraph(int cpu_cores, int max_no_tracks) : _audio_graph(cpu_cores),
+                                                           _graph_nodes(cpu_cores),
+                                                           _node_pool(cpu_cores * max_no_tracks),
                                                            _event_outputs(cpu_cores),
                                                            _cores(cpu_cores),
                                                            _current_core(0)
 {
     assert(cpu_cores > 0);
+    _free_nodes.reserve(_node_pool.size());
+    for (auto& node : _node_pool)
+    {
+        _free_nodes.push_back(&node);
+    }
+    for (int core = 0; core < _cores; ++core)
+    {
+        _audio_graph[core].reserve(max_no_tracks);
+        _graph_nodes[core].reserve(max_no_tracks);
+        _worker_data.push_back({this, core});
+    }
     if (_cores > 1)
     {
         _worker_pool = twine::WorkerPool::create_worker_pool(_cores);
-        for (auto& i : _audio_graph)
+        for (auto& i : _worker_data)
         {
             _worker_pool->add_worker(external_render_callback, &i);
-            i.reserve(max_no_tracks);
         }
     }
-    else
-    {
-        _audio_graph[0].reserve(max_no_tracks);
-    }
 }
 
 bool AudioGraph::add(Track* track)
 {
-    auto& slot = _audio_graph[_current_core];
-    if (slot.size() < slot.capacity())
+    if (add_to_core(track, _current_core))
     {
-        track->set_event_output(&_event_outputs[_current_core]);
-        slot.push_back(track);
         _current_core = (_current_core + 1) % _cores;
         return true;
     }
@@ -77,24 +81,67 @@ bool AudioGraph::add_to_core(Track* track, int core)
 {
     assert(core < _cores);
     auto& slot = _audio_graph[core];
-    if (slot.size() < slot.capacity())
+    if (slot.size() < slot.capacity() && _free_nodes.empty() == false)
     {
+        auto node = _free_nodes.back();
+        _free_nodes.pop_back();
+        node->track = track;
+        node->claimed_cycle.store(0);
         track->set_event_output(&_event_outputs[core]);
         slot.push_back(track);
+        _graph_nodes[core].push_back(node);
+        _track_count++;
         return true;
     }
     return false;
 }
 
+bool AudioGraph::move_to_core(Track* track, int core)
+{
+    assert(core < _cores);
+    for (int old_core = 0; old_core < _cores; ++old_core)
+    {
+        auto& slot = _audio_graph[old_core];
+        for (size_t i = 0; i < slot.size(); ++i)
+        {
+            if (slot[i] == track)
+            {
+                if (old_core == core)
+                {
+                    return true;
+                }
+                if (_audio_graph[core].size() == _audio_graph[core].capacity())
+                {
+                    return false;
+                }
+                auto node = _graph_nodes[old_core][i];
+                slot.erase(slot.begin() + i);
+                _graph_nodes[old_core].erase(_graph_nodes[old_core].begin() + i);
+                track->set_event_output(&_event_outputs[core]);
+                _audio_graph[core].push_back(track);
+                _graph_nodes[core].push_back(node);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 bool AudioGraph::remove(Track* track)
 {
-    for (auto& slot : _audio_graph)
+    for (int core = 0; core < _cores; ++core)
     {
-        for (auto i = slot.begin(); i != slot.end(); ++i)
+        auto& slot = _audio_graph[core];
+        for (size_t i = 0; i < slot.size(); ++i)
         {
-            if (*i == track)
+            if (slot[i] == track)
             {
-                slot.erase(i);
+                auto node = _graph_nodes[core][i];
+                slot.erase(slot.begin() + i);
+                _graph_nodes[core].erase(_graph_nodes[core].begin() + i);
+                node->track = nullptr;
+                _free_nodes.push_back(node);
+                _track_count--;
                 return true;
             }
         }
@@ -102,15 +149,32 @@ bool AudioGraph::remove(Track* track)
     return false;
 }
 
-void AudioGraph::render()
+std::optional<int> AudioGraph::core_of(const Track* track) const
 {
-    if (_cores == 1)
+    for (int core = 0; core < _cores; ++core)
     {
-        for (auto& track : _audio_graph[0])
+        const auto& slot = _audio_graph[core];
+        if (std::find(slot.begin(), slot.end(), track) != slot.end())
         {
-            track->render();
+            return core;
         }
     }
+    return std::nullopt;
+}
+
+void AudioGraph::render()
+{
+    // 0 is reserved for nodes that were never rendered
+    if (++_cycle == 0)
+    {
+        _cycle = 1;
+    }
+    _claimed_count.store(0, std::memory_order_relaxed);
+
+    if (_cores == 1)
+    {
+        _render_core(0);
+    }
     else
     {
         _worker_pool->wakeup_workers();
@@ -118,5 +182,42 @@ void AudioGraph::render()
     }
 }
 
+bool AudioGraph::_try_render(GraphNode* node, int core, unsigned int cycle)
+{
+    auto claimed = node->claimed_cycle.load(std::memory_order_relaxed);
+    if (claimed == cycle)
+    {
+        return false;
+    }
+    if (node->claimed_cycle.compare_exchange_strong(claimed, cycle, std::memory_order_acq_rel) == false)
+    {
+        // Another core got here first
+        return false;
+    }
+    _claimed_count.fetch_add(1, std::memory_order_acq_rel);
+
+    // Events must go to the output of the rendering core as the fifos are not thread safe
+    node->track->set_event_output(&_event_outputs[core]);
+    node->track->render();
+    return true;
+}
+
+void AudioGraph::_render_core(int core)
+{
+    auto cycle = _cycle;
+    while (_claimed_count.load(std::memory_order_acquire) < _track_count)
+    {
+        /* Render tracks assigned to this core first, then steal unstarted tracks
+         * from the other cores */
+        for (int i = 0; i < _cores; ++i)
+        {
+            for (auto node : _graph_nodes[(core + i) % _cores])
+            {
+                _try_render(node, core, cycle);
+            }
+        }
+    }
+}
+
 } // namespace engine
 } // namespace sushi
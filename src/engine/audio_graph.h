@@ -23,10 +23,13 @@
  */
 
 #include <vector>
+#include <atomic>
+#include <optional>
 
 #include "twine/twine.h"
 
 #include "engine/track.h"
+#include "library/spinlock.h"
 
 namespace sushi {
 namespace engine {
@@ -47,7 +50,8 @@ public:
     /**
      * @brief Add a track to the graph. The track will be assigned to a cpu
      *        core on a round robin basis. Must not be called concurrently
-     *        with render()
+     *        with render(). Note that the assigned core is only the preferred
+     *        core of the track, idle cores may steal it during render()
      * @param track the track instance to add
      * @return true if the track was successfully added, false otherwise
      */
@@ -62,6 +66,15 @@ public:
      */
     bool add_to_core(Track* track, int core);
 
+    /**
+     * @brief Move a track that is already in the graph to another cpu core.
+     *        Must not be called concurrently with render()
+     * @param track The track to move
+     * @param core The cpu core that should be used to process the track.
+     * @return true if the track was found and moved, false otherwise
+     */
+    bool move_to_core(Track* track, int core);
+
     /**
      * @brief Remove a track from the audio graph. Must not be called concurrently
      *        with render()
@@ -70,6 +83,22 @@ public:
      */
     bool remove(Track* track);
 
+    /**
+     * @brief Find the cpu core a track is assigned to
+     * @param track The track to look for
+     * @return The core of the track, no value if the track is not in the graph
+     */
+    std::optional<int> core_of(const Track* track) const;
+
+    /**
+     * @brief Return the number of cpu cores used for processing
+     * @return The number of cores
+     */
+    int cores() const
+    {
+        return _cores;
+    }
+
     /**
      * @brief Return the event output buffers for all tracks. Called after render()
      *        to retrieve events passed from tracks.
@@ -83,16 +112,44 @@ public:
     /**
      * @brief Render all tracks. If cpu_cores = 1 all processing is done in the
      *        calling thread. With higher number of cores, the calling thread
-     *        sleeps while processing is running.
+     *        sleeps while processing is running. Each core first renders the
+     *        tracks assigned to it and then steals tracks from other cores
+     *        that are not yet started.
      */
     void render();
 
 private:
-    std::vector<std::vector<Track*>>   _audio_graph;
-    std::unique_ptr<twine::WorkerPool> _worker_pool;
-    std::vector<RtEventFifo<>>         _event_outputs;
+    friend void external_render_callback(void* data);
+
+    struct alignas(ASSUMED_CACHE_LINE_SIZE) GraphNode
+    {
+        Track* track{nullptr};
+        // Set to the current render cycle when the node is claimed for rendering
+        std::atomic<unsigned int> claimed_cycle{0};
+    };
+
+    struct WorkerData
+    {
+        AudioGraph* instance;
+        int core;
+    };
+
+    bool _try_render(GraphNode* node, int core, unsigned int cycle);
+
+    void _render_core(int core);
+
+    std::vector<std::vector<Track*>>     _audio_graph;
+    std::vector<std::vector<GraphNode*>> _graph_nodes;
+    std::vector<GraphNode>               _node_pool;
+    std::vector<GraphNode*>              _free_nodes;
+    std::vector<WorkerData>              _worker_data;
+    std::unique_ptr<twine::WorkerPool>   _worker_pool;
+    std::vector<RtEventFifo<>>           _event_outputs;
     int _cores;
     int _current_core;
+    int _track_count{0};
+    unsigned int _cycle{0};
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<int> _claimed_count{0};
 };
 
 } // namespace engine
@@ -104,6 +104,22 @@ enum class RealtimeState
 
 constexpr int ENGINE_TIMING_ID = -1;
 
+/**
+ * @brief Fill level and overflow statistics of the queues carrying events to and from
+ *        the realtime part of the engine.
+ */
+struct RtEventQueueStatistics
+{
+    int input_capacity{0};
+    int input_high_water_mark{0};
+    int input_overflows{0};
+    /* Number of chunks where events were left in the input queue for the next chunk */
+    int input_deferrals{0};
+    int output_overflows{0};
+    /* Keyboard events dropped by tracks, summed over all tracks */
+    int track_overflows{0};
+};
+
 class BaseEngine
 {
 public:
@@ -275,6 +291,8 @@ public:
 
     virtual EngineReturnStatus send_rt_event(const RtEvent& /*event*/) = 0;
 
+    virtual EngineReturnStatus send_scheduled_rt_event(const RtEvent& /*event*/, Time /*timestamp*/) = 0;
+
     virtual std::pair<EngineReturnStatus, ObjectId> create_track(const std::string & /*track_id*/,
                                                                  int /*channel_count*/)
     {
@@ -317,6 +335,16 @@ public:
         return EngineReturnStatus::OK;
     }
 
+    virtual EngineReturnStatus begin_graph_transaction()
+    {
+        return EngineReturnStatus::OK;
+    }
+
+    virtual EngineReturnStatus commit_graph_transaction()
+    {
+        return EngineReturnStatus::OK;
+    }
+
     virtual dispatcher::BaseEventDispatcher* event_dispatcher()
     {
         return nullptr;
@@ -332,6 +360,16 @@ public:
         return nullptr;
     }
 
+    virtual EngineReturnStatus set_rt_event_queue_capacity(int /*capacity*/)
+    {
+        return EngineReturnStatus::OK;
+    }
+
+    virtual RtEventQueueStatistics rt_event_queue_statistics() const
+    {
+        return {};
+    }
+
     virtual const BaseProcessorContainer* processor_container()
     {
         return nullptr;
@@ -343,6 +381,8 @@ public:
 
     virtual void enable_master_limiter(bool /*enabled*/) {}
 
+    virtual void enable_deadline_miss_recording(bool /*enabled*/, const std::string& /*filename*/) {}
+
     virtual void update_timings() {}
 
 protected:
@@ -51,6 +51,7 @@ public:
     virtual EventDispatcherStatus subscribe_to_keyboard_events(EventPoster* /*receiver*/) {return EventDispatcherStatus::OK;}
     virtual EventDispatcherStatus subscribe_to_parameter_change_notifications(EventPoster* /*receiver*/) { return EventDispatcherStatus::OK;}
     virtual EventDispatcherStatus subscribe_to_engine_notifications(EventPoster* /*receiver*/) {return EventDispatcherStatus::OK;}
+    virtual EventDispatcherStatus set_parameter_notification_interval(EventPoster* /*receiver*/, Time /*interval*/) {return EventDispatcherStatus::OK;}
 
     virtual EventDispatcherStatus deregister_poster(EventPoster* /*poster*/) {return EventDispatcherStatus::OK;}
     virtual EventDispatcherStatus unsubscribe_from_keyboard_events(EventPoster* /*receiver*/) { return EventDispatcherStatus::OK;}
@@ -59,6 +60,12 @@ public:
 
     virtual void set_sample_rate(float /*sample_rate*/) {}
     virtual void set_time(Time /*timestamp*/) {}
+
+    /**
+     * @brief Called from the rt thread after new RtEvents have been queued for the
+     *        dispatcher, to wake it up if it is sleeping. Must be rt safe.
+     */
+    virtual void signal_rt_events() {}
 };
 
 
@@ -252,6 +252,11 @@ void Controller::set_osc_frontend(control_frontend::OSCFrontend* osc_frontend)
     _osc_controller_impl.set_osc_frontend(osc_frontend);
 }
 
+void Controller::set_parameter_notification_interval(Time interval)
+{
+    _event_dispatcher->set_parameter_notification_interval(this, interval);
+}
+
 void Controller::_notify_timing_listeners(const EngineTimingNotificationEvent* event) const
 {
     ext::CpuTimingNotification notification(to_external(event->timings()), event->time());
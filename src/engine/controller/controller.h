@@ -73,6 +73,13 @@ public:
 
     void set_osc_frontend(control_frontend::OSCFrontend* osc_frontend);
 
+    /**
+     * @brief Limit how often parameter change notifications are passed on to listeners.
+     *        Within an interval only the latest value of each parameter is kept.
+     * @param interval The minimum time between notifications, 0 for no limit
+     */
+    void set_parameter_notification_interval(Time interval);
+
 private:
 
     void _completion_callback(Event* event, int status);
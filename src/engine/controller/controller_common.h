@@ -79,7 +79,12 @@ inline ext::CpuTimings to_external(const sushi::performance::ProcessTimings& tim
 {
     return {.avg = timings.avg_case,
             .min = timings.min_case,
-            .max = timings.max_case};
+            .max = timings.max_case,
+            .p50 = timings.p50_case,
+            .p90 = timings.p90_case,
+            .p99 = timings.p99_case,
+            .p999 = timings.p999_case,
+            .overruns = timings.overruns};
 }
 
 inline ext::TimeSignature to_external(sushi::TimeSignature internal)
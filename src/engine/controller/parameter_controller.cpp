@@ -225,6 +225,27 @@ ext::ControlStatus ParameterController::set_parameter_value(int processor_id, in
     return ext::ControlStatus::OK;
 }
 
+ext::ControlStatus ParameterController::set_parameter_values(const std::vector<ext::ParameterValueChange>& changes)
+{
+    SUSHI_LOG_DEBUG("set_parameter_values called with {} changes", changes.size());
+    if (changes.empty())
+    {
+        return ext::ControlStatus::OK;
+    }
+    std::vector<ParameterChangeBatchEvent::ParameterChange> batch;
+    batch.reserve(changes.size());
+    for (const auto& change : changes)
+    {
+        batch.push_back({static_cast<ObjectId>(change.processor_id),
+                         static_cast<ObjectId>(change.parameter_id),
+                         std::clamp<float>(change.value, 0.0f, 1.0f)});
+    }
+    /* All changes are sent as one event and reach the rt thread back to back */
+    auto event = new ParameterChangeBatchEvent(std::move(batch), IMMEDIATE_PROCESS);
+    _event_dispatcher->post_event(event);
+    return ext::ControlStatus::OK;
+}
+
 ext::ControlStatus ParameterController::set_property_value(int processor_id, int property_id, const std::string& value)
 {
     SUSHI_LOG_DEBUG("set_property_value called with processor {}, property {} and value {}", processor_id, property_id, value);
@@ -51,6 +51,8 @@ public:
 
     ext::ControlStatus set_parameter_value(int processor_id, int parameter_id, float value) override;
 
+    ext::ControlStatus set_parameter_values(const std::vector<ext::ParameterValueChange>& changes) override;
+
     std::pair<ext::ControlStatus, std::vector<ext::PropertyInfo>>  get_processor_properties(int processor_id) const override;
 
     std::pair<ext::ControlStatus, std::vector<ext::PropertyInfo>>  get_track_properties(int processor_id) const override;
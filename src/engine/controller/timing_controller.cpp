@@ -33,7 +33,9 @@ TimingController::TimingController(sushi::engine::BaseEngine* engine) : _engine(
 
 inline ext::CpuTimings to_external(sushi::performance::ProcessTimings& internal)
 {
-    return {internal.avg_case, internal.min_case, internal.max_case};
+    return {internal.avg_case, internal.min_case, internal.max_case,
+            internal.p50_case, internal.p90_case, internal.p99_case, internal.p999_case,
+            internal.overruns};
 }
 
 bool TimingController::get_timing_statistics_enabled() const
@@ -87,6 +89,14 @@ ext::ControlStatus TimingController::reset_processor_timings(int processor_id)
     return reset_track_timings(processor_id);
 }
 
+ext::RtEventQueueStatistics TimingController::get_rt_event_queue_statistics() const
+{
+    SUSHI_LOG_DEBUG("get_rt_event_queue_statistics called");
+    auto statistics = _engine->rt_event_queue_statistics();
+    return {statistics.input_capacity, statistics.input_high_water_mark, statistics.input_overflows,
+            statistics.input_deferrals, statistics.output_overflows, statistics.track_overflows};
+}
+
 std::pair<ext::ControlStatus, ext::CpuTimings> TimingController::_get_timings(int node) const
 {
     if (_performance_timer->enabled())
@@ -96,9 +106,9 @@ std::pair<ext::ControlStatus, ext::CpuTimings> TimingController::_get_timings(in
         {
             return {ext::ControlStatus::OK, to_external(timings.value())};
         }
-        return {ext::ControlStatus::NOT_FOUND, {0,0,0}};
+        return {ext::ControlStatus::NOT_FOUND, {0,0,0,0,0,0,0,0}};
     }
-    return {ext::ControlStatus::UNSUPPORTED_OPERATION, {0,0,0}};
+    return {ext::ControlStatus::UNSUPPORTED_OPERATION, {0,0,0,0,0,0,0,0}};
 }
 
 } // namespace controller_impl
@@ -52,6 +52,8 @@ public:
 
     ext::ControlStatus reset_processor_timings(int processor_id) override;
 
+    ext::RtEventQueueStatistics get_rt_event_queue_statistics() const override;
+
 private:
     std::pair<ext::ControlStatus, ext::CpuTimings> _get_timings(int node) const;
 
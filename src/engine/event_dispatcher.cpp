@@ -31,12 +31,14 @@ SUSHI_GET_LOGGER_WITH_MODULE_NAME("event dispatcher");
 
 EventDispatcher::EventDispatcher(engine::BaseEngine* engine,
                                  RtSafeRtEventFifo* in_rt_queue,
-                                 RtSafeRtEventFifo* out_rt_queue) : _running{false},
-                                                                    _engine{engine},
-                                                                    _in_rt_queue{in_rt_queue},
-                                                                    _out_rt_queue{out_rt_queue},
-                                                                    _worker{engine, this},
-                                                                    _event_timer{engine->sample_rate()}
+                                 RtSafeMpscRtEventFifo* out_rt_queue,
+                                 RtSafeScheduledRtEventFifo* scheduled_rt_queue) : _running{false},
+                                                                                   _engine{engine},
+                                                                                   _in_rt_queue{in_rt_queue},
+                                                                                   _out_rt_queue{out_rt_queue},
+                                                                                   _scheduled_rt_queue{scheduled_rt_queue},
+                                                                                   _worker{engine, this},
+                                                                                   _event_timer{engine->sample_rate()}
 {
     std::fill(_posters.begin(), _posters.end(), nullptr);
     register_poster(this);
@@ -46,6 +48,7 @@ EventDispatcher::EventDispatcher(engine::BaseEngine* engine,
 void EventDispatcher::post_event(Event* event)
 {
     _in_queue.push(event);
+    _notifier.notify();
 }
 
 EventDispatcherStatus EventDispatcher::register_poster(EventPoster* poster)
@@ -71,6 +74,7 @@ void EventDispatcher::run()
 void EventDispatcher::stop()
 {
     _running = false;
+    _notifier.notify();
     _worker.stop();
     if (_event_thread.joinable())
     {
@@ -94,14 +98,29 @@ EventDispatcherStatus EventDispatcher::subscribe_to_parameter_change_notificatio
 {
     std::lock_guard<std::mutex> lock(_parameter_listener_lock);
 
-    for (auto r : _parameter_change_listeners)
+    for (auto& listener : _parameter_change_listeners)
     {
-        if (r == receiver) return EventDispatcherStatus::ALREADY_SUBSCRIBED;
+        if (listener.receiver == receiver) return EventDispatcherStatus::ALREADY_SUBSCRIBED;
     }
-    _parameter_change_listeners.push_back(receiver);
+    _parameter_change_listeners.push_back({receiver});
     return EventDispatcherStatus::OK;
 }
 
+EventDispatcherStatus EventDispatcher::set_parameter_notification_interval(EventPoster* receiver, Time interval)
+{
+    std::lock_guard<std::mutex> lock(_parameter_listener_lock);
+
+    for (auto& listener : _parameter_change_listeners)
+    {
+        if (listener.receiver == receiver)
+        {
+            listener.min_interval = interval;
+            return EventDispatcherStatus::OK;
+        }
+    }
+    return EventDispatcherStatus::UNKNOWN_POSTER;
+}
+
 EventDispatcherStatus EventDispatcher::subscribe_to_engine_notifications(EventPoster*receiver)
 {
     std::lock_guard<std::mutex> lock(_engine_listener_lock);
@@ -131,6 +150,36 @@ int EventDispatcher::process(Event* event)
                 return EventStatus::HANDLED_OK;
             }
         }
+        else if (_scheduled_rt_queue && _event_timer.within_horizon(event->time(), RT_SCHEDULING_HORIZON))
+        {
+            /* The engine releases the event at the right sample offset when it is due */
+            if (_scheduled_rt_queue->push({event->time(), event->to_rt_event(0)}))
+            {
+                return EventStatus::HANDLED_OK;
+            }
+        }
+        _waiting_list.push_front(event);
+        return EventStatus::QUEUED_HANDLING;
+    }
+    if (event->is_parameter_change_batch())
+    {
+        auto typed_event = static_cast<ParameterChangeBatchEvent*>(event);
+        auto [send_now, sample_offset] = _event_timer.sample_offset_from_realtime(event->time());
+        if (send_now)
+        {
+            int count = static_cast<int>(typed_event->changes().size());
+            int sent = typed_event->sent_changes();
+            while (sent < count && _out_rt_queue->push(typed_event->change_to_rt_event(sent, sample_offset)))
+            {
+                sent++;
+            }
+            typed_event->set_sent_changes(sent);
+            if (sent == count)
+            {
+                return EventStatus::HANDLED_OK;
+            }
+        }
+        /* Remaining changes are sent when there is room in the queue again */
         _waiting_list.push_front(event);
         return EventStatus::QUEUED_HANDLING;
     }
@@ -151,28 +200,20 @@ void EventDispatcher::_event_loop()
 {
     do
     {
-        auto start_time = std::chrono::system_clock::now();
-
+        /* Events put back on the waiting list are only retried on the next pass, so
+         * the loop can sleep while they are waiting for their timestamp or for room in
+         * the rt queue */
+        std::swap(_waiting_list, _retry_list);
+        while (_retry_list.empty() == false)
+        {
+            Event* event = _retry_list.back();
+            _retry_list.pop_back();
+            _dispatch_event(event);
+        }
         /* Handle incoming Events */
-        while (Event* event = _next_event())
+        while (_in_queue.empty() == false)
         {
-            assert(event->receiver() < static_cast<int>(_posters.size()));
-            EventPoster* receiver = _posters[event->receiver()];
-            int status = EventStatus::UNRECOGNIZED_RECEIVER;
-            if (receiver != nullptr)
-            {
-                status = _posters[event->receiver()]->process(event);
-            }
-            if (status == EventStatus::QUEUED_HANDLING)
-            {
-                /* Event has not finished processing, so dont call comp cb or delete it */
-                continue;
-            }
-            if (event->completion_cb() != nullptr)
-            {
-                event->completion_cb()(event->callback_arg(), event, status);
-            }
-            delete(event);
+            _dispatch_event(_in_queue.pop());
         }
         /* Handle incoming RtEvents */
         while (!_in_rt_queue->empty())
@@ -181,7 +222,14 @@ void EventDispatcher::_event_loop()
             _in_rt_queue->pop(rt_event);
             _process_rt_event(rt_event);
         }
-        std::this_thread::sleep_until(start_time + THREAD_PERIODICITY);
+        _end_engine_notification_batch();
+        /* Rate limited parameter notifications that are due */
+        Time next_delivery = _deliver_pending_parameter_events();
+
+        /* Sleep until woken up by post_event() or the audio thread. Events waiting
+         * for their timestamp need to be polled though */
+        Time timeout = _waiting_list.empty() ? IDLE_WAKEUP_TIMEOUT : THREAD_PERIODICITY;
+        _notifier.wait_for(std::min(timeout, next_delivery));
     }
     while (_running);
 }
@@ -198,6 +246,8 @@ int EventDispatcher::_process_rt_event(RtEvent &rt_event)
             {
                 auto typed_event = rt_event.syncronisation_event();
                 _event_timer.set_outgoing_time(typed_event->timestamp());
+                /* The sync event is the last event sent from each chunk */
+                _end_keyboard_event_batch();
                 return EventStatus::HANDLED_OK;
             }
             default:
@@ -220,24 +270,30 @@ int EventDispatcher::_process_rt_event(RtEvent &rt_event)
     {
         return _worker.process(event);
     }
-    // TODO - better lifetime management of events
+    /* Event memory is recycled through the event pool, so this does not free to the heap */
     delete event;
     return EventStatus::HANDLED_OK;
 }
 
-Event*EventDispatcher::_next_event()
+void EventDispatcher::_dispatch_event(Event* event)
 {
-    Event* event = nullptr;
-    if (!_waiting_list.empty())
+    assert(event->receiver() < static_cast<int>(_posters.size()));
+    EventPoster* receiver = _posters[event->receiver()];
+    int status = EventStatus::UNRECOGNIZED_RECEIVER;
+    if (receiver != nullptr)
     {
-        event = _waiting_list.back();
-        _waiting_list.pop_back();
+        status = receiver->process(event);
     }
-    else if (!_in_queue.empty())
+    if (status == EventStatus::QUEUED_HANDLING)
     {
-        event = _in_queue.pop();
+        /* Event has not finished processing, so dont call comp cb or delete it */
+        return;
     }
-    return event;
+    if (event->completion_cb() != nullptr)
+    {
+        event->completion_cb()(event->callback_arg(), event, status);
+    }
+    delete(event);
 }
 
 void EventDispatcher::_publish_keyboard_events(Event* event)
@@ -250,14 +306,73 @@ void EventDispatcher::_publish_keyboard_events(Event* event)
     }
 }
 
+void EventDispatcher::_end_keyboard_event_batch()
+{
+    std::lock_guard<std::mutex> lock(_keyboard_listener_lock);
+
+    for (auto& listener : _keyboard_event_listeners)
+    {
+        listener->keyboard_event_batch_done();
+    }
+}
+
 void EventDispatcher::_publish_parameter_events(Event* event)
 {
     std::lock_guard<std::mutex> lock(_parameter_listener_lock);
 
+    auto typed_event = static_cast<ParameterChangeNotificationEvent*>(event);
     for (auto& listener : _parameter_change_listeners)
     {
-        listener->process(event);
+        if (listener.min_interval == Time(0))
+        {
+            listener.receiver->process(event);
+            continue;
+        }
+        auto key = (static_cast<uint64_t>(typed_event->processor_id()) << 32) | typed_event->parameter_id();
+        auto pending = listener.pending_index.find(key);
+        if (pending != listener.pending_index.end())
+        {
+            listener.pending[pending->second].value = typed_event->float_value();
+            listener.pending[pending->second].timestamp = typed_event->time();
+        }
+        else
+        {
+            listener.pending_index[key] = listener.pending.size();
+            listener.pending.push_back({typed_event->subtype(), typed_event->processor_id(),
+                                        typed_event->parameter_id(), typed_event->float_value(),
+                                        typed_event->time()});
+        }
+    }
+}
+
+Time EventDispatcher::_deliver_pending_parameter_events()
+{
+    std::lock_guard<std::mutex> lock(_parameter_listener_lock);
+
+    Time now = get_current_time();
+    Time next_delivery = IDLE_WAKEUP_TIMEOUT;
+    for (auto& listener : _parameter_change_listeners)
+    {
+        if (listener.pending.empty())
+        {
+            continue;
+        }
+        Time since_last = now - listener.last_delivery;
+        if (since_last < listener.min_interval)
+        {
+            next_delivery = std::min(next_delivery, listener.min_interval - since_last);
+            continue;
+        }
+        for (const auto& n : listener.pending)
+        {
+            ParameterChangeNotificationEvent event(n.subtype, n.processor_id, n.parameter_id, n.value, n.timestamp);
+            listener.receiver->process(&event);
+        }
+        listener.pending.clear();
+        listener.pending_index.clear();
+        listener.last_delivery = now;
     }
+    return next_delivery;
 }
 
 void EventDispatcher::_publish_engine_notification_events(sushi::Event* event)
@@ -268,6 +383,22 @@ void EventDispatcher::_publish_engine_notification_events(sushi::Event* event)
     {
         listener->process(event);
     }
+    _engine_notifications_published = true;
+}
+
+void EventDispatcher::_end_engine_notification_batch()
+{
+    if (_engine_notifications_published == false)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_engine_listener_lock);
+
+    for (auto& listener : _engine_notification_listeners)
+    {
+        listener->engine_notification_batch_done();
+    }
+    _engine_notifications_published = false;
 }
 
 EventDispatcherStatus EventDispatcher::deregister_poster(EventPoster* poster)
@@ -301,7 +432,7 @@ EventDispatcherStatus EventDispatcher::unsubscribe_from_parameter_change_notific
 
     for (auto i = _parameter_change_listeners.begin(); i != _parameter_change_listeners.end(); ++i)
     {
-        if (*i == receiver)
+        if (i->receiver == receiver)
         {
             _parameter_change_listeners.erase(i);
             return EventDispatcherStatus::OK;
@@ -334,6 +465,7 @@ void Worker::run()
 void Worker::stop()
 {
     _running = false;
+    _notifier.notify();
     if (_worker_thread.joinable())
     {
         _worker_thread.join();
@@ -343,15 +475,15 @@ void Worker::stop()
 int Worker::process(Event*event)
 {
     _queue.push(event);
+    _notifier.notify();
     return EventStatus::QUEUED_HANDLING;
 }
 
 void Worker::_worker()
 {
-    std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> timing_update_counter;
+    auto next_timing_update = std::chrono::system_clock::now() + TIMING_UPDATE_INTERVAL;
     do
     {
-        auto start_time = std::chrono::system_clock::now();
         while (!_queue.empty())
         {
             int status = EventStatus::UNRECOGNIZED_EVENT;
@@ -378,13 +510,14 @@ void Worker::_worker()
             }
             delete (event);
         }
-        if (start_time > timing_update_counter + TIMING_UPDATE_INTERVAL)
+        auto now = std::chrono::system_clock::now();
+        if (now >= next_timing_update)
         {
-            timing_update_counter = start_time;
+            next_timing_update = now + TIMING_UPDATE_INTERVAL;
             _engine->update_timings();
         }
 
-        std::this_thread::sleep_until(start_time + WORKER_THREAD_PERIODICITY);
+        _notifier.wait_for(std::min<std::chrono::nanoseconds>(next_timing_update - now, IDLE_WAKEUP_TIMEOUT));
     }
     while (_running);
 }
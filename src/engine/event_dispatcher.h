@@ -21,15 +21,18 @@
 #ifndef SUSHI_EVENT_DISPATCHER_H
 #define SUSHI_EVENT_DISPATCHER_H
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 #include <thread>
+#include <unordered_map>
 
 #include "engine/base_event_dispatcher.h"
 #include "engine/base_engine.h"
 #include "engine/event_timer.h"
 #include "library/synchronised_fifo.h"
 #include "library/rt_event_fifo.h"
+#include "library/rt_safe_notifier.h"
 #include "library/event_interface.h"
 
 namespace sushi {
@@ -38,9 +41,38 @@ namespace dispatcher {
 
 class BaseEventDispatcher;
 
+/**
+ * @brief A subscriber to parameter change notifications. If min_interval is non-zero,
+ *        notifications are collected and delivered at most once per interval, with only
+ *        the latest value of each parameter kept.
+ */
+struct ParameterChangeListener
+{
+    struct PendingNotification
+    {
+        ParameterChangeNotificationEvent::Subtype subtype;
+        ObjectId processor_id;
+        ObjectId parameter_id;
+        float    value;
+        Time     timestamp;
+    };
+
+    EventPoster*                         receiver;
+    Time                                 min_interval{0};
+    Time                                 last_delivery{0};
+    /* Latest notification of each parameter since the last delivery, in order of arrival */
+    std::vector<PendingNotification>     pending;
+    std::unordered_map<uint64_t, size_t> pending_index;
+};
+
 constexpr int AUDIO_ENGINE_ID = 0;
+/* Polling period used while there are events waiting for their timestamp */
 constexpr std::chrono::milliseconds THREAD_PERIODICITY = std::chrono::milliseconds(1);
-constexpr auto WORKER_THREAD_PERIODICITY = std::chrono::milliseconds(1);
+/* How far ahead of the audio thread timestamped events are handed over to the engine's
+ * event scheduler. Events further ahead are kept in the dispatcher until they get closer */
+constexpr auto RT_SCHEDULING_HORIZON = std::chrono::seconds(1);
+/* Both threads are woken up by new events, this is only an upper bound on the sleep time */
+constexpr auto IDLE_WAKEUP_TIMEOUT = std::chrono::milliseconds(100);
 
 /**
  * @brief Low priority worker for handling possibly time consuming tasks like
@@ -70,12 +102,25 @@ private:
     std::atomic<bool>           _running;
 
     SynchronizedQueue<Event*>   _queue;
+    RtSafeNotifier              _notifier;
 };
 
 class EventDispatcher : public BaseEventDispatcher
 {
 public:
-    EventDispatcher(engine::BaseEngine* engine, RtSafeRtEventFifo* in_rt_queue,  RtSafeRtEventFifo* out_rt_queue);
+    /**
+     * @brief Create an event dispatcher
+     * @param engine The engine to dispatch events to
+     * @param in_rt_queue Queue for events coming from the rt thread
+     * @param out_rt_queue Queue for events to the rt thread
+     * @param scheduled_rt_queue If not null, events timestamped further ahead than the
+     *        next chunk are sent through this queue to the engine's event scheduler
+     *        instead of being held back until they are due
+     */
+    EventDispatcher(engine::BaseEngine* engine,
+                    RtSafeRtEventFifo* in_rt_queue,
+                    RtSafeMpscRtEventFifo* out_rt_queue,
+                    RtSafeScheduledRtEventFifo* scheduled_rt_queue = nullptr);
 
     virtual ~EventDispatcher() = default;
 
@@ -88,6 +133,7 @@ public:
     EventDispatcherStatus subscribe_to_keyboard_events(EventPoster* receiver) override;
     EventDispatcherStatus subscribe_to_parameter_change_notifications(EventPoster* receiver) override;
     EventDispatcherStatus subscribe_to_engine_notifications(EventPoster* receiver) override;
+    EventDispatcherStatus set_parameter_notification_interval(EventPoster* receiver, Time interval) override;
     EventDispatcherStatus deregister_poster(EventPoster* poster) override;
     EventDispatcherStatus unsubscribe_from_keyboard_events(EventPoster* receiver) override;
     EventDispatcherStatus unsubscribe_from_parameter_change_notifications(EventPoster* receiver) override;
@@ -96,6 +142,8 @@ public:
     void set_sample_rate(float sample_rate) override {_event_timer.set_sample_rate(sample_rate);}
     void set_time(Time timestamp) override {_event_timer.set_incoming_time(timestamp);}
 
+    void signal_rt_events() override {_notifier.notify();}
+
     int process(Event* event) override;
     int poster_id() override {return AUDIO_ENGINE_ID;}
 
@@ -104,11 +152,15 @@ private:
 
     int _process_rt_event(RtEvent& rt_event);
 
-    Event* _next_event();
+    void _dispatch_event(Event* event);
 
     void _publish_keyboard_events(Event* event);
+
+    void _end_keyboard_event_batch();
     void _publish_parameter_events(Event* event);
+    Time _deliver_pending_parameter_events();
     void _publish_engine_notification_events(Event* event);
+    void _end_engine_notification_batch();
 
     std::atomic<bool>           _running;
     std::thread                 _event_thread;
@@ -117,20 +169,25 @@ private:
 
     SynchronizedQueue<Event*>   _in_queue;
     RtSafeRtEventFifo*          _in_rt_queue;
-    RtSafeRtEventFifo*          _out_rt_queue;
+    RtSafeMpscRtEventFifo*      _out_rt_queue;
+    RtSafeScheduledRtEventFifo* _scheduled_rt_queue;
     std::deque<Event*>          _waiting_list;
+    std::deque<Event*>          _retry_list;
+    RtSafeNotifier              _notifier;
 
     Worker                      _worker;
     event_timer::EventTimer     _event_timer;
 
     std::array<EventPoster*, EventPosterId::MAX_POSTERS> _posters;
     std::vector<EventPoster*> _keyboard_event_listeners;
-    std::vector<EventPoster*> _parameter_change_listeners;
+    std::vector<ParameterChangeListener> _parameter_change_listeners;
     std::vector<EventPoster*> _engine_notification_listeners;
 
     std::mutex _keyboard_listener_lock;
     std::mutex _parameter_listener_lock;
     std::mutex _engine_listener_lock;
+
+    bool _engine_notifications_published {false};
 };
 
 } // end namespace dispatcher
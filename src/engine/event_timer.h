@@ -46,6 +46,14 @@ public:
      */
     std::pair<bool, int>  sample_offset_from_realtime(Time timestamp);
 
+    /**
+     * @brief Check if a timestamp lies less than a given time ahead of the next chunk
+     * @param timestamp A real time timestamp
+     * @param horizon The maximum time ahead
+     * @return true if the timestamp falls before the next chunk plus horizon
+     */
+    bool within_horizon(Time timestamp, Time horizon) const {return timestamp - _incoming_chunk_time.load() < horizon;}
+
     /**
      * @brief Convert a sample offset to real time.
      * @param offset Offset in samples
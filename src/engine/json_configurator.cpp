@@ -158,6 +158,16 @@ JsonConfigReturnStatus JsonConfigurator::load_host_config()
         SUSHI_LOG_INFO("Enable master limiter set to {}", host_config["master_limiter"].GetBool());
     }
 
+    if (host_config.HasMember("rt_event_queue_size"))
+    {
+        int queue_size = host_config["rt_event_queue_size"].GetInt();
+        SUSHI_LOG_INFO("Setting rt event queue size to {}", queue_size);
+        if (_engine->set_rt_event_queue_capacity(queue_size) != EngineReturnStatus::OK)
+        {
+            SUSHI_LOG_WARNING("Failed to set rt event queue size, the default size is used");
+        }
+    }
+
     return JsonConfigReturnStatus::OK;
 }
 
@@ -31,72 +31,79 @@ namespace midi_dispatcher {
 
 SUSHI_GET_LOGGER_WITH_MODULE_NAME("midi dispatcher");
 
-inline Event* make_note_on_event(const InputConnection& c,
-                                 const midi::NoteOnMessage& msg,
-                                 Time timestamp)
+constexpr int CHANNEL_SLOTS = midi::MidiChannel::OMNI + 1;
+constexpr int CC_SLOTS = midi::MAX_CONTROLLER_NO + 1;
+constexpr uint8_t RELATIVE_CC_START_VALUE = 64;
+constexpr int MIDI_OUTPUT_BATCH_SIZE = 256;
+
+/* Indexes into the flat routing tables */
+inline int channel_slot(int port, int channel)
+{
+    return port * CHANNEL_SLOTS + channel;
+}
+
+inline int cc_slot(int port, int cc_no, int channel)
+{
+    return (port * CC_SLOTS + cc_no) * CHANNEL_SLOTS + channel;
+}
+
+inline RtEvent make_note_on_event(const InputConnection& c,
+                                  const midi::NoteOnMessage& msg)
 {
     if (msg.velocity == 0)
     {
-        return new KeyboardEvent(KeyboardEvent::Subtype::NOTE_OFF, c.target, msg.channel, msg.note, 0.5f, timestamp);
+        return RtEvent::make_note_off_event(c.target, 0, msg.channel, msg.note, 0.5f);
     }
 
     float velocity = msg.velocity / static_cast<float>(midi::MAX_VALUE);
-    return new KeyboardEvent(KeyboardEvent::Subtype::NOTE_ON, c.target, msg.channel, msg.note, velocity, timestamp);
+    return RtEvent::make_note_on_event(c.target, 0, msg.channel, msg.note, velocity);
 }
 
-inline Event* make_note_off_event(const InputConnection& c,
-                                  const midi::NoteOffMessage& msg,
-                                  Time timestamp)
+inline RtEvent make_note_off_event(const InputConnection& c,
+                                   const midi::NoteOffMessage& msg)
 {
     float velocity = msg.velocity / static_cast<float>(midi::MAX_VALUE);
-    return new KeyboardEvent(KeyboardEvent::Subtype::NOTE_OFF, c.target, msg.channel, msg.note, velocity, timestamp);
+    return RtEvent::make_note_off_event(c.target, 0, msg.channel, msg.note, velocity);
 }
 
-inline Event* make_note_aftertouch_event(const InputConnection& c,
-                                         const midi::PolyKeyPressureMessage& msg,
-                                         Time timestamp)
+inline RtEvent make_note_aftertouch_event(const InputConnection& c,
+                                          const midi::PolyKeyPressureMessage& msg)
 {
     float pressure = msg.pressure / static_cast<float>(midi::MAX_VALUE);
-    return new KeyboardEvent(KeyboardEvent::Subtype::NOTE_AFTERTOUCH, c.target, msg.channel, msg.note, pressure, timestamp);
+    return RtEvent::make_note_aftertouch_event(c.target, 0, msg.channel, msg.note, pressure);
 }
 
-inline Event* make_aftertouch_event(const InputConnection& c,
-                                    const midi::ChannelPressureMessage& msg,
-                                    Time timestamp)
+inline RtEvent make_aftertouch_event(const InputConnection& c,
+                                     const midi::ChannelPressureMessage& msg)
 {
     float pressure = msg.pressure / static_cast<float>(midi::MAX_VALUE);
-    return new KeyboardEvent(KeyboardEvent::Subtype::AFTERTOUCH, c.target, msg.channel, pressure, timestamp);
+    return RtEvent::make_aftertouch_event(c.target, 0, msg.channel, pressure);
 }
 
-inline Event* make_modulation_event(const InputConnection& c,
-                                    const midi::ControlChangeMessage& msg,
-                                    Time timestamp)
+inline RtEvent make_modulation_event(const InputConnection& c,
+                                     const midi::ControlChangeMessage& msg)
 {
     float value = msg.value / static_cast<float>(midi::MAX_VALUE);
-    return new KeyboardEvent(KeyboardEvent::Subtype::MODULATION, c.target, msg.channel, value, timestamp);
+    return RtEvent::make_kb_modulation_event(c.target, 0, msg.channel, value);
 }
 
-inline Event* make_pitch_bend_event(const InputConnection& c,
-                                    const midi::PitchBendMessage& msg,
-                                    Time timestamp)
+inline RtEvent make_pitch_bend_event(const InputConnection& c,
+                                     const midi::PitchBendMessage& msg)
 {
     float value = (msg.value / static_cast<float>(midi::PITCH_BEND_MIDDLE)) - 1.0f;
-    return new KeyboardEvent(KeyboardEvent::Subtype::PITCH_BEND, c.target, msg.channel, value, timestamp);
+    return RtEvent::make_pitch_bend_event(c.target, 0, msg.channel, value);
 }
 
-inline Event* make_wrapped_midi_event(const InputConnection& c,
-                                      const uint8_t* data,
-                                      size_t size,
-                                      Time timestamp)
+inline RtEvent make_wrapped_midi_event(const InputConnection& c,
+                                       const uint8_t* data,
+                                       size_t size)
 {
     MidiDataByte midi_data{0};
     std::copy(data, data + size, midi_data.data());
-    return new KeyboardEvent(KeyboardEvent::Subtype::WRAPPED_MIDI, c.target, midi_data, timestamp);
+    return RtEvent::make_wrapped_midi_event(c.target, 0, midi_data);
 }
 
-inline Event* make_param_change_event(InputConnection& c,
-                                      const midi::ControlChangeMessage& msg,
-                                      Time timestamp)
+inline float cc_to_parameter_value(const InputConnection& c, const midi::ControlChangeMessage& msg)
 {
     uint8_t abs_value = msg.value;
     // Maybe TODO: currently this is based on a virtual controller absolute value which is
@@ -104,7 +111,8 @@ inline Event* make_param_change_event(InputConnection& c,
     // and compute a change from that. We should investigate what other DAWs are doing.
     if (c.relative)
     {
-        abs_value = c.virtual_abs_value;
+        /* The routing table is immutable, so the virtual value is kept in separate storage */
+        abs_value = c.relative_value->load(std::memory_order_relaxed);
         if (msg.value < 64u)
         {
             auto clipped_increment = std::min<uint8_t>(msg.value, 127u - abs_value);
@@ -116,10 +124,9 @@ inline Event* make_param_change_event(InputConnection& c,
             auto clipped_decrease = std::min<uint8_t>(128u - msg.value, abs_value);
             abs_value -= clipped_decrease;
         }
-        c.virtual_abs_value = abs_value;
+        c.relative_value->store(abs_value, std::memory_order_relaxed);
     }
-    float value = static_cast<float>(abs_value) / midi::MAX_VALUE * (c.max_range - c.min_range) + c.min_range;
-    return new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE, c.target, c.parameter, value, timestamp);
+    return static_cast<float>(abs_value) / midi::MAX_VALUE * (c.max_range - c.min_range) + c.min_range;
 }
 
 inline Event* make_program_change_event(const InputConnection& c,
@@ -129,9 +136,13 @@ inline Event* make_program_change_event(const InputConnection& c,
     return new ProgramChangeEvent(c.target, msg.program, timestamp);
 }
 
-MidiDispatcher::MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher) : _frontend(nullptr),
-                                                                                    _event_dispatcher(event_dispatcher)
+MidiDispatcher::MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher,
+                               engine::BaseEngine* engine) : _input_routes(std::make_unique<InputRoutingTable>()),
+                                                             _frontend(nullptr),
+                                                             _event_dispatcher(event_dispatcher),
+                                                             _engine(engine)
 {
+    _output_batch.reserve(MIDI_OUTPUT_BATCH_SIZE);
     _event_dispatcher->register_poster(this);
     _event_dispatcher->subscribe_to_keyboard_events(this);
     _event_dispatcher->subscribe_to_engine_notifications(this);
@@ -144,6 +155,13 @@ MidiDispatcher::~MidiDispatcher()
     _event_dispatcher->deregister_poster(this);
 }
 
+void MidiDispatcher::set_midi_inputs(int no_inputs)
+{
+    std::scoped_lock lock(_input_routes_lock);
+    _midi_inputs = no_inputs;
+    _publish_input_routes();
+}
+
 MidiDispatcherStatus MidiDispatcher::connect_cc_to_parameter(int midi_input,
                                                              ObjectId processor_id,
                                                              ObjectId parameter_id,
@@ -164,11 +182,16 @@ MidiDispatcherStatus MidiDispatcher::connect_cc_to_parameter(int midi_input,
     connection.min_range = min_range;
     connection.max_range = max_range;
     connection.relative = use_relative_mode;
-    connection.virtual_abs_value = 64;
+    connection.virtual_abs_value = RELATIVE_CC_START_VALUE;
+    if (use_relative_mode)
+    {
+        connection.relative_value = std::make_shared<std::atomic<uint8_t>>(connection.virtual_abs_value);
+    }
 
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     _cc_routes[midi_input][cc_no][channel].push_back(connection);
+    _publish_input_routes();
     SUSHI_LOG_INFO("Connected parameter ID \"{}\" "
                            "(cc number \"{}\") to processor ID \"{}\"", parameter_id, cc_no, processor_id);
     return MidiDispatcherStatus::OK;
@@ -184,7 +207,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_cc_from_parameter(int midi_input
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     auto connections = _cc_routes.find(midi_input);
     auto& connection_vector = connections->second[cc_no][channel];
@@ -195,6 +218,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_cc_from_parameter(int midi_input
     });
 
     connection_vector.erase(erase_iterator, connection_vector.end());
+    _publish_input_routes();
 
     SUSHI_LOG_INFO("Disconnected "
                    "(cc number \"{}\") from processor ID \"{}\"", cc_no, processor_id);
@@ -203,7 +227,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_cc_from_parameter(int midi_input
 
 MidiDispatcherStatus MidiDispatcher::disconnect_all_cc_from_processor(ObjectId processor_id)
 {
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     for(auto input_i = _cc_routes.begin(); input_i != _cc_routes.end(); ++input_i)
     {
@@ -227,6 +251,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_all_cc_from_processor(ObjectId p
             }
         }
     }
+    _publish_input_routes();
 
     return MidiDispatcherStatus::OK;
 }
@@ -256,9 +281,10 @@ MidiDispatcherStatus MidiDispatcher::connect_pc_to_processor(int midi_input,
     connection.min_range = 0;
     connection.max_range = 0;
 
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     _pc_routes[midi_input][channel].push_back(connection);
+    _publish_input_routes();
     SUSHI_LOG_INFO("Connected program changes from MIDI port \"{}\" to processor id\"{}\"", midi_input, processor_id);
     return MidiDispatcherStatus::OK;
 }
@@ -272,7 +298,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_pc_from_processor(int midi_input
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     auto connections = _pc_routes.find(midi_input);
     auto& connection_vector = connections->second[channel];
@@ -283,6 +309,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_pc_from_processor(int midi_input
                                          });
 
     connection_vector.erase(erase_iterator, connection_vector.end());
+    _publish_input_routes();
 
     SUSHI_LOG_INFO("Disconnected program changes from MIDI port \"{}\" to processor ID \"{}\"", midi_input, processor_id);
     return MidiDispatcherStatus::OK;
@@ -290,7 +317,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_pc_from_processor(int midi_input
 
 MidiDispatcherStatus MidiDispatcher::disconnect_all_pc_from_processor(ObjectId processor_id)
 {
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     for(auto inputs_i = _pc_routes.begin(); inputs_i != _pc_routes.end(); ++inputs_i)
     {
@@ -308,6 +335,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_all_pc_from_processor(ObjectId p
             connection_vector.erase(erase_iterator, connection_vector.end());
         }
     }
+    _publish_input_routes();
     SUSHI_LOG_DEBUG("Disconnected all PC's from processor ID \"{}\"", processor_id);
 
     return MidiDispatcherStatus::OK;
@@ -338,9 +366,10 @@ MidiDispatcherStatus MidiDispatcher::connect_kb_to_track(int midi_input,
     connection.min_range = 0;
     connection.max_range = 0;
 
-    std::scoped_lock lock(_kb_routes_in_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     _kb_routes_in[midi_input][channel].push_back(connection);
+    _publish_input_routes();
     SUSHI_LOG_INFO("Connected MIDI port \"{}\" to track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
 }
@@ -355,7 +384,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_kb_from_track(int midi_input,
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_kb_routes_in_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     auto connections = _kb_routes_in.find(midi_input); // All connections for the midi_input
     auto& connection_vector = connections->second[channel];
@@ -366,6 +395,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_kb_from_track(int midi_input,
                                          });
 
     connection_vector.erase(erase_iterator, connection_vector.end());
+    _publish_input_routes();
 
     SUSHI_LOG_INFO("Disconnected MIDI port \"{}\" from track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
@@ -375,7 +405,7 @@ std::vector<KbdInputConnection> MidiDispatcher::get_all_kb_input_connections()
 {
     std::vector<KbdInputConnection> returns;
 
-    std::scoped_lock lock_in(_kb_routes_in_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     // Adding kbd connections:
     for(auto inputs_i = _kb_routes_in.begin(); inputs_i != _kb_routes_in.end(); ++inputs_i)
@@ -395,8 +425,6 @@ std::vector<KbdInputConnection> MidiDispatcher::get_all_kb_input_connections()
         }
     }
 
-    std::scoped_lock lock_raw(_raw_routes_in_lock);
-
     // Adding Raw midi connections:
     for(auto inputs_i = _raw_routes_in.begin(); inputs_i != _raw_routes_in.end(); ++inputs_i)
     {
@@ -433,9 +461,10 @@ MidiDispatcherStatus MidiDispatcher::connect_raw_midi_to_track(int midi_input,
     connection.min_range = 0;
     connection.max_range = 0;
 
-    std::scoped_lock lock(_raw_routes_in_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     _raw_routes_in[midi_input][channel].push_back(connection);
+    _publish_input_routes();
     SUSHI_LOG_INFO("Connected MIDI port \"{}\" to track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
 }
@@ -449,7 +478,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_raw_midi_from_track(int midi_inp
         return MidiDispatcherStatus::INVALID_MIDI_INPUT;
     }
 
-    std::scoped_lock lock(_raw_routes_in_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     auto connections = _raw_routes_in.find(midi_input); // All connections for the midi_input
     auto& connection_vector = connections->second[channel];
@@ -460,6 +489,7 @@ MidiDispatcherStatus MidiDispatcher::disconnect_raw_midi_from_track(int midi_inp
                                          });
 
     connection_vector.erase(erase_iterator, connection_vector.end());
+    _publish_input_routes();
 
     SUSHI_LOG_INFO("Disconnected MIDI port \"{}\" from track ID \"{}\"", midi_input, track_id);
     return MidiDispatcherStatus::OK;
@@ -545,27 +575,23 @@ std::vector<KbdOutputConnection> MidiDispatcher::get_all_kb_output_connections()
 
 void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
 {
+    auto routes = _input_routes.read();
+    if (port < 0 || port >= routes->inputs)
+    {
+        return;
+    }
     const int channel = midi::decode_channel(data);
     const int size = data.size();
+
     /* Dispatch raw midi messages */
+    for (const auto& c : routes->raw_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
     {
-        std::scoped_lock lock(_raw_routes_in_lock);
-
-        const auto& cons = _raw_routes_in.find(port);
-        if (cons != _raw_routes_in.end())
-        {
-            for (auto c : cons->second[midi::MidiChannel::OMNI])
-            {
-                _event_dispatcher->post_event(make_wrapped_midi_event(c, data.data(), size, timestamp));
-            }
-            for (auto c : cons->second[channel])
-            {
-                _event_dispatcher->post_event(make_wrapped_midi_event(c, data.data(), size, timestamp));
-            }
-        }
+        _send_keyboard_event(make_wrapped_midi_event(c, data.data(), size), timestamp);
+    }
+    for (const auto& c : routes->raw_routes.connections(channel_slot(port, channel)))
+    {
+        _send_keyboard_event(make_wrapped_midi_event(c, data.data(), size), timestamp);
     }
-
-    std::scoped_lock lock(_kb_routes_in_lock);
 
     /* Dispatch decoded midi messages */
     midi::MessageType type = midi::decode_message_type(data);
@@ -574,34 +600,23 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::CONTROL_CHANGE:
         {
             midi::ControlChangeMessage decoded_msg = midi::decode_control_change(data);
-
-            std::scoped_lock lock(_cc_routes_lock);
-
-            const auto& cons = _cc_routes.find(port);
-            if (cons != _cc_routes.end())
+            for (int cc_channel : {static_cast<int>(midi::MidiChannel::OMNI), static_cast<int>(decoded_msg.channel)})
             {
-                for (auto& c : cons->second[decoded_msg.controller][midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_param_change_event(c, decoded_msg, timestamp));
-                }
-                for (auto& c : cons->second[decoded_msg.controller][decoded_msg.channel])
+                int slot = cc_slot(port, decoded_msg.controller, cc_channel);
+                for (const auto& c : routes->cc_routes.connections(slot))
                 {
-                    _event_dispatcher->post_event(make_param_change_event(c, decoded_msg, timestamp));
+                    _send_parameter_change(c, cc_to_parameter_value(c, decoded_msg), timestamp);
                 }
             }
             if (decoded_msg.controller == midi::MOD_WHEEL_CONTROLLER_NO)
             {
-                const auto& cons = _kb_routes_in.find(port);
-                if (cons != _kb_routes_in.end())
+                for (const auto& c : routes->kb_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
                 {
-                    for (auto c : cons->second[midi::MidiChannel::OMNI])
-                    {
-                        _event_dispatcher->post_event(make_modulation_event(c, decoded_msg, timestamp));
-                    }
-                    for (auto c : cons->second[decoded_msg.channel])
-                    {
-                        _event_dispatcher->post_event(make_modulation_event(c, decoded_msg, timestamp));
-                    }
+                    _send_keyboard_event(make_modulation_event(c, decoded_msg), timestamp);
+                }
+                for (const auto& c : routes->kb_routes.connections(channel_slot(port, decoded_msg.channel)))
+                {
+                    _send_keyboard_event(make_modulation_event(c, decoded_msg), timestamp);
                 }
             }
             break;
@@ -610,17 +625,13 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::NOTE_ON:
         {
             midi::NoteOnMessage decoded_msg = midi::decode_note_on(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_note_on_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event(make_note_on_event(c, decoded_msg, timestamp));
-                }
+                _send_keyboard_event(make_note_on_event(c, decoded_msg), timestamp);
+            }
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, decoded_msg.channel)))
+            {
+                _send_keyboard_event(make_note_on_event(c, decoded_msg), timestamp);
             }
             break;
         }
@@ -628,17 +639,13 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::NOTE_OFF:
         {
             midi::NoteOffMessage decoded_msg = midi::decode_note_off(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_note_off_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event(make_note_off_event(c, decoded_msg, timestamp));
-                }
+                _send_keyboard_event(make_note_off_event(c, decoded_msg), timestamp);
+            }
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, decoded_msg.channel)))
+            {
+                _send_keyboard_event(make_note_off_event(c, decoded_msg), timestamp);
             }
             break;
         }
@@ -646,17 +653,13 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::PITCH_BEND:
         {
             midi::PitchBendMessage decoded_msg = midi::decode_pitch_bend(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_pitch_bend_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event(make_pitch_bend_event(c, decoded_msg, timestamp));
-                }
+                _send_keyboard_event(make_pitch_bend_event(c, decoded_msg), timestamp);
+            }
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, decoded_msg.channel)))
+            {
+                _send_keyboard_event(make_pitch_bend_event(c, decoded_msg), timestamp);
             }
             break;
         }
@@ -664,17 +667,13 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::POLY_KEY_PRESSURE:
         {
             midi::PolyKeyPressureMessage decoded_msg = midi::decode_poly_key_pressure(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_note_aftertouch_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event(make_note_aftertouch_event(c, decoded_msg, timestamp));
-                }
+                _send_keyboard_event(make_note_aftertouch_event(c, decoded_msg), timestamp);
+            }
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, decoded_msg.channel)))
+            {
+                _send_keyboard_event(make_note_aftertouch_event(c, decoded_msg), timestamp);
             }
             break;
         }
@@ -682,17 +681,13 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::CHANNEL_PRESSURE:
         {
             midi::ChannelPressureMessage decoded_msg = midi::decode_channel_pressure(data);
-            const auto& cons = _kb_routes_in.find(port);
-            if (cons != _kb_routes_in.end())
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_aftertouch_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event( make_aftertouch_event(c, decoded_msg, timestamp));
-                }
+                _send_keyboard_event(make_aftertouch_event(c, decoded_msg), timestamp);
+            }
+            for (const auto& c : routes->kb_routes.connections(channel_slot(port, decoded_msg.channel)))
+            {
+                _send_keyboard_event(make_aftertouch_event(c, decoded_msg), timestamp);
             }
             break;
         }
@@ -700,19 +695,13 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
         case midi::MessageType::PROGRAM_CHANGE:
         {
             midi::ProgramChangeMessage decoded_msg = midi::decode_program_change(data);
-
-            std::scoped_lock lock(_pc_routes_lock);
-            const auto& cons = _pc_routes.find(port);
-            if (cons != _pc_routes.end())
+            for (const auto& c : routes->pc_routes.connections(channel_slot(port, midi::MidiChannel::OMNI)))
             {
-                for (auto c : cons->second[midi::MidiChannel::OMNI])
-                {
-                    _event_dispatcher->post_event(make_program_change_event(c, decoded_msg, timestamp));
-                }
-                for (auto c : cons->second[decoded_msg.channel])
-                {
-                    _event_dispatcher->post_event(make_program_change_event(c, decoded_msg, timestamp));
-                }
+                _event_dispatcher->post_event(make_program_change_event(c, decoded_msg, timestamp));
+            }
+            for (const auto& c : routes->pc_routes.connections(channel_slot(port, decoded_msg.channel)))
+            {
+                _event_dispatcher->post_event(make_program_change_event(c, decoded_msg, timestamp));
             }
             break;
         }
@@ -722,6 +711,29 @@ void MidiDispatcher::send_midi(int port, MidiDataByte data, Time timestamp)
     }
 }
 
+void MidiDispatcher::_send_keyboard_event(const RtEvent& event, Time timestamp)
+{
+    /* Keyboard events don't need any processing outside the rt thread, so when possible
+     * they are sent straight to the engine instead of going through the event dispatcher */
+    if (_engine && _engine->send_scheduled_rt_event(event, timestamp) == engine::EngineReturnStatus::OK)
+    {
+        return;
+    }
+    _event_dispatcher->post_event(Event::from_rt_event(event, timestamp));
+}
+
+void MidiDispatcher::_send_parameter_change(const InputConnection& connection, float value, Time timestamp)
+{
+    /* Takes the same path as keyboard events so that they stay in order */
+    auto event = RtEvent::make_parameter_change_event(connection.target, 0, connection.parameter, value);
+    if (_engine && _engine->send_scheduled_rt_event(event, timestamp) == engine::EngineReturnStatus::OK)
+    {
+        return;
+    }
+    _event_dispatcher->post_event(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                                           connection.target, connection.parameter, value, timestamp));
+}
+
 int MidiDispatcher::process(Event* event)
 {
     if (event->is_keyboard_event())
@@ -759,7 +771,7 @@ int MidiDispatcher::process(Event* event)
                 }
                 SUSHI_LOG_DEBUG("Dispatching midi [{:x} {:x} {:x} {:x}], timestamp: {}",
                                 midi_data[0], midi_data[1], midi_data[2], midi_data[3], event->time().count());
-                _frontend->send_midi(c.output, midi_data, event->time());
+                _output_batch.push_back({c.output, midi_data, event->time()});
             }
         }
         return EventStatus::HANDLED_OK;
@@ -772,11 +784,20 @@ int MidiDispatcher::process(Event* event)
     return EventStatus::NOT_HANDLED;
 }
 
+void MidiDispatcher::keyboard_event_batch_done()
+{
+    if (_output_batch.empty() == false)
+    {
+        _frontend->send_midi_batch(_output_batch);
+        _output_batch.clear();
+    }
+}
+
 std::vector<CCInputConnection> MidiDispatcher::_get_cc_input_connections(std::optional<int> processor_id_filter)
 {
     std::vector<CCInputConnection> returns;
 
-    std::scoped_lock lock(_cc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     for(auto input_i = _cc_routes.begin(); input_i != _cc_routes.end(); ++input_i)
     {
@@ -811,7 +832,7 @@ std::vector<PCInputConnection> MidiDispatcher::_get_pc_input_connections(std::op
 {
     std::vector<PCInputConnection> returns;
 
-    std::scoped_lock lock(_pc_routes_lock);
+    std::scoped_lock lock(_input_routes_lock);
 
     for(auto inputs_i = _pc_routes.begin(); inputs_i != _pc_routes.end(); ++inputs_i)
     {
@@ -836,6 +857,38 @@ std::vector<PCInputConnection> MidiDispatcher::_get_pc_input_connections(std::op
     return returns;
 }
 
+void MidiDispatcher::_publish_input_routes()
+{
+    static const std::vector<InputConnection> NO_CONNECTIONS;
+    auto add_channel_slots = [&](ConnectionTable& table, const auto& routes, int port)
+    {
+        auto port_routes = routes.find(port);
+        for (int channel = 0; channel < CHANNEL_SLOTS; ++channel)
+        {
+            table.add_slot(port_routes != routes.end() ? port_routes->second[channel] : NO_CONNECTIONS);
+        }
+    };
+
+    auto table = std::make_unique<InputRoutingTable>();
+    table->inputs = _midi_inputs;
+    for (int port = 0; port < _midi_inputs; ++port)
+    {
+        add_channel_slots(table->kb_routes, _kb_routes_in, port);
+        add_channel_slots(table->raw_routes, _raw_routes_in, port);
+        add_channel_slots(table->pc_routes, _pc_routes, port);
+
+        auto cc_routes = _cc_routes.find(port);
+        for (int cc_no = 0; cc_no < CC_SLOTS; ++cc_no)
+        {
+            for (int channel = 0; channel < CHANNEL_SLOTS; ++channel)
+            {
+                table->cc_routes.add_slot(cc_routes != _cc_routes.end() ? cc_routes->second[cc_no][channel] : NO_CONNECTIONS);
+            }
+        }
+    }
+    _input_routes.update(std::move(table));
+}
+
 bool MidiDispatcher::_handle_audio_graph_notification(const EngineNotificationEvent* event)
 {
     if (event->is_audio_graph_notification())
@@ -26,6 +26,8 @@
 #include <array>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <memory>
 
 #include "library/constants.h"
 #include "library/types.h"
@@ -34,10 +36,12 @@
 #include "library/processor.h"
 #include "control_frontends/base_midi_frontend.h"
 #include "library/event_interface.h"
+#include "library/rcu_pointer.h"
 
 namespace sushi {
 namespace engine {
 class BaseProcessorContainer;
+class BaseEngine;
 }
 
 namespace midi_dispatcher {
@@ -53,6 +57,10 @@ struct InputConnection
     float max_range;
     bool relative;
     uint8_t virtual_abs_value;
+    /* Current virtual value of a cc connection in relative mode, starting from
+     * virtual_abs_value. Kept outside the connection so it can be updated through
+     * an immutable routing table, each connection has its own. */
+    std::shared_ptr<std::atomic<uint8_t>> relative_value{nullptr};
 };
 
 struct OutputConnection
@@ -64,6 +72,65 @@ struct OutputConnection
     float max_range;
 };
 
+/**
+ * @brief Contiguous storage of a number of lists of connections, each identified by a
+ *        slot index, i.e. a compressed sparse row layout.
+ */
+class ConnectionTable
+{
+public:
+    struct Range
+    {
+        const InputConnection* first;
+        const InputConnection* last;
+
+        const InputConnection* begin() const {return first;}
+        const InputConnection* end() const {return last;}
+    };
+
+    /**
+     * @brief Append the connections for the next slot. Slots must be added in index order.
+     * @param connections The connections of the slot
+     */
+    void add_slot(const std::vector<InputConnection>& connections)
+    {
+        _connections.insert(_connections.end(), connections.begin(), connections.end());
+        _offsets.push_back(static_cast<int>(_connections.size()));
+    }
+
+    /**
+     * @brief Get the connections of a slot
+     * @param slot Index of the slot
+     * @return A range of connections, empty if the slot has not been added
+     */
+    Range connections(int slot) const
+    {
+        if (slot < 0 || slot >= static_cast<int>(_offsets.size()) - 1)
+        {
+            return {nullptr, nullptr};
+        }
+        return {_connections.data() + _offsets[slot], _connections.data() + _offsets[slot + 1]};
+    }
+
+private:
+    std::vector<InputConnection> _connections;
+    std::vector<int>             _offsets{0};
+};
+
+/**
+ * @brief Immutable snapshot of all midi input connections with dense indexing by port,
+ *        channel and controller number. Rebuilt and swapped in as a whole when connections
+ *        change, so incoming midi can be routed without taking any locks.
+ */
+struct InputRoutingTable
+{
+    int inputs{0};
+    ConnectionTable kb_routes;
+    ConnectionTable raw_routes;
+    ConnectionTable pc_routes;
+    ConnectionTable cc_routes;
+};
+
 enum class MidiDispatcherStatus
 {
     OK,
@@ -111,7 +178,19 @@ class MidiDispatcher : public EventPoster, public midi_receiver::MidiReceiver
     SUSHI_DECLARE_NON_COPYABLE(MidiDispatcher);
 
 public:
-    MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher);
+    /**
+     * @brief Create a MidiDispatcher
+     * @param event_dispatcher Dispatcher for events that need non-rt processing
+     * @param engine If not null, keyboard, raw midi and cc to parameter events are sent
+     *        directly to the realtime part of the engine, bypassing the event dispatcher
+     *        for lower latency. These events all take the same path, so events from one
+     *        midi input reach the rt thread in the order they were received. Program
+     *        changes are executed by the non-rt worker thread and are not ordered with
+     *        respect to them, a note following a program change may be played with the
+     *        previous program. If the engine's queue is full, events fall back to the
+     *        event dispatcher and may be delayed.
+     */
+    MidiDispatcher(dispatcher::BaseEventDispatcher* event_dispatcher, engine::BaseEngine* engine = nullptr);
 
     virtual ~MidiDispatcher();
 
@@ -125,10 +204,7 @@ public:
      * Not intended to be called dynamically, only once during creation.
      * @param ports number of input ports.
      */
-    void set_midi_inputs(int no_inputs)
-    {
-        _midi_inputs = no_inputs;
-    }
+    void set_midi_inputs(int no_inputs);
 
     /**
      * @brief Returns the number of midi input ports.
@@ -350,12 +426,24 @@ public:
      */
     int poster_id() override {return EventPosterId::MIDI_DISPATCHER;}
 
+    /**
+     * @brief Send all midi output collected since the last batch to the frontend
+     */
+    void keyboard_event_batch_done() override;
+
 private:
     bool _handle_audio_graph_notification(const EngineNotificationEvent* typed_event);
 
+    void _send_keyboard_event(const RtEvent& event, Time timestamp);
+
+    void _send_parameter_change(const InputConnection& connection, float value, Time timestamp);
+
     std::vector<CCInputConnection> _get_cc_input_connections(std::optional<int> processor_id_filter);
     std::vector<PCInputConnection> _get_pc_input_connections(std::optional<int> processor_id_filter);
 
+    /* Must be called with _input_routes_lock held */
+    void _publish_input_routes();
+
     std::map<int, std::array<std::vector<InputConnection>, midi::MidiChannel::OMNI + 1>> _kb_routes_in;
     std::map<ObjectId, std::vector<OutputConnection>>  _kb_routes_out;
     std::map<int, std::array<std::array<std::vector<InputConnection>, midi::MidiChannel::OMNI + 1>, midi::MAX_CONTROLLER_NO + 1>> _cc_routes;
@@ -364,14 +452,17 @@ private:
     int _midi_inputs{0};
     int _midi_outputs{0};
 
-    std::mutex _kb_routes_in_lock;
+    /* Protects the input route maps above, the read path uses _input_routes only */
+    std::mutex _input_routes_lock;
     std::mutex _kb_routes_out_lock;
-    std::mutex _cc_routes_lock;
-    std::mutex _pc_routes_lock;
-    std::mutex _raw_routes_in_lock;
+    RcuPointer<InputRoutingTable> _input_routes;
+
+    /* Only accessed from the event dispatcher thread */
+    std::vector<midi_frontend::MidiOutputMessage> _output_batch;
 
     midi_frontend::BaseMidiFrontend* _frontend;
     dispatcher::BaseEventDispatcher* _event_dispatcher;
+    engine::BaseEngine*              _engine;
 };
 
 } // end namespace midi_dispatcher
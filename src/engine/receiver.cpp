@@ -18,47 +18,119 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
-#include <thread>
+#include <algorithm>
 
 #include "engine/receiver.h"
 
 namespace sushi {
 namespace receiver {
 
-constexpr int MAX_RETRIES = 100;
+bool AsynchronousEventReceiver::wait_for_response(EventId id, std::chrono::milliseconds timeout, bool discard_on_timeout)
+{
+    return wait_for_responses({id}, timeout, discard_on_timeout);
+}
 
-bool AsynchronousEventReceiver::wait_for_response(EventId id, std::chrono::milliseconds timeout)
+bool AsynchronousEventReceiver::wait_for_responses(const std::vector<EventId>& ids,
+                                                   std::chrono::milliseconds timeout,
+                                                   bool discard_on_timeout)
 {
-    int retries = 0;
-    while (retries < MAX_RETRIES)
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto find_response = [&](EventId id)
+    {
+        return std::find_if(_receive_list.begin(), _receive_list.end(), [&](const Node& n) {return n.id == id;});
+    };
+    while (true)
     {
-        RtEvent event;
-        while (_queue->pop(event))
+        _receive_events();
+        /* Responses are only consumed once all have arrived, so that none are lost on a timeout */
+        if (std::all_of(ids.begin(), ids.end(), [&](EventId id) {return find_response(id) != _receive_list.end();}))
         {
-            if (event.type() >= RtEventType::STOP_ENGINE)
+            bool all_ok = true;
+            for (auto id : ids)
             {
-                auto typed_event = event.returnable_event();
-                if (typed_event->event_id() == id)
+                auto response = find_response(id);
+                if (response != _receive_list.end())
                 {
-                    return (typed_event->status() == ReturnableRtEvent::EventStatus::HANDLED_OK);
+                    all_ok &= response->status;
+                    _receive_list.erase(response);
                 }
-                bool status = (typed_event->status() == ReturnableRtEvent::EventStatus::HANDLED_OK);
-                _receive_list.push_back(Node{typed_event->event_id(), status});
             }
+            return all_ok;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            if (discard_on_timeout)
+            {
+                discard_responses(ids);
+            }
+            return false;
+        }
+        /* Woken up by the rt thread as soon as it has returned events */
+        _notifier.wait_for(deadline - now);
+    }
+}
+
+void AsynchronousEventReceiver::discard_responses(const std::vector<EventId>& ids)
+{
+    _receive_events();
+    for (auto id : ids)
+    {
+        auto response = std::find_if(_receive_list.begin(), _receive_list.end(), [&](const Node& n) {return n.id == id;});
+        if (response != _receive_list.end())
+        {
+            _receive_list.erase(response);
+        }
+        else
+        {
+            _discarded_ids.push_back(id);
         }
-        for (auto i = _receive_list.begin(); i != _receive_list.end(); ++i)
+    }
+}
+
+bool AsynchronousEventReceiver::has_response(EventId id)
+{
+    _receive_events();
+    return std::any_of(_receive_list.begin(), _receive_list.end(), [&](const Node& n) {return n.id == id;});
+}
+
+void AsynchronousEventReceiver::_receive_events()
+{
+    RtEvent event;
+    while (_queue->pop(event))
+    {
+        if (event.type() == RtEventType::GRAPH_TRANSACTION)
         {
-            if (i->id == id)
+            /* The events of a transaction are returned as if sent individually, the
+             * transaction owns them and is only deleted once back from the rt thread */
+            auto transaction = event.graph_transaction_event();
+            for (auto& graph_event : *transaction->events())
             {
-                bool status = i->status;
-                _receive_list.erase(i);
-                return status;
+                auto typed_event = graph_event.returnable_event();
+                bool status = (typed_event->status() == ReturnableRtEvent::EventStatus::HANDLED_OK);
+                _add_response(typed_event->event_id(), status);
             }
+            transaction->delete_events();
         }
-        std::this_thread::sleep_for(timeout / MAX_RETRIES);
-        retries++;
+        if (event.type() >= RtEventType::STOP_ENGINE)
+        {
+            auto typed_event = event.returnable_event();
+            bool status = (typed_event->status() == ReturnableRtEvent::EventStatus::HANDLED_OK);
+            _add_response(typed_event->event_id(), status);
+        }
+    }
+}
+
+void AsynchronousEventReceiver::_add_response(EventId id, bool status)
+{
+    auto discarded = std::find(_discarded_ids.begin(), _discarded_ids.end(), id);
+    if (discarded != _discarded_ids.end())
+    {
+        _discarded_ids.erase(discarded);
+        return;
     }
-    return false;
+    _receive_list.push_back(Node{id, status});
 }
+
 } // end namespace receiver
 } // end namespace sushi
@@ -26,6 +26,7 @@
 
 #include "library/id_generator.h"
 #include "library/rt_event_fifo.h"
+#include "library/rt_safe_notifier.h"
 
 namespace sushi {
 namespace receiver {
@@ -35,22 +36,68 @@ class AsynchronousEventReceiver
 public:
     AsynchronousEventReceiver(RtSafeRtEventFifo* queue) : _queue{queue} {}
 
+    /**
+     * @brief Wake up a thread waiting for responses. Should be called from the rt thread
+     *        after events have been returned to the queue. Rt safe.
+     */
+    void notify() {_notifier.notify();}
+
     /**
      * @brief Blocks the current thread while waiting for a response to a given event
      * @param id EventId of the event the thread is waiting for
      * @param timeout Maximum wait time
+     * @param discard_on_timeout If true, the response is discarded if it doesn't arrive in time
      * @return true if the event was received in time and handled properly, false otherwise
      */
-    bool wait_for_response(EventId id, std::chrono::milliseconds timeout);
+    bool wait_for_response(EventId id, std::chrono::milliseconds timeout, bool discard_on_timeout = false);
+
+    /**
+     * @brief Blocks the current thread while waiting for responses to several events,
+     *        so that a number of events can be sent to the rt thread and awaited together.
+     *        On a timeout no responses are consumed, so they can still be waited for,
+     *        unless discard_on_timeout is set.
+     * @param ids EventIds of the events the thread is waiting for
+     * @param timeout Maximum wait time for all events
+     * @param discard_on_timeout If true, the responses are discarded if they don't all
+     *        arrive in time, see discard_responses()
+     * @return true if all events were received in time and handled properly, false otherwise
+     */
+    bool wait_for_responses(const std::vector<EventId>& ids,
+                            std::chrono::milliseconds timeout,
+                            bool discard_on_timeout = false);
+
+    /**
+     * @brief Stop waiting for the responses to a number of events. Responses already
+     *        received are removed and responses that arrive later are dropped, so they
+     *        don't accumulate. Must only be called with events whose responses have not
+     *        been consumed, or a later event reusing the same id could be dropped.
+     * @param ids EventIds of the events
+     */
+    void discard_responses(const std::vector<EventId>& ids);
+
+    /**
+     * @brief Check if the response to an event has been received, without consuming it
+     * @param id EventId of the event
+     * @return true if the response has been received
+     */
+    bool has_response(EventId id);
 
 private:
+    /* Move all returned events from the queue to the receive list */
+    void _receive_events();
+
+    void _add_response(EventId id, bool status);
+
     struct Node
     {
         EventId id;
         bool    status;
     };
     std::vector<Node> _receive_list;
+    /* Events given up on, whose responses are dropped when they arrive */
+    std::vector<EventId> _discarded_ids;
     RtSafeRtEventFifo* _queue;
+    RtSafeNotifier     _notifier;
 };
 
 
@@ -155,17 +155,33 @@ bool Track::remove(ObjectId processor)
     return false;
 }
 
+std::optional<ObjectId> Track::next_processor(ObjectId processor) const
+{
+    for (auto i = _processors.begin(); i != _processors.end(); ++i)
+    {
+        if ((*i)->id() == processor && i + 1 != _processors.end())
+        {
+            return (*(i + 1))->id();
+        }
+    }
+    return std::nullopt;
+}
+
 void Track::render()
 {
     auto track_timestamp = _timer->start_timer();
 
-    process_audio(_input_buffer, _output_buffer);
+    auto& output = _output_aliased ? _output_alias : _output_buffer;
+    process_audio(_input_buffer, output);
     for (int bus = 0; bus < _output_busses; ++bus)
     {
-        auto buffer = ChunkSampleBuffer::create_non_owning_buffer(_output_buffer, bus * 2, 2);
+        auto buffer = ChunkSampleBuffer::create_non_owning_buffer(output, bus * 2, 2);
         _apply_pan_and_gain(buffer, bus);
     }
-    _input_buffer.clear();
+    if (_input_aliased == false)
+    {
+        _input_buffer.clear();
+    }
 
     _timer->stop_timer_rt_safe(track_timestamp, this->id());
 }
@@ -173,11 +189,11 @@ void Track::render()
 void Track::process_audio(const ChunkSampleBuffer& /*in*/, ChunkSampleBuffer& out)
 {
     /* For Tracks, process function is called from render() and the input audio data
-     * should be copied to _input_buffer prior to this call.
+     * should be copied to _input_buffer, or an input alias set, prior to this call.
      * We alias the buffers so we can swap them cheaply, without copying the underlying
      * data, though we can't alias in since it is const, even though it points to
      * _input_buffer  */
-    ChunkSampleBuffer aliased_in = ChunkSampleBuffer::create_non_owning_buffer(_input_buffer);
+    ChunkSampleBuffer aliased_in = ChunkSampleBuffer::create_non_owning_buffer(_input_aliased ? _input_alias : _input_buffer);
     ChunkSampleBuffer aliased_out = ChunkSampleBuffer::create_non_owning_buffer(out);
 
     for (auto &processor : _processors)
@@ -195,6 +211,11 @@ void Track::process_audio(const ChunkSampleBuffer& /*in*/, ChunkSampleBuffer& ou
         ChunkSampleBuffer proc_out = ChunkSampleBuffer::create_non_owning_buffer(aliased_out, 0, processor->output_channels());
         processor->process_audio(proc_in, proc_out);
         std::swap(aliased_in, aliased_out);
+        if (_input_aliased && aliased_out.channel(0) == _input_alias.channel(0))
+        {
+            /* Never write to an external input buffer, use the internal one instead */
+            aliased_out = ChunkSampleBuffer::create_non_owning_buffer(_input_buffer);
+        }
         _timer->stop_timer_rt_safe(processor_timestamp, processor->id());
     }
 
@@ -202,10 +223,10 @@ void Track::process_audio(const ChunkSampleBuffer& /*in*/, ChunkSampleBuffer& ou
 
     if (output_channels > 0)
     {
-        /* aliased_out contains the output of the last processor
-         * If the number of processors is even, then aliased_out
+        /* aliased_in contains the output of the last processor
+         * If the number of processors is even, then aliased_in
          * already points to out, otherwise we need to copy to it */
-        if (aliased_in.channel(0) == _input_buffer.channel(0))
+        if (aliased_in.channel(0) != out.channel(0))
         {
             out.replace(aliased_in);
         }
@@ -219,6 +240,35 @@ void Track::process_audio(const ChunkSampleBuffer& /*in*/, ChunkSampleBuffer& ou
     _process_output_events();
 }
 
+void Track::set_input_alias(ChunkSampleBuffer& buffer, int start_channel)
+{
+    _input_alias = ChunkSampleBuffer::create_non_owning_buffer(buffer, start_channel, _input_buffer.channel_count());
+    _input_aliased = true;
+}
+
+void Track::clear_input_alias()
+{
+    if (_input_aliased)
+    {
+        _input_alias = ChunkSampleBuffer();
+        _input_aliased = false;
+        /* The internal buffer was used as scratch space while aliased */
+        _input_buffer.clear();
+    }
+}
+
+void Track::set_output_alias(ChunkSampleBuffer& buffer, int start_channel)
+{
+    _output_alias = ChunkSampleBuffer::create_non_owning_buffer(buffer, start_channel, _output_buffer.channel_count());
+    _output_aliased = true;
+}
+
+void Track::clear_output_alias()
+{
+    _output_alias = ChunkSampleBuffer();
+    _output_aliased = false;
+}
+
 void Track::process_event(const RtEvent& event)
 {
     if (is_keyboard_event(event))
@@ -85,6 +85,14 @@ public:
      */
     bool remove(ObjectId processor);
 
+    /**
+     * @brief Return the processor following a processor in the track's processing chain
+     * @param processor The ObjectId of the processor
+     * @return The ObjectId of the next processor, no value if processor is the last one
+     *         or not found on the track
+     */
+    std::optional<ObjectId> next_processor(ObjectId processor) const;
+
     /**
      * @brief Return a SampleBuffer to an input bus
      * @param bus The index of the bus, must not be greater than the number of busses configured
@@ -104,7 +112,7 @@ public:
     ChunkSampleBuffer output_bus(int bus)
     {
         assert(bus < _output_busses);
-        return ChunkSampleBuffer::create_non_owning_buffer(_output_buffer, bus * 2, 2);
+        return ChunkSampleBuffer::create_non_owning_buffer(_output_aliased ? _output_alias : _output_buffer, bus * 2, 2);
     }
 
     /**
@@ -126,7 +134,56 @@ public:
     ChunkSampleBuffer output_channel(int index)
     {
         assert(index < _max_output_channels);
-        return ChunkSampleBuffer::create_non_owning_buffer(_output_buffer, index, 1);
+        return ChunkSampleBuffer::create_non_owning_buffer(_output_aliased ? _output_alias : _output_buffer, index, 1);
+    }
+
+    /**
+     * @brief Let the track read its input audio directly from a range of channels in an
+     *        external buffer instead of from its internal input buffer, avoiding a copy.
+     *        The external buffer is only read from. Should be called from the audio
+     *        thread before every call to render(), as the external buffer may change.
+     * @param buffer The buffer to read from
+     * @param start_channel The channel in buffer to map to the first input channel
+     *        of the track, the range must cover input_buffer_channels() channels
+     */
+    void set_input_alias(ChunkSampleBuffer& buffer, int start_channel);
+
+    /**
+     * @brief Go back to reading input audio from the internal input buffer
+     */
+    void clear_input_alias();
+
+    /**
+     * @brief Let the track render its output audio directly into a range of channels
+     *        in an external buffer instead of into its internal output buffer.
+     *        Should be called from the audio thread before every call to render().
+     * @param buffer The buffer to write to
+     * @param start_channel The channel in buffer to map to the first output channel
+     *        of the track, the range must cover output_buffer_channels() channels
+     */
+    void set_output_alias(ChunkSampleBuffer& buffer, int start_channel);
+
+    /**
+     * @brief Go back to rendering output audio into the internal output buffer
+     */
+    void clear_output_alias();
+
+    /**
+     * @brief Return the number of channels in the track's internal input buffer,
+     *        which is also the number of channels an input alias must cover
+     */
+    int input_buffer_channels() const
+    {
+        return _input_buffer.channel_count();
+    }
+
+    /**
+     * @brief Return the number of channels in the track's internal output buffer,
+     *        which is also the number of channels an output alias must cover
+     */
+    int output_buffer_channels() const
+    {
+        return _output_buffer.channel_count();
     }
 
     /**
@@ -162,6 +219,12 @@ public:
         reinterpret_cast<Track*>(arg)->render();
     }
 
+    /**
+     * @brief The number of keyboard events dropped because the track's event buffer was
+     *        full. Safe to call from a non-rt thread.
+     */
+    int dropped_keyboard_events() const {return _kb_event_buffer.overflows();}
+
     /* Inherited from Processor */
     void process_event(const RtEvent& event) override;
 
@@ -194,6 +257,12 @@ private:
     ChunkSampleBuffer _input_buffer;
     ChunkSampleBuffer _output_buffer;
 
+    /* Non-owning buffers pointing directly into the engine's audio buffers */
+    ChunkSampleBuffer _input_alias;
+    ChunkSampleBuffer _output_alias;
+    bool _input_aliased{false};
+    bool _output_aliased{false};
+
     int _input_busses;
     int _output_busses;
     bool _multibus;
@@ -26,6 +26,10 @@
 namespace sushi {
 namespace performance {
 
+/**
+ * @brief Timing statistics for a node. All timings are expressed as fractions of
+ *        the timing period. Percentiles and overruns are counted since the last reset.
+ */
 struct ProcessTimings
 {
     ProcessTimings() : avg_case{0.0f}, min_case{100.0f}, max_case{0.0f} {}
@@ -33,6 +37,11 @@ struct ProcessTimings
     float avg_case{1};
     float min_case{1};
     float max_case{0};
+    float p50_case{0};
+    float p90_case{0};
+    float p99_case{0};
+    float p999_case{0};
+    int overruns{0};    // Number of timings longer than the period
 };
 
 class BasePerformanceTimer
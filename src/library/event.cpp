@@ -19,6 +19,7 @@
  */
 
 #include "library/event.h"
+#include "library/event_pool.h"
 #include "engine/base_engine.h"
 #include "logging.h"
 
@@ -29,6 +30,23 @@ SUSHI_GET_LOGGER_WITH_MODULE_NAME("event");
 
 namespace sushi {
 
+/* Never destroyed, as events may outlive other static objects on exit */
+EventPool& event_pool()
+{
+    static auto pool = new EventPool();
+    return *pool;
+}
+
+void* Event::operator new(std::size_t size)
+{
+    return event_pool().allocate(size);
+}
+
+void Event::operator delete(void* ptr, std::size_t size)
+{
+    event_pool().deallocate(ptr, size);
+}
+
 Event* Event::from_rt_event(const RtEvent& rt_event, Time timestamp)
 {
     switch (rt_event.type())
@@ -219,6 +237,12 @@ RtEvent ParameterChangeEvent::to_rt_event(int sample_offset) const
     }
 }
 
+RtEvent ParameterChangeBatchEvent::change_to_rt_event(int index, int sample_offset) const
+{
+    const auto& change = _changes[index];
+    return RtEvent::make_parameter_change_event(change.processor_id, sample_offset, change.parameter_id, change.value);
+}
+
 RtEvent SetProcessorBypassEvent::to_rt_event(int /*sample_offset*/) const
 {
     return RtEvent::make_bypass_processor_event(this->processor_id(), this->bypass_enabled());
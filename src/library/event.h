@@ -22,6 +22,7 @@
 #define SUSHI_CONTROL_EVENT_H
 
 #include <string>
+#include <vector>
 
 #include "types.h"
 #include "id_generator.h"
@@ -75,6 +76,15 @@ public:
      */
     static Event* from_rt_event(const RtEvent& rt_event, Time timestamp);
 
+    /**
+     * @brief Events, including all derived classes, are allocated from a pool of
+     *        recycled memory blocks so that creating and deleting events does not
+     *        hit the heap in the steady state.
+     */
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* ptr, std::size_t size);
+
     Time        time() const {return _timestamp;}
     int         receiver() const {return _receiver;}
     EventId     id() const {return _id;}
@@ -103,6 +113,9 @@ public:
     /* Event is directly convertible to an RtEvent */
     virtual bool maps_to_rt_event() const {return false;}
 
+    /* Convertible to ParameterChangeBatchEvent, maps to a sequence of RtEvents */
+    virtual bool is_parameter_change_batch() const {return false;}
+
     /* Return the RtEvent counterpart of the Event */
     virtual RtEvent to_rt_event(int /*sample_offset*/) const {return RtEvent();}
 
@@ -246,6 +259,41 @@ protected:
     float               _value;
 };
 
+/**
+ * @brief A batch of float parameter changes that are sent to the rt thread together,
+ *        avoiding the overhead of creating and dispatching one event per change.
+ */
+class ParameterChangeBatchEvent : public Event
+{
+public:
+    struct ParameterChange
+    {
+        ObjectId processor_id;
+        ObjectId parameter_id;
+        float    value;
+    };
+
+    ParameterChangeBatchEvent(std::vector<ParameterChange> changes,
+                              Time timestamp) : Event(timestamp),
+                                                _changes(std::move(changes)) {}
+
+    bool is_parameter_change_batch() const override {return true;}
+
+    const std::vector<ParameterChange>& changes() const {return _changes;}
+
+    /* Number of changes that have already been passed on to the rt thread */
+    int sent_changes() const {return _sent_changes;}
+
+    void set_sent_changes(int count) {_sent_changes = count;}
+
+    /* Return the RtEvent counterpart of the change at index */
+    RtEvent change_to_rt_event(int index, int sample_offset) const;
+
+private:
+    std::vector<ParameterChange> _changes;
+    int                          _sent_changes{0};
+};
+
 class DataPropertyEvent : public Event
 {
 public:
@@ -49,6 +49,20 @@ public:
      */
     virtual int process(Event* /*event*/) {return EventStatus::UNRECOGNIZED_EVENT;};
 
+    /**
+     * @brief Called by the event dispatcher on posters subscribed to keyboard events when
+     *        all keyboard events from an audio chunk have been passed to process(), so
+     *        they can be handled as a batch.
+     */
+    virtual void keyboard_event_batch_done() {}
+
+    /**
+     * @brief Called by the event dispatcher on posters subscribed to engine notifications
+     *        when all notifications received in one pass of its event loop have been
+     *        passed to process(), so they can be handled as a batch.
+     */
+    virtual void engine_notification_batch_done() {}
+
     /**
      * @brief The unique id of this poster.
      * @return
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Memory pool for recycling the memory of Events
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_EVENT_POOL_H
+#define SUSHI_EVENT_POOL_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace sushi {
+
+/* Block sizes are multiples of this, larger objects fall back to the heap */
+constexpr size_t EVENT_POOL_BLOCK_GRANULARITY = 64;
+constexpr int    EVENT_POOL_SIZE_CLASSES = 4;
+constexpr size_t EVENT_POOL_MAX_BLOCK_SIZE = EVENT_POOL_BLOCK_GRANULARITY * EVENT_POOL_SIZE_CLASSES;
+/* Number of blocks allocated at a time when a size class runs out of free blocks */
+constexpr int    EVENT_POOL_BLOCKS_PER_SLAB = 128;
+
+/**
+ * @brief Thread safe pool of fixed size memory blocks. Freed blocks are kept in an
+ *        intrusive free list per size class and reused for the next allocation of the
+ *        same size class, so once the pool has grown to cover the peak number of live
+ *        objects no more heap allocations are made. Memory is never returned to the heap.
+ */
+class EventPool
+{
+public:
+    EventPool() = default;
+
+    ~EventPool() = default;
+
+    /**
+     * @brief Allocate a block of memory
+     * @param size The size of the block in bytes
+     * @return A pointer to a memory block of at least size bytes
+     */
+    void* allocate(size_t size)
+    {
+        if (size > EVENT_POOL_MAX_BLOCK_SIZE)
+        {
+            return ::operator new(size);
+        }
+        auto& size_class = _size_classes[_size_class_index(size)];
+        std::scoped_lock lock(size_class.lock);
+        if (size_class.free_list == nullptr)
+        {
+            _add_slab(size_class, _block_size(size));
+        }
+        FreeBlock* block = size_class.free_list;
+        size_class.free_list = block->next;
+        size_class.free_blocks--;
+        return block;
+    }
+
+    /**
+     * @brief Return a block of memory to the pool
+     * @param ptr A block returned by allocate()
+     * @param size The size that was passed to allocate()
+     */
+    void deallocate(void* ptr, size_t size)
+    {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+        if (size > EVENT_POOL_MAX_BLOCK_SIZE)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+        auto& size_class = _size_classes[_size_class_index(size)];
+        std::scoped_lock lock(size_class.lock);
+        auto block = static_cast<FreeBlock*>(ptr);
+        block->next = size_class.free_list;
+        size_class.free_list = block;
+        size_class.free_blocks++;
+    }
+
+    /**
+     * @brief Return the total number of blocks held by the pool, both used and free
+     */
+    int capacity()
+    {
+        int blocks = 0;
+        for (auto& size_class : _size_classes)
+        {
+            std::scoped_lock lock(size_class.lock);
+            blocks += static_cast<int>(size_class.slabs.size()) * EVENT_POOL_BLOCKS_PER_SLAB;
+        }
+        return blocks;
+    }
+
+    /**
+     * @brief Return the number of blocks currently not in use
+     */
+    int free_blocks()
+    {
+        int blocks = 0;
+        for (auto& size_class : _size_classes)
+        {
+            std::scoped_lock lock(size_class.lock);
+            blocks += size_class.free_blocks;
+        }
+        return blocks;
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct SizeClass
+    {
+        std::mutex lock;
+        FreeBlock* free_list{nullptr};
+        int free_blocks{0};
+        std::vector<std::unique_ptr<std::byte[]>> slabs;
+    };
+
+    static int _size_class_index(size_t size)
+    {
+        return size == 0 ? 0 : static_cast<int>((size - 1) / EVENT_POOL_BLOCK_GRANULARITY);
+    }
+
+    static size_t _block_size(size_t size)
+    {
+        return (_size_class_index(size) + 1) * EVENT_POOL_BLOCK_GRANULARITY;
+    }
+
+    static void _add_slab(SizeClass& size_class, size_t block_size)
+    {
+        /* new[] of std::byte is aligned to __STDCPP_DEFAULT_NEW_ALIGNMENT__ and
+         * the block size is a multiple of it, so every block is suitably aligned */
+        static_assert(EVENT_POOL_BLOCK_GRANULARITY % __STDCPP_DEFAULT_NEW_ALIGNMENT__ == 0);
+        auto& slab = size_class.slabs.emplace_back(new std::byte[block_size * EVENT_POOL_BLOCKS_PER_SLAB]);
+        for (int i = EVENT_POOL_BLOCKS_PER_SLAB - 1; i >= 0; --i)
+        {
+            auto block = reinterpret_cast<FreeBlock*>(slab.get() + i * block_size);
+            block->next = size_class.free_list;
+            size_class.free_list = block;
+        }
+        size_class.free_blocks += EVENT_POOL_BLOCKS_PER_SLAB;
+    }
+
+    std::array<SizeClass, EVENT_POOL_SIZE_CLASSES> _size_classes;
+};
+
+/**
+ * @brief Access the pool used for allocating all Events
+ */
+EventPool& event_pool();
+
+} // end namespace sushi
+
+#endif //SUSHI_EVENT_POOL_H
@@ -58,6 +58,11 @@ constexpr uint8_t OMNI_ON_CTRL      = 125;
 constexpr uint8_t MONO_MODE_CTRL    = 126;
 constexpr uint8_t POLY_MODE_CTRL    = 127;
 
+constexpr uint8_t STATUS_BIT        = 0x80u;
+constexpr uint8_t SYSEX_STATUS      = 0xF0u;
+constexpr uint8_t SYSTEM_STATUS     = 0xF0u;
+constexpr uint8_t REALTIME_STATUS   = 0xF8u;
+
 constexpr uint8_t STRIP_MSG_BIT     = 0x7Fu;
 constexpr uint8_t STRIP_4_MSG_BITS  = 0x0Fu;
 constexpr uint8_t STRIP_4_LSG_BITS  = 0xF7u;
@@ -303,5 +308,102 @@ SongSelectMessage decode_song_select(MidiDataByte data)
     return message;
 }
 
+int decode_message_size(uint8_t status)
+{
+    if (status >= REALTIME_STATUS)
+    {
+        return 1;
+    }
+    switch (status >> 4u)
+    {
+        case NOTE_OFF_PREFIX:
+        case NOTE_ON_PREFIX:
+        case POLY_PRES_PREFIX:
+        case CTRL_CH_PREFIX:
+        case PITCH_B_PREFIX:
+            return 3;
+
+        case PROG_CH_PREFIX:
+        case CHAN_PRES_PREFIX:
+            return 2;
+
+        default:
+            break;
+    }
+    switch (status & STRIP_4_MSG_BITS)
+    {
+        case TIME_CODE:
+        case SONG_SEL_CODE:
+            return 2;
+
+        case SONG_POS_CODE:
+            return 3;
+
+        case TUNE_REQ_CODE:
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+bool MidiStreamParser::parse(uint8_t byte)
+{
+    if (byte >= REALTIME_STATUS)
+    {
+        /* Real time messages can appear anywhere, also in the middle of other
+         * messages, and don't affect the running status */
+        _message = {byte, 0, 0, 0};
+        _message_size = 1;
+        return true;
+    }
+    if (byte & STATUS_BIT)
+    {
+        _count = 0;
+        _expected_size = decode_message_size(byte);
+        _in_sysex = byte == SYSEX_STATUS;
+        if (_expected_size == 0)
+        {
+            return false;
+        }
+        _buffer[_count++] = byte;
+    }
+    else if (_in_sysex || _expected_size == 0)
+    {
+        /* Sysex data, or data without a preceding status byte */
+        return false;
+    }
+    else
+    {
+        _buffer[_count++] = byte;
+    }
+
+    if (_count < _expected_size)
+    {
+        return false;
+    }
+    _message = to_midi_data_byte(_buffer, _count);
+    _message_size = _count;
+    if (_buffer[0] < SYSTEM_STATUS)
+    {
+        /* Keep the status byte so that following data bytes can use running status */
+        _count = 1;
+    }
+    else
+    {
+        /* System common messages cancel running status */
+        _count = 0;
+        _expected_size = 0;
+    }
+    return true;
+}
+
+void MidiStreamParser::reset()
+{
+    _count = 0;
+    _expected_size = 0;
+    _in_sysex = false;
+}
+
 } // end namspace midi
 } // end namespace sushi
\ No newline at end of file
@@ -278,6 +278,55 @@ SongPositionMessage decode_song_position(MidiDataByte data);
  */
 SongSelectMessage decode_song_select(MidiDataByte data);
 
+/**
+ * @brief Get the total size of a midi message from its status byte.
+ * @param status  The status byte of the message.
+ * @return The message size in bytes, including the status byte. 0 for system
+ *         exclusive messages and undefined status bytes.
+ */
+int decode_message_size(uint8_t status);
+
+/**
+ * @brief Assembles complete midi messages from a raw midi byte stream, i.e. as read
+ *        from a rawmidi device or a serial port. Handles running status and system
+ *        real time messages interleaved with other messages. System exclusive
+ *        messages are not handled and are skipped over.
+ */
+class MidiStreamParser
+{
+public:
+    /**
+     * @brief Feed the next byte from the stream to the parser
+     * @param byte The midi byte
+     * @return true if the byte completed a message, which can then be read with
+     *         message() and message_size() until parse() is called again
+     */
+    bool parse(uint8_t byte);
+
+    /**
+     * @brief The last completed message
+     */
+    MidiDataByte message() const {return _message;}
+
+    /**
+     * @brief Number of bytes in the last completed message
+     */
+    int message_size() const {return _message_size;}
+
+    /**
+     * @brief Discard any partially received message and the running status
+     */
+    void reset();
+
+private:
+    MidiDataByte _message{0};
+    int          _message_size{0};
+    uint8_t      _buffer[3]{0};
+    int          _count{0};
+    int          _expected_size{0};
+    bool         _in_sysex{false};
+};
+
 
 } // end namespace midi
 } // end namespace sushi
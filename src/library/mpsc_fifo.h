@@ -0,0 +1,160 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Bounded, lock free fifo queue for multiple producers and a single consumer.
+ *        Based on Dmitry Vyukov's bounded MPMC queue, where each slot carries a
+ *        sequence number that tells producers and the consumer whether it is free
+ *        or holds data. Producers only contend on a single atomic index and never
+ *        wait for each other or the consumer. Elements are popped in the order their
+ *        slots were claimed though, so a producer pre-empted between claiming a slot
+ *        and writing it holds back all later elements until it is scheduled again.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_MPSC_FIFO_H
+#define SUSHI_MPSC_FIFO_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "library/spinlock.h"
+
+namespace sushi {
+
+template<typename T>
+class MpscFifo
+{
+public:
+    /**
+     * @brief Create a queue
+     * @param capacity Number of elements to store, rounded up to the nearest power of 2
+     */
+    explicit MpscFifo(size_t capacity)
+    {
+        resize(capacity);
+    }
+
+    /**
+     * @brief Reallocate the queue with a new capacity, any elements in it are discarded.
+     *        Not thread safe, must not be called while the queue is in use.
+     * @param capacity Number of elements to store, rounded up to the nearest power of 2
+     */
+    void resize(size_t capacity)
+    {
+        size_t storage_capacity = 1;
+        while (storage_capacity < capacity)
+        {
+            storage_capacity <<= 1;
+        }
+        _cells = std::make_unique<Cell[]>(storage_capacity);
+        for (size_t i = 0; i < storage_capacity; ++i)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        _capacity = storage_capacity;
+        _tail.store(0);
+        _head = 0;
+    }
+
+    /**
+     * @brief Push an element to the queue, can be called concurrently from any number of threads
+     * @param element The element to push
+     * @return true if successful, false if the queue was full
+     */
+    bool push(const T& element)
+    {
+        size_t pos = _tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &_cells[pos & (_capacity - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Fifo is full
+            }
+            else
+            {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = element;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop an element from the queue, must only be called from one thread
+     * @param element Will be assigned the popped element
+     * @return true if successful, false if the queue was empty or if the oldest
+     *         claimed slot has not been written yet by its producer
+     */
+    bool pop(T& element)
+    {
+        Cell* cell = &_cells[_head & (_capacity - 1)];
+        if (cell->sequence.load(std::memory_order_acquire) != _head + 1)
+        {
+            return false; // Fifo is empty, or the next element is not completely written yet
+        }
+        element = cell->data;
+        cell->sequence.store(_head + _capacity, std::memory_order_release);
+        ++_head;
+        return true;
+    }
+
+    /**
+     * @brief Check if the queue is empty, only meaningful when called from the consumer thread
+     */
+    bool empty() const
+    {
+        return _cells[_head & (_capacity - 1)].sequence.load(std::memory_order_acquire) != _head + 1;
+    }
+
+    /**
+     * @brief The number of elements in the queue, including those that producers are in
+     *        the middle of pushing. Only meaningful when called from the consumer thread.
+     */
+    size_t size() const {return _tail.load(std::memory_order_relaxed) - _head;}
+
+    size_t capacity() const {return _capacity;}
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T                   data;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t                  _capacity{0};
+    /* Avoids false sharing between producers and the consumer */
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<size_t> _tail{0};
+    alignas(ASSUMED_CACHE_LINE_SIZE) size_t              _head{0};
+};
+
+} // namespace sushi
+
+#endif //SUSHI_MPSC_FIFO_H
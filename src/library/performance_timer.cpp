@@ -18,6 +18,8 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "performance_timer.h"
@@ -32,6 +34,85 @@ constexpr auto EVALUATION_INTERVAL = std::chrono::seconds(1);
 constexpr double SEC_TO_NANOSEC = 1'000'000'000.0;
 constexpr float AVERAGING_FACTOR = 0.5f;
 
+/* Unique for every timer instance, so that thread local queue assignments
+ * from a previous timer instance are never reused */
+std::atomic<unsigned int> instance_counter{0};
+
+constexpr int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+
+TimingHistogram::TimingHistogram()
+{
+    clear();
+}
+
+void TimingHistogram::add(int64_t value)
+{
+    _buckets[_bucket_index(value)]++;
+    _count++;
+}
+
+int64_t TimingHistogram::percentile(float percentile) const
+{
+    if (_count == 0)
+    {
+        return 0;
+    }
+    auto target = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0f, 1.0f) * _count));
+    target = std::max(target, uint64_t(1));
+    uint64_t accumulated = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+        accumulated += _buckets[i];
+        if (accumulated >= target)
+        {
+            return _bucket_value(i);
+        }
+    }
+    return _bucket_value(HISTOGRAM_BUCKETS - 1);
+}
+
+void TimingHistogram::clear()
+{
+    _buckets.fill(0);
+    _count = 0;
+}
+
+int TimingHistogram::_bucket_index(int64_t value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS)
+    {
+        return static_cast<int>(std::max(value, int64_t(0)));
+    }
+    /* Values are bucketed linearly with HISTOGRAM_SUB_BUCKETS buckets between
+     * every power of 2, keeping the most significant bits of the value */
+    int msb = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+    int shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+    int sub_bucket = static_cast<int>(value >> shift) - HISTOGRAM_SUB_BUCKETS;
+    int index = HISTOGRAM_SUB_BUCKETS + shift * HISTOGRAM_SUB_BUCKETS + sub_bucket;
+    return std::min(index, HISTOGRAM_BUCKETS - 1);
+}
+
+int64_t TimingHistogram::_bucket_value(int index)
+{
+    if (index < HISTOGRAM_SUB_BUCKETS)
+    {
+        return index;
+    }
+    int shift = (index - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_SUB_BUCKETS;
+    int64_t sub_bucket = HISTOGRAM_SUB_BUCKETS + (index - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+    /* Return the middle of the bucket */
+    return (sub_bucket << shift) + ((int64_t(1) << shift) >> 1);
+}
+
+PerformanceTimer::PerformanceTimer(int max_threads) : _instance_id(++instance_counter)
+{
+    _thread_slots.reserve(max_threads);
+    for (int i = 0; i < max_threads; ++i)
+    {
+        _thread_slots.push_back(std::make_shared<ThreadSlot>());
+    }
+}
+
 PerformanceTimer::~PerformanceTimer()
 {
     if (_enabled.load() == true)
@@ -98,18 +179,45 @@ void PerformanceTimer::_worker()
 void PerformanceTimer::_update_timings()
 {
     std::map<int, std::vector<TimingLogPoint>> sorted_data;
+    std::vector<TimingLogPoint> flight_data;
+    bool record_flight_data = _flight_recorder_periods > 0;
     TimingLogPoint log_point;
     while (_entry_queue.pop(log_point))
     {
         sorted_data[log_point.id].push_back(log_point);
+        if (record_flight_data)
+        {
+            flight_data.push_back(log_point);
+        }
+    }
+    for (auto& slot : _thread_slots)
+    {
+        while (slot->queue.pop(log_point))
+        {
+            sorted_data[log_point.id].push_back(log_point);
+            if (record_flight_data)
+            {
+                flight_data.push_back(log_point);
+            }
+        }
+    }
+    if (_slots_exhausted.load(std::memory_order_relaxed) && _slots_exhausted_logged == false)
+    {
+        SUSHI_LOG_WARNING("More than {} threads logging timings, timings from some threads are lost", _thread_slots.size());
+        _slots_exhausted_logged = true;
+    }
+    if (record_flight_data)
+    {
+        _record_flight_data(flight_data);
     }
     for (const auto& node : sorted_data)
     {
         int id = node.first;
         std::lock_guard<std::mutex> lock(_timing_lock);
-        const auto& timings = _timings[id];
+        auto& timing_node = _timings[id];
         auto new_timings = _calculate_timings(node.second);
-        _timings[id].timings = _merge_timings(timings.timings, new_timings);
+        timing_node.timings = _merge_timings(timing_node.timings, new_timings);
+        _update_percentiles(timing_node, node.second);
     }
 }
 
@@ -118,14 +226,18 @@ ProcessTimings PerformanceTimer::_calculate_timings(const std::vector<TimingLogP
     float min_value{100};
     float max_value{0};
     float sum{0.0f};
+    int overruns{0};
     for (const auto& entry : entries)
     {
         float process_time = static_cast<float>(entry.delta_time.count()) / _period;
         sum += process_time;
         min_value = std::min(min_value, process_time);
         max_value = std::max(max_value, process_time);
+        overruns += process_time > 1.0f ? 1 : 0;
     }
-    return {sum / entries.size(), min_value, max_value};
+    ProcessTimings timings(sum / entries.size(), min_value, max_value);
+    timings.overruns = overruns;
+    return timings;
 }
 
 ProcessTimings PerformanceTimer::_merge_timings(ProcessTimings prev_timings, ProcessTimings new_timings)
@@ -140,9 +252,81 @@ ProcessTimings PerformanceTimer::_merge_timings(ProcessTimings prev_timings, Pro
     }
     prev_timings.min_case = std::min(prev_timings.min_case, new_timings.min_case);
     prev_timings.max_case = std::max(prev_timings.max_case, new_timings.max_case);
+    prev_timings.overruns += new_timings.overruns;
     return prev_timings;
 }
 
+void PerformanceTimer::_update_percentiles(TimingNode& node, const std::vector<TimingLogPoint>& entries)
+{
+    for (const auto& entry : entries)
+    {
+        node.histogram.add(entry.delta_time.count());
+    }
+    node.timings.p50_case = node.histogram.percentile(0.5f) / _period;
+    node.timings.p90_case = node.histogram.percentile(0.9f) / _period;
+    node.timings.p99_case = node.histogram.percentile(0.99f) / _period;
+    node.timings.p999_case = node.histogram.percentile(0.999f) / _period;
+}
+
+void PerformanceTimer::enable_flight_recorder(int trigger_node_id, int periods)
+{
+    _flight_recorder_trigger_id = trigger_node_id;
+    _flight_recorder_periods = std::max(periods, 0);
+}
+
+std::vector<DeadlineMiss> PerformanceTimer::deadline_misses()
+{
+    std::lock_guard<std::mutex> lock(_deadline_miss_lock);
+    std::vector<DeadlineMiss> misses;
+    std::swap(misses, _deadline_misses);
+    return misses;
+}
+
+void PerformanceTimer::_record_flight_data(std::vector<TimingLogPoint>& entries)
+{
+    /* Entries are only ordered per thread, so merge them by start time */
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.start_time < rhs.start_time;
+    });
+    _flight_recorder.insert(_flight_recorder.end(), entries.begin(), entries.end());
+    if (_flight_recorder.empty())
+    {
+        return;
+    }
+
+    auto history_length = std::chrono::nanoseconds(static_cast<int64_t>(_period * _flight_recorder_periods));
+    int trigger_id = _flight_recorder_trigger_id;
+    for (const auto& entry : entries)
+    {
+        if (entry.id == trigger_id && entry.delta_time.count() > _period)
+        {
+            DeadlineMiss miss{entry, {}};
+            auto end_time = entry.start_time + entry.delta_time;
+            for (const auto& record : _flight_recorder)
+            {
+                if (record.start_time >= entry.start_time - history_length && record.start_time <= end_time)
+                {
+                    miss.records.push_back(record);
+                }
+            }
+            std::lock_guard<std::mutex> lock(_deadline_miss_lock);
+            if (_deadline_misses.size() < static_cast<size_t>(MAX_STORED_DEADLINE_MISSES))
+            {
+                _deadline_misses.push_back(std::move(miss));
+            }
+        }
+    }
+
+    /* Keep only the records that could be part of future snapshots, with some margin
+     * since the trigger record of a period is logged last */
+    auto oldest_time = _flight_recorder.back().start_time - 2 * history_length;
+    while (_flight_recorder.empty() == false && _flight_recorder.front().start_time < oldest_time)
+    {
+        _flight_recorder.pop_front();
+    }
+}
+
 bool PerformanceTimer::clear_timings_for_node(int id)
 {
     std::lock_guard<std::mutex> lock(_timing_lock);
@@ -150,6 +334,7 @@ bool PerformanceTimer::clear_timings_for_node(int id)
     if (node != _timings.end())
     {
         new (&node->second.timings) (ProcessTimings);
+        node->second.histogram.clear();
         return true;
     }
     return false;
@@ -161,6 +346,7 @@ void PerformanceTimer::clear_all_timings()
     for (auto& node : _timings)
     {
         new (&node.second.timings) (ProcessTimings);
+        node.second.histogram.clear();
     }
 }
 
@@ -21,10 +21,13 @@
 #ifndef SUSHI_PERFORMANCE_TIMER_H
 #define SUSHI_PERFORMANCE_TIMER_H
 
+#include <array>
 #include <chrono>
 #include <atomic>
+#include <deque>
 #include <thread>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -40,14 +43,88 @@ namespace performance {
 
 using TimePoint = std::chrono::nanoseconds;
 constexpr int MAX_LOG_ENTRIES = 20000;
+/* Default number of threads that can log timings concurrently through stop_timer_rt_safe(),
+ * owners that know their thread count, i.e. the engine, should set it explicitly */
+constexpr int DEFAULT_TIMING_THREADS = 8;
+/* Max number of deadline miss snapshots stored until they are read out */
+constexpr int MAX_STORED_DEADLINE_MISSES = 10;
 
+/* Histogram resolution, 2^HISTOGRAM_SUB_BUCKET_BITS buckets per power of 2 */
+constexpr int HISTOGRAM_SUB_BUCKET_BITS = 5;
+constexpr int HISTOGRAM_BUCKETS = 1024;
+
+/**
+ * @brief Log-linear histogram of timing values in the style of HdrHistogram. Values
+ *        are recorded with a relative precision of 2^-HISTOGRAM_SUB_BUCKET_BITS and
+ *        values too large to fit are recorded in the last bucket.
+ */
+class TimingHistogram
+{
+public:
+    TimingHistogram();
+
+    /**
+     * @brief Record a value
+     * @param value A positive integer value, i.e. a time in nanoseconds
+     */
+    void add(int64_t value);
+
+    /**
+     * @brief Get the value at a given percentile of the recorded values
+     * @param percentile The percentile as a fraction between 0 and 1
+     * @return The approximate value at percentile or 0 if no values are recorded
+     */
+    int64_t percentile(float percentile) const;
+
+    /**
+     * @return The number of recorded values
+     */
+    uint64_t count() const {return _count;}
+
+    /**
+     * @brief Remove all recorded values
+     */
+    void clear();
+
+private:
+    static int _bucket_index(int64_t value);
+    static int64_t _bucket_value(int index);
+
+    std::array<uint64_t, HISTOGRAM_BUCKETS> _buckets;
+    uint64_t _count{0};
+};
+
+/**
+ * @brief A single timing record of a timing node
+ */
+struct TimingRecord
+{
+    int id;
+    TimePoint start_time;
+    TimePoint delta_time;
+};
+
+/**
+ * @brief Snapshot of all timing records preceding and including a deadline miss
+ */
+struct DeadlineMiss
+{
+    TimingRecord trigger;
+    std::vector<TimingRecord> records;
+};
 
 class PerformanceTimer : public BasePerformanceTimer
 {
 public:
     SUSHI_DECLARE_NON_COPYABLE(PerformanceTimer);
 
-    PerformanceTimer() = default;
+    /**
+     * @brief Create a performance timer
+     * @param max_threads The max number of threads that can log through
+     *        stop_timer_rt_safe() at the same time, a queue is allocated for each.
+     *        Queues are released when their thread exits.
+     */
+    explicit PerformanceTimer(int max_threads = DEFAULT_TIMING_THREADS);
     virtual ~PerformanceTimer();
 
     /**
@@ -85,7 +162,7 @@ public:
     {
         if (_enabled)
         {
-            TimingLogPoint tp{node_id, twine::current_rt_time() - start_time};
+            TimingLogPoint tp{node_id, start_time, twine::current_rt_time() - start_time};
             _entry_queue.push(tp);
             // if queue is full, drop entries silently.
         }
@@ -93,7 +170,9 @@ public:
 
     /**
      * @brief Exit point for timing section. Safe to call concurrently from
-     *       several threads.
+     *       several threads. Each calling thread logs to its own wait free
+     *       queue, so threads never contend with each other. The first call
+     *       from a thread allocates once, see _queue_for_current_thread().
      * @param start_time A timestamp from a previous call to start_timer()
      * @param node_id An integer id to identify timings from this node
      */
@@ -101,11 +180,13 @@ public:
     {
         if(_enabled)
         {
-            TimingLogPoint tp{node_id, twine::current_rt_time() - start_time};
-            _queue_lock.lock();
-            _entry_queue.push(tp);
-            _queue_lock.unlock();
-            // if queue is full, drop entries silently.
+            TimingLogPoint tp{node_id, start_time, twine::current_rt_time() - start_time};
+            auto queue = _queue_for_current_thread();
+            if (queue)
+            {
+                queue->push(tp);
+            }
+            // if queue is full or there are no free queues, drop entries silently.
         }
     }
 
@@ -140,25 +221,102 @@ public:
      */
     void clear_all_timings() override;
 
+    /**
+     * @brief Enable a flight recorder that keeps the timing records of the last
+     *        periods. When a timing record from trigger_node_id is longer than the
+     *        timing period, a snapshot of that record and the records from the
+     *        preceding periods is stored. Requires timings to be enabled.
+     * @param trigger_node_id The id of the node that should trigger snapshots
+     * @param periods The number of preceding timing periods to include in a
+     *                snapshot, 0 disables the flight recorder
+     */
+    void enable_flight_recorder(int trigger_node_id, int periods);
+
+    /**
+     * @brief Get the deadline miss snapshots recorded since the last call. If more
+     *        than MAX_STORED_DEADLINE_MISSES were recorded, only the first are kept.
+     * @return A vector of DeadlineMiss snapshots, ordered by time.
+     */
+    std::vector<DeadlineMiss> deadline_misses();
+
 protected:
+    using TimingLogPoint = TimingRecord;
 
-    struct TimingLogPoint
+    struct TimingNode
     {
         int id;
-        TimePoint delta_time;
+        ProcessTimings timings;
+        TimingHistogram histogram;
     };
 
-    struct TimingNode
+    using TimingQueue = memory_relaxed_aquire_release::CircularFifo<TimingLogPoint, MAX_LOG_ENTRIES>;
+
+    struct ThreadSlot
     {
-        int id;
-        ProcessTimings timings;
+        std::atomic<bool> claimed{false};
+        TimingQueue queue;
     };
 
+    /* Holds the slot claimed by a thread. Shared ownership so that the slot
+     * can be released on thread exit even if the timer is gone by then */
+    struct ThreadQueue
+    {
+        ~ThreadQueue()
+        {
+            release();
+        }
+
+        void release()
+        {
+            if (slot)
+            {
+                slot->claimed.store(false, std::memory_order_release);
+                slot.reset();
+            }
+        }
+
+        unsigned int timer_instance{0};
+        std::shared_ptr<ThreadSlot> slot;
+    };
+
+    /**
+     * @brief Get the queue reserved for the calling thread, the first call from
+     *        a thread claims a free queue. Wait free, but the first call from each
+     *        thread allocates once, as registering the destructor of the thread_local
+     *        slot holder with the c++ runtime allocates memory. Later calls don't
+     *        allocate.
+     * @return A pointer to a TimingQueue or nullptr if all queues are taken.
+     */
+    TimingQueue* _queue_for_current_thread()
+    {
+        thread_local ThreadQueue thread_queue;
+        if (thread_queue.timer_instance != _instance_id)
+        {
+            thread_queue.release();
+            for (const auto& slot : _thread_slots)
+            {
+                bool expected = false;
+                if (slot->claimed.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    thread_queue.slot = slot;
+                    thread_queue.timer_instance = _instance_id;
+                    return &slot->queue;
+                }
+            }
+            /* Try again on the next call in case a thread has exited since */
+            _slots_exhausted.store(true, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &thread_queue.slot->queue;
+    }
+
     void _worker();
     void _update_timings();
 
     ProcessTimings _calculate_timings(const std::vector<TimingLogPoint>& entries);
     ProcessTimings _merge_timings(ProcessTimings prev_timings, ProcessTimings new_timings);
+    void _record_flight_data(std::vector<TimingLogPoint>& entries);
+    void _update_percentiles(TimingNode& node, const std::vector<TimingLogPoint>& entries);
 
     std::thread _process_thread;
     float _period;
@@ -166,8 +324,17 @@ protected:
 
     std::map<int, TimingNode>  _timings;
     std::mutex _timing_lock;
-    SpinLock _queue_lock;
-    alignas(ASSUMED_CACHE_LINE_SIZE) memory_relaxed_aquire_release::CircularFifo<TimingLogPoint, MAX_LOG_ENTRIES> _entry_queue;
+
+    std::atomic<int> _flight_recorder_periods{0};
+    std::atomic<int> _flight_recorder_trigger_id{0};
+    std::deque<TimingLogPoint> _flight_recorder;
+    std::vector<DeadlineMiss> _deadline_misses;
+    std::mutex _deadline_miss_lock;
+    unsigned int _instance_id;
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<bool> _slots_exhausted{false};
+    bool _slots_exhausted_logged{false};
+    std::vector<std::shared_ptr<ThreadSlot>> _thread_slots;
+    alignas(ASSUMED_CACHE_LINE_SIZE) TimingQueue _entry_queue;
 };
 
 } // namespace performance
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Pointer to immutable data that can be read lock free while being replaced,
+ *        read-copy-update style.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_RCU_POINTER_H
+#define SUSHI_RCU_POINTER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "library/constants.h"
+
+namespace sushi {
+
+/**
+ * @brief Holds a pointer to an immutable object that readers can access without taking
+ *        any locks. Updates are made by publishing a complete new copy of the object, the
+ *        old copy is deleted once no reader can be using it anymore.
+ *        Reading is wait free and can be done from any number of threads concurrently.
+ *        Updating blocks until reads that started before the update have finished and
+ *        must only be done from one thread at a time, i.e. updates need to be protected
+ *        by a mutex if done from several threads.
+ *        Readers register in one of two counters selected by the current epoch. An update
+ *        flips the epoch and waits for the previous counter to drain, twice, so that a
+ *        continuous stream of new readers can not hold off the update indefinitely.
+ */
+template <typename T>
+class RcuPointer
+{
+public:
+    /**
+     * @brief Gives read access to the current object for as long as it is in scope.
+     *        Should be kept short lived as it holds off updates.
+     */
+    class ReadLock
+    {
+    public:
+        SUSHI_DECLARE_NON_COPYABLE(ReadLock);
+
+        explicit ReadLock(const RcuPointer& pointer) : _readers(pointer._readers[pointer._epoch.load()])
+        {
+            /* The reader count must be incremented before the pointer is loaded, or the
+             * object could be deleted between loading and registering as a reader */
+            _readers.fetch_add(1);
+            _data = pointer._data.load();
+        }
+
+        ~ReadLock()
+        {
+            _readers.fetch_sub(1, std::memory_order_release);
+        }
+
+        const T* get() const {return _data;}
+
+        const T* operator->() const {return _data;}
+
+        const T& operator*() const {return *_data;}
+
+    private:
+        std::atomic<int>& _readers;
+        const T*          _data;
+    };
+
+    RcuPointer() = default;
+
+    explicit RcuPointer(std::unique_ptr<T> data) : _data(data.release()) {}
+
+    SUSHI_DECLARE_NON_COPYABLE(RcuPointer);
+
+    ~RcuPointer()
+    {
+        delete _data.load();
+    }
+
+    /**
+     * @brief Lock the current object for reading
+     * @return A ReadLock object giving access to the object
+     */
+    ReadLock read() const
+    {
+        return ReadLock(*this);
+    }
+
+    /**
+     * @brief Replace the current object. Blocks until all readers of the previous object
+     *        are done, after which it is deleted. Not safe to call from an rt thread.
+     * @param data The new object
+     */
+    void update(std::unique_ptr<T> data)
+    {
+        T* previous = _data.exchange(data.release());
+        for (int i = 0; i < 2; ++i)
+        {
+            int previous_epoch = _epoch.fetch_xor(1);
+            while (_readers[previous_epoch].load() > 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        delete previous;
+    }
+
+private:
+    std::atomic<T*>          _data{nullptr};
+    std::atomic<int>         _epoch{0};
+    mutable std::atomic<int> _readers[2]{{0}, {0}};
+};
+
+} // end namespace sushi
+
+#endif //SUSHI_RCU_POINTER_H
@@ -24,6 +24,7 @@
 #include <string>
 #include <cassert>
 #include <optional>
+#include <vector>
 
 #include "id_generator.h"
 #include "library/types.h"
@@ -73,6 +74,7 @@ enum class RtEventType
     REMOVE_PROCESSOR_FROM_TRACK,
     ADD_TRACK,
     REMOVE_TRACK,
+    GRAPH_TRANSACTION,
     ASYNC_WORK,
     ASYNC_WORK_NOTIFICATION,
     /* Routing events */
@@ -114,6 +116,12 @@ public:
      */
     int sample_offset() const {return _sample_offset;}
 
+    /**
+     * @brief Reposition the event within the chunk, used when releasing scheduled events
+     * @param offset The new offset in samples
+     */
+    void set_sample_offset(int offset) {_sample_offset = offset;}
+
 protected:
     BaseRtEvent(RtEventType type, ObjectId target, int offset) : _type(type),
                                                                  _processor_id(target),
@@ -410,6 +418,63 @@ private:
     std::optional<ObjectId> _before_processor;
 };
 
+/**
+ * @brief Class for adding a track to the audio graph, optionally on a given cpu core.
+ *        If the track is already in the audio graph and a core is given, the track
+ *        is moved to that core instead.
+ */
+class AddTrackRtEvent : public ReturnableRtEvent
+{
+public:
+    AddTrackRtEvent(ObjectId track, std::optional<int> core) : ReturnableRtEvent(RtEventType::ADD_TRACK, 0),
+                                                               _track{track},
+                                                               _core{core} {}
+
+    ObjectId track() const {return _track;}
+    const std::optional<int>& core() const {return _core;}
+
+private:
+    ObjectId _track;
+    std::optional<int> _core;
+};
+
+class RtEvent;
+
+/**
+ * @brief Class for applying a number of graph editing events in the same audio chunk.
+ *        The heap allocated list of events travels with the event and must only be
+ *        deleted once the event has been returned from the rt thread, even if the
+ *        sender stopped waiting for it. Each event is updated with its own return status.
+ *        The undo list is filled by the rt thread with the inverse of every applied event,
+ *        so that the whole transaction can be reverted if one of them fails. It must have
+ *        capacity for as many events as the transaction, so the rt thread never allocates.
+ */
+class GraphTransactionRtEvent : public ReturnableRtEvent
+{
+public:
+    GraphTransactionRtEvent(std::vector<RtEvent>* events,
+                            std::vector<RtEvent>* undo_events) : ReturnableRtEvent(RtEventType::GRAPH_TRANSACTION, 0),
+                                                                 _events{events},
+                                                                 _undo_events{undo_events} {}
+
+    std::vector<RtEvent>* events() const {return _events;}
+
+    std::vector<RtEvent>* undo_events() const {return _undo_events;}
+
+    /**
+     * @brief Delete both event lists, call only once the event is back from the rt thread
+     */
+    void delete_events()
+    {
+        delete _events;
+        delete _undo_events;
+    }
+
+private:
+    std::vector<RtEvent>* _events;
+    std::vector<RtEvent>* _undo_events;
+};
+
 typedef int (*AsyncWorkCallback)(void* data, EventId id);
 
 class AsyncWorkRtEvent: public ReturnableRtEvent
@@ -591,6 +656,8 @@ public:
 
     int sample_offset() const {return _base_event.sample_offset();}
 
+    void set_sample_offset(int offset) {_base_event.set_sample_offset(offset);}
+
     /* Access functions protected by asserts */
     const KeyboardRtEvent* keyboard_event() const
     {
@@ -680,7 +747,6 @@ public:
         assert(_processor_reorder_event.type() == RtEventType::REMOVE_PROCESSOR ||
                _processor_reorder_event.type() == RtEventType::ADD_PROCESSOR_TO_TRACK ||
                _processor_reorder_event.type() == RtEventType::REMOVE_PROCESSOR_FROM_TRACK ||
-               _processor_reorder_event.type() == RtEventType::ADD_TRACK ||
                _processor_reorder_event.type() == RtEventType::REMOVE_TRACK);
         ;
         return &_processor_reorder_event;
@@ -691,12 +757,35 @@ public:
         assert(_processor_reorder_event.type() == RtEventType::REMOVE_PROCESSOR ||
                _processor_reorder_event.type() == RtEventType::ADD_PROCESSOR_TO_TRACK ||
                _processor_reorder_event.type() == RtEventType::REMOVE_PROCESSOR_FROM_TRACK ||
-               _processor_reorder_event.type() == RtEventType::ADD_TRACK ||
                _processor_reorder_event.type() == RtEventType::REMOVE_TRACK);
         ;
         return &_processor_reorder_event;
     }
 
+    const AddTrackRtEvent* add_track_event() const
+    {
+        assert(_add_track_event.type() == RtEventType::ADD_TRACK);
+        return &_add_track_event;
+    }
+
+    AddTrackRtEvent* add_track_event()
+    {
+        assert(_add_track_event.type() == RtEventType::ADD_TRACK);
+        return &_add_track_event;
+    }
+
+    const GraphTransactionRtEvent* graph_transaction_event() const
+    {
+        assert(_graph_transaction_event.type() == RtEventType::GRAPH_TRANSACTION);
+        return &_graph_transaction_event;
+    }
+
+    GraphTransactionRtEvent* graph_transaction_event()
+    {
+        assert(_graph_transaction_event.type() == RtEventType::GRAPH_TRANSACTION);
+        return &_graph_transaction_event;
+    }
+
     const AsyncWorkRtEvent* async_work_event() const
     {
         assert(_async_work_event.type() == RtEventType::ASYNC_WORK);
@@ -906,9 +995,9 @@ public:
         return RtEvent(typed_event);
     }
 
-    static RtEvent make_add_track_event(ObjectId track)
+    static RtEvent make_add_track_event(ObjectId track, std::optional<int> core = std::nullopt)
     {
-        ProcessorReorderRtEvent typed_event(RtEventType::ADD_TRACK, 0, track, std::nullopt);
+        AddTrackRtEvent typed_event(track, core);
         return RtEvent(typed_event);
     }
 
@@ -918,6 +1007,12 @@ public:
         return RtEvent(typed_event);
     }
 
+    static RtEvent make_graph_transaction_event(std::vector<RtEvent>* events, std::vector<RtEvent>* undo_events)
+    {
+        GraphTransactionRtEvent typed_event(events, undo_events);
+        return RtEvent(typed_event);
+    }
+
     static RtEvent make_async_work_event(AsyncWorkCallback callback, ObjectId processor, void* data)
     {
         AsyncWorkRtEvent typed_event(callback, processor, data);
@@ -1071,6 +1166,8 @@ private:
     RtEvent(const ReturnableRtEvent& e)                 : _returnable_event(e) {}
     RtEvent(const ProcessorOperationRtEvent& e)         : _processor_operation_event(e) {}
     RtEvent(const ProcessorReorderRtEvent& e)           : _processor_reorder_event(e) {}
+    RtEvent(const AddTrackRtEvent& e)                   : _add_track_event(e) {}
+    RtEvent(const GraphTransactionRtEvent& e)           : _graph_transaction_event(e) {}
     RtEvent(const AsyncWorkRtEvent& e)                  : _async_work_event(e) {}
     RtEvent(const AsyncWorkRtCompletionEvent& e)        : _async_work_completion_event(e) {}
     RtEvent(const AudioConnectionRtEvent& e)            : _audio_connection_event(e) {}
@@ -1099,6 +1196,8 @@ private:
         ReturnableRtEvent             _returnable_event;
         ProcessorOperationRtEvent     _processor_operation_event;
         ProcessorReorderRtEvent       _processor_reorder_event;
+        AddTrackRtEvent               _add_track_event;
+        GraphTransactionRtEvent       _graph_transaction_event;
         AsyncWorkRtEvent              _async_work_event;
         AsyncWorkRtCompletionEvent    _async_work_completion_event;
         AudioConnectionRtEvent        _audio_connection_event;
@@ -21,10 +21,14 @@
 #ifndef SUSHI_REALTIME_FIFO_H
 #define SUSHI_REALTIME_FIFO_H
 
+#include <atomic>
+
 #include "fifo/circularfifo_memory_relaxed_aquire_release.h"
 #include "library/simple_fifo.h"
+#include "library/mpsc_fifo.h"
 #include "library/rt_event.h"
 #include "library/rt_event_pipe.h"
+#include "library/rt_event_scheduler.h"
 
 namespace sushi {
 
@@ -37,7 +41,17 @@ class RtSafeRtEventFifo : public RtEventPipe
 {
 public:
 
-    inline bool push(const RtEvent& event) {return _fifo.push(event);}
+    inline bool push(const RtEvent& event)
+    {
+        if (_fifo.push(event))
+        {
+            /* Single producer, so no read-modify-write needed */
+            _pushed_events.store(_pushed_events.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return true;
+        }
+        _overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
 
     inline bool pop(RtEvent& event)
     {
@@ -48,8 +62,123 @@ public:
 
     void send_event(const RtEvent &event) override {push(event);}
 
+    /**
+     * @brief The total number of events pushed, wraps around on overflow. Only
+     *        meaningful to call from the producer thread.
+     */
+    uint32_t pushed_events() const {return _pushed_events.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief The number of events that could not be pushed because the queue was full
+     */
+    int overflows() const {return _overflows.load(std::memory_order_relaxed);}
+
 private:
     memory_relaxed_aquire_release::CircularFifo<RtEvent, MAX_EVENTS_IN_QUEUE> _fifo;
+    std::atomic<int> _overflows{0};
+    std::atomic<uint32_t> _pushed_events{0};
+};
+
+/**
+ * @brief Lock free fifo queue for sending events to an rt thread from several non-rt
+ *        threads concurrently. Pushing is thread safe, popping must only be done from
+ *        a single thread.
+ */
+class RtSafeMpscRtEventFifo : public RtEventPipe
+{
+public:
+    explicit RtSafeMpscRtEventFifo(int capacity = MAX_EVENTS_IN_QUEUE) : _fifo(capacity) {}
+
+    /**
+     * @brief Reallocate the queue and reset its statistics. Must not be called while
+     *        the queue is in use.
+     * @param capacity The new capacity, rounded up to the nearest power of 2
+     */
+    void set_capacity(int capacity)
+    {
+        _fifo.resize(capacity);
+        _overflows.store(0);
+        _high_water_mark.store(0);
+    }
+
+    int capacity() const {return static_cast<int>(_fifo.capacity());}
+
+    inline bool push(const RtEvent& event)
+    {
+        if (_fifo.push(event))
+        {
+            return true;
+        }
+        _overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    inline bool pop(RtEvent& event)
+    {
+        int size = static_cast<int>(_fifo.size());
+        if (size > _high_water_mark.load(std::memory_order_relaxed))
+        {
+            _high_water_mark.store(size, std::memory_order_relaxed);
+        }
+        return _fifo.pop(event);
+    }
+
+    inline bool empty() const {return _fifo.empty();}
+
+    /**
+     * @brief The number of events in the queue, only meaningful when called from the consumer
+     */
+    int size() const {return static_cast<int>(_fifo.size());}
+
+    void send_event(const RtEvent &event) override {push(event);}
+
+    /**
+     * @brief The number of events that could not be pushed because the queue was full
+     */
+    int overflows() const {return _overflows.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief The largest number of events seen in the queue by the consumer
+     */
+    int high_water_mark() const {return _high_water_mark.load(std::memory_order_relaxed);}
+
+private:
+    MpscFifo<RtEvent> _fifo;
+    std::atomic<int>  _overflows{0};
+    std::atomic<int>  _high_water_mark{0};
+};
+
+/**
+ * @brief Wait free fifo queue for sending timestamped events to the rt scheduler
+ */
+class RtSafeScheduledRtEventFifo
+{
+public:
+    inline bool push(const ScheduledRtEvent& event) {return _fifo.push(event);}
+
+    inline bool pop(ScheduledRtEvent& event) {return _fifo.pop(event);}
+
+    inline bool empty() {return _fifo.wasEmpty();}
+
+private:
+    memory_relaxed_aquire_release::CircularFifo<ScheduledRtEvent, MAX_EVENTS_IN_QUEUE> _fifo;
+};
+
+/**
+ * @brief Lock free fifo queue for sending timestamped events to the rt scheduler from
+ *        several non-rt threads concurrently, i.e. midi input threads.
+ */
+class RtSafeMpscScheduledRtEventFifo
+{
+public:
+    inline bool push(const ScheduledRtEvent& event) {return _fifo.push(event);}
+
+    inline bool pop(ScheduledRtEvent& event) {return _fifo.pop(event);}
+
+    inline bool empty() const {return _fifo.empty();}
+
+private:
+    MpscFifo<ScheduledRtEvent> _fifo{MAX_EVENTS_IN_QUEUE};
 };
 
 /**
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Time ordered queue for releasing RtEvents at sample accurate positions
+ *        in the chunk they are scheduled for.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_RT_EVENT_SCHEDULER_H
+#define SUSHI_RT_EVENT_SCHEDULER_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "library/constants.h"
+#include "library/rt_event.h"
+#include "library/time.h"
+
+namespace sushi {
+
+constexpr size_t MAX_SCHEDULED_EVENTS = 1024;
+
+/**
+ * @brief An RtEvent together with the real time at which it should take effect
+ */
+struct ScheduledRtEvent
+{
+    Time    time;
+    RtEvent event;
+};
+
+/**
+ * @brief A fixed capacity priority queue of RtEvents ordered by timestamp. All storage
+ *        is preallocated so events can be scheduled and released from the rt thread.
+ *        Events with equal timestamps are released in the order they were scheduled.
+ * @tparam capacity The maximum number of events that can be scheduled at once
+ */
+template <size_t capacity = MAX_SCHEDULED_EVENTS>
+class RtEventScheduler
+{
+public:
+    explicit RtEventScheduler(float sample_rate)
+    {
+        set_sample_rate(sample_rate);
+    }
+
+    /**
+     * @brief Set the samplerate used to convert timestamps to sample offsets
+     * @param sample_rate Samplerate in Hz
+     */
+    void set_sample_rate(float sample_rate)
+    {
+        _chunk_time = std::chrono::microseconds(static_cast<int64_t>(std::round(1'000'000.0f / sample_rate * AUDIO_CHUNK_SIZE)));
+    }
+
+    /**
+     * @brief Add an event to the queue
+     * @param event The event and its timestamp
+     * @return true if the event was scheduled, false if the queue is full
+     */
+    bool schedule(const ScheduledRtEvent& event)
+    {
+        if (full())
+        {
+            return false;
+        }
+        _heap[_size++] = {event.time, _sequence++, event.event};
+        std::push_heap(_heap.begin(), _heap.begin() + _size, _later);
+        return true;
+    }
+
+    /**
+     * @brief Pop the earliest event if it is due in the chunk starting at chunk_start.
+     *        The sample offset of the returned event is set to where in the chunk its
+     *        timestamp falls. Events that are overdue are given offset 0.
+     * @param chunk_start The real time of the first sample in the current chunk
+     * @param event Will be assigned the released event
+     * @return true if an event was released, false if no more events are due
+     */
+    bool pop_due_event(Time chunk_start, RtEvent& event)
+    {
+        if (has_due_event(chunk_start) == false)
+        {
+            return false;
+        }
+        std::pop_heap(_heap.begin(), _heap.begin() + _size, _later);
+        const auto& entry = _heap[--_size];
+        int64_t offset = (AUDIO_CHUNK_SIZE * (entry.time - chunk_start)) / _chunk_time;
+        event = entry.event;
+        event.set_sample_offset(static_cast<int>(std::clamp(offset, int64_t{0}, int64_t{AUDIO_CHUNK_SIZE - 1})));
+        return true;
+    }
+
+    /**
+     * @brief Check if the earliest event is due in the chunk starting at chunk_start
+     * @param chunk_start The real time of the first sample in the current chunk
+     * @return true if pop_due_event() would release an event
+     */
+    bool has_due_event(Time chunk_start) const
+    {
+        return empty() == false && _heap.front().time < chunk_start + _chunk_time;
+    }
+
+    bool empty() const {return _size == 0;}
+
+    bool full() const {return _size == capacity;}
+
+    int size() const {return static_cast<int>(_size);}
+
+    void clear() {_size = 0;}
+
+private:
+    struct Entry
+    {
+        Time     time;
+        uint64_t sequence;
+        RtEvent  event;
+    };
+
+    /* Comparison for a min heap, i.e. the earliest event ends up at the front */
+    static bool _later(const Entry& lhs, const Entry& rhs)
+    {
+        return lhs.time > rhs.time || (lhs.time == rhs.time && lhs.sequence > rhs.sequence);
+    }
+
+    std::array<Entry, capacity> _heap;
+    size_t   _size{0};
+    uint64_t _sequence{0};
+    Time     _chunk_time;
+};
+
+} // end namespace sushi
+
+#endif //SUSHI_RT_EVENT_SCHEDULER_H
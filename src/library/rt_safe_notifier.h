@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Wakeup signal for waking up a sleeping non-rt thread from any thread,
+ *        including rt threads
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_RT_SAFE_NOTIFIER_H
+#define SUSHI_RT_SAFE_NOTIFIER_H
+
+#include <atomic>
+#include <chrono>
+
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace sushi {
+
+/**
+ * @brief A binary semaphore with a single waiting thread. Notifications that arrive
+ *        while the waiting thread is busy are coalesced into one, and only the first
+ *        of them results in a system call. On Linux this is implemented with a futex,
+ *        so notify() never blocks and can be called from an rt thread.
+ */
+class RtSafeNotifier
+{
+public:
+    RtSafeNotifier() = default;
+
+    ~RtSafeNotifier() = default;
+
+    /**
+     * @brief Wake up the thread waiting in wait_for(), or if it is not waiting, make
+     *        its next call to wait_for() return immediately.
+     */
+    void notify()
+    {
+        if (_notified.exchange(1, std::memory_order_acq_rel) == 0)
+        {
+#ifdef __linux__
+            syscall(SYS_futex, reinterpret_cast<int*>(&_notified), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+            /* Not strictly rt safe, but the best we can do portably. Taking the lock
+             * ensures the waiter either sees the flag or is already waiting */
+            std::lock_guard<std::mutex> lock(_mutex);
+            _condition.notify_one();
+#endif
+        }
+    }
+
+    /**
+     * @brief Wait until notify() is called or the timeout expires, returns immediately
+     *        if notify() was called since the last call to wait_for().
+     * @param timeout The maximum time to wait
+     * @return true if woken up by a notification, false on timeout
+     */
+    bool wait_for(std::chrono::nanoseconds timeout)
+    {
+        if (_notified.exchange(0, std::memory_order_acq_rel) == 1)
+        {
+            return true;
+        }
+#ifdef __linux__
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        timespec relative_timeout = {static_cast<time_t>(seconds.count()),
+                                     static_cast<long>((timeout - seconds).count())};
+        /* Returns immediately if _notified was set after the exchange above */
+        syscall(SYS_futex, reinterpret_cast<int*>(&_notified), FUTEX_WAIT_PRIVATE, 0, &relative_timeout, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait_for(lock, timeout, [&]() {return _notified.load() == 1;});
+#endif
+        return _notified.exchange(0, std::memory_order_acq_rel) == 1;
+    }
+
+private:
+    static_assert(sizeof(std::atomic<int>) == sizeof(int) && std::atomic<int>::is_always_lock_free);
+    std::atomic<int> _notified{0};
+#ifndef __linux__
+    std::mutex _mutex;
+    std::condition_variable _condition;
+#endif
+};
+
+} // end namespace sushi
+
+#endif //SUSHI_RT_SAFE_NOTIFIER_H
@@ -24,13 +24,17 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <new>
 
 #include "constants.h"
+#include "sample_buffer_kernels.h"
 
 namespace sushi {
 
 constexpr int LEFT_CHANNEL_INDEX = 0;
 constexpr int RIGHT_CHANNEL_INDEX = 1;
+/* Alignment of the data of owning buffers, enough for the widest supported vector instructions */
+constexpr size_t SAMPLE_BUFFER_ALIGNMENT = 32;
 
 template<int size>
 class SampleBuffer
@@ -41,7 +45,7 @@ public:
      */
     explicit SampleBuffer(int channel_count) : _channel_count(channel_count),
                                                _own_buffer(true),
-                                               _buffer(new float[size * channel_count])
+                                               _buffer(_allocate(channel_count))
     {
         clear();
     }
@@ -63,7 +67,7 @@ public:
     {
         if (o._own_buffer)
         {
-            _buffer = new float[size * o._channel_count];
+            _buffer = _allocate(o._channel_count);
             std::copy(o._buffer, o._buffer + (size * o._channel_count), _buffer);
         } else
         {
@@ -90,7 +94,7 @@ public:
     {
         if (_own_buffer)
         {
-            delete[] _buffer;
+            _free(_buffer);
         }
     }
 
@@ -106,8 +110,8 @@ public:
             {
                 if (_channel_count != o._channel_count)
                 {
-                    delete[] _buffer;
-                    _buffer = (o._channel_count > 0)? (new float[size * o._channel_count]) : nullptr;
+                    _free(_buffer);
+                    _buffer = _allocate(o._channel_count);
                     _channel_count = o._channel_count;
                 }
             }
@@ -141,7 +145,7 @@ public:
         {
             if (_own_buffer)
             {
-                delete[] _buffer;
+                _free(_buffer);
             }
             _channel_count = o._channel_count;
             _own_buffer = o._own_buffer;
@@ -246,13 +250,7 @@ public:
         {
             case 2:  // Most common case, others are mostly included for future compatibility
             {
-                float* l_in = _buffer;
-                float* r_in = _buffer + size;
-                for (int n = 0; n < size; ++n)
-                {
-                    *l_in++ = *interleaved_buf++;
-                    *r_in++ = *interleaved_buf++;
-                }
+                kernels::deinterleave_stereo(_buffer, _buffer + size, interleaved_buf, size);
                 break;
             }
             case 1:
@@ -282,13 +280,7 @@ public:
         {
             case 2:  // Most common case, others are mostly included for future compatibility
             {
-                float* l_out = _buffer;
-                float* r_out = _buffer + size;
-                for (int n = 0; n < size; ++n)
-                {
-                    *interleaved_buf++ = *l_out++;
-                    *interleaved_buf++ = *r_out++;
-                }
+                kernels::interleave_stereo(interleaved_buf, _buffer, _buffer + size, size);
                 break;
             }
             case 1:
@@ -314,10 +306,7 @@ public:
      */
     void apply_gain(float gain)
     {
-        for (int i = 0; i < size * _channel_count; ++i)
-        {
-            _buffer[i] *= gain;
-        }
+        kernels::apply_gain(_buffer, gain, size * _channel_count);
     }
 
     /**
@@ -325,11 +314,7 @@ public:
     */
     void apply_gain(float gain, int channel)
     {
-        float* data = _buffer + size * channel;
-        for (int i = 0; i < size; ++i)
-        {
-            data[i] *= gain;
-        }
+        kernels::apply_gain(_buffer + size * channel, gain, size);
     }
 
     /**
@@ -378,18 +363,11 @@ public:
         {
             for (int channel = 0; channel < _channel_count; ++channel)
             {
-                float* dest = _buffer + size * channel;
-                for (int i = 0; i < size; ++i)
-                {
-                    dest[i] += source._buffer[i];
-                }
+                kernels::add(_buffer + size * channel, source._buffer, size);
             }
         } else if (source.channel_count() == _channel_count)
         {
-            for (int i = 0; i < size * _channel_count; ++i)
-            {
-                _buffer[i] += source._buffer[i];
-            }
+            kernels::add(_buffer, source._buffer, size * _channel_count);
         }
     }
 
@@ -399,12 +377,7 @@ public:
      */
     void add(int dest_channel, int source_channel, const SampleBuffer& source)
     {
-        float* source_data = source._buffer + size * source_channel;
-        float* dest_data = _buffer + size * dest_channel;
-        for (int i = 0; i < size; ++i)
-        {
-            dest_data[i] += source_data[i];
-        }
+        kernels::add(_buffer + size * dest_channel, source._buffer + size * source_channel, size);
     }
 
     /**
@@ -421,18 +394,11 @@ public:
         {
             for (int channel = 0; channel < _channel_count; ++channel)
             {
-                float* dest = _buffer + size * channel;
-                for (int i = 0; i < size; ++i)
-                {
-                    dest[i] += source._buffer[i] * gain;
-                }
+                kernels::add_with_gain(_buffer + size * channel, source._buffer, gain, size);
             }
         } else if (source.channel_count() == _channel_count)
         {
-            for (int i = 0; i < size * _channel_count; ++i)
-            {
-                _buffer[i] += source._buffer[i] * gain;
-            }
+            kernels::add_with_gain(_buffer, source._buffer, gain, size * _channel_count);
         }
     }
 
@@ -441,12 +407,7 @@ public:
      */
     void add_with_gain(int dest_channel, int source_channel, const SampleBuffer& source, float gain)
     {
-        float* source_data = source._buffer + size * source_channel;
-        float* dest_data = _buffer + size * dest_channel;
-        for (int i = 0; i < size; ++i)
-        {
-            dest_data[i] += source_data[i] * gain;
-        }
+        kernels::add_with_gain(_buffer + size * dest_channel, source._buffer + size * source_channel, gain, size);
     }
 
     /**
@@ -467,22 +428,13 @@ public:
         {
             for (int channel = 0; channel < _channel_count; ++channel)
             {
-                float* dest = _buffer + size * channel;
-                for (int i = 0; i < size; ++i)
-                {
-                    dest[i] += source._buffer[i] * (start + i * inc);
-                }
+                kernels::add_with_ramp(_buffer + size * channel, source._buffer, start, inc, size);
             }
         } else if (source.channel_count() == _channel_count)
         {
             for (int channel = 0; channel < _channel_count; ++channel)
             {
-                float* source_data = _buffer + size * channel;
-                float* dest_data = _buffer + size * channel;
-                for (int i = 0; i < size; ++i)
-                {
-                    dest_data[i] += source_data[i] * (start + i * inc);
-                }
+                kernels::add_with_ramp(_buffer + size * channel, source._buffer + size * channel, start, inc, size);
             }
         }
     }
@@ -494,12 +446,7 @@ public:
     void add_with_ramp(int dest_channel, int source_channel, const SampleBuffer& source, float start, float end)
     {
         float inc = (end - start) / (size - 1);
-        float* source_data = source._buffer + size * source_channel;
-        float* dest_data = _buffer + size * dest_channel;
-        for (int i = 0; i < size; ++i)
-        {
-            dest_data[i] += source_data[i] * (start + i * inc);
-        }
+        kernels::add_with_ramp(_buffer + size * dest_channel, source._buffer + size * source_channel, start, inc, size);
     }
 
     /**
@@ -512,11 +459,7 @@ public:
         float inc = (end - start) / (size - 1);
         for (int channel = 0; channel < _channel_count; ++channel)
         {
-            float* data = _buffer + size * channel;
-            for (int i = 0; i < size; ++i)
-            {
-                data[i] *= start + i * inc;
-            }
+            kernels::ramp(_buffer + size * channel, start, inc, size);
         }
     }
 
@@ -591,6 +534,24 @@ public:
     }
 
 private:
+    static float* _allocate(int channel_count)
+    {
+        if (channel_count <= 0)
+        {
+            return nullptr;
+        }
+        return static_cast<float*>(::operator new[](sizeof(float) * size * channel_count,
+                                                    std::align_val_t(SAMPLE_BUFFER_ALIGNMENT)));
+    }
+
+    static void _free(float* buffer)
+    {
+        if (buffer)
+        {
+            ::operator delete[](buffer, std::align_val_t(SAMPLE_BUFFER_ALIGNMENT));
+        }
+    }
+
     int _channel_count;
     bool _own_buffer;
     float* _buffer;
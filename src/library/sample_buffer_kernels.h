@@ -0,0 +1,295 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Vectorised kernels for the SampleBuffer mixing operations. The instruction
+ *        set is selected at compile time, AVX or SSE on x86, NEON on arm, with a
+ *        scalar fallback. Pointers do not need to be aligned and any number of
+ *        samples can be processed, though full vectors of samples are fastest.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_SAMPLE_BUFFER_KERNELS_H
+#define SUSHI_SAMPLE_BUFFER_KERNELS_H
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SUSHI_KERNELS_AVX
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SUSHI_KERNELS_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SUSHI_KERNELS_NEON
+#endif
+
+namespace sushi {
+namespace kernels {
+
+#if defined(SUSHI_KERNELS_AVX)
+constexpr int VECTOR_SIZE = 8;
+#elif defined(SUSHI_KERNELS_SSE) || defined(SUSHI_KERNELS_NEON)
+constexpr int VECTOR_SIZE = 4;
+#else
+constexpr int VECTOR_SIZE = 1;
+#endif
+
+/**
+ * @brief dest[i] += source[i]
+ */
+inline void add(float* dest, const float* source, int samples)
+{
+    int i = 0;
+#if defined(SUSHI_KERNELS_AVX)
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), _mm256_loadu_ps(source + i)));
+    }
+#elif defined(SUSHI_KERNELS_SSE)
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_loadu_ps(source + i)));
+    }
+#elif defined(SUSHI_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        vst1q_f32(dest + i, vaddq_f32(vld1q_f32(dest + i), vld1q_f32(source + i)));
+    }
+#endif
+    for (; i < samples; ++i)
+    {
+        dest[i] += source[i];
+    }
+}
+
+/**
+ * @brief dest[i] += source[i] * gain
+ */
+inline void add_with_gain(float* dest, const float* source, float gain, int samples)
+{
+    int i = 0;
+#if defined(SUSHI_KERNELS_AVX)
+    __m256 gain_v = _mm256_set1_ps(gain);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        __m256 product = _mm256_mul_ps(_mm256_loadu_ps(source + i), gain_v);
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), product));
+    }
+#elif defined(SUSHI_KERNELS_SSE)
+    __m128 gain_v = _mm_set1_ps(gain);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        __m128 product = _mm_mul_ps(_mm_loadu_ps(source + i), gain_v);
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), product));
+    }
+#elif defined(SUSHI_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        vst1q_f32(dest + i, vmlaq_n_f32(vld1q_f32(dest + i), vld1q_f32(source + i), gain));
+    }
+#endif
+    for (; i < samples; ++i)
+    {
+        dest[i] += source[i] * gain;
+    }
+}
+
+/**
+ * @brief dest[i] += source[i] * (start + i * increment)
+ */
+inline void add_with_ramp(float* dest, const float* source, float start, float increment, int samples)
+{
+    int i = 0;
+#if defined(SUSHI_KERNELS_AVX)
+    __m256 start_v = _mm256_set1_ps(start);
+    __m256 inc_v = _mm256_set1_ps(increment);
+    __m256 index_v = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 step_v = _mm256_set1_ps(VECTOR_SIZE);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        __m256 gain_v = _mm256_add_ps(start_v, _mm256_mul_ps(index_v, inc_v));
+        __m256 product = _mm256_mul_ps(_mm256_loadu_ps(source + i), gain_v);
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), product));
+        index_v = _mm256_add_ps(index_v, step_v);
+    }
+#elif defined(SUSHI_KERNELS_SSE)
+    __m128 start_v = _mm_set1_ps(start);
+    __m128 inc_v = _mm_set1_ps(increment);
+    __m128 index_v = _mm_setr_ps(0, 1, 2, 3);
+    __m128 step_v = _mm_set1_ps(VECTOR_SIZE);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        __m128 gain_v = _mm_add_ps(start_v, _mm_mul_ps(index_v, inc_v));
+        __m128 product = _mm_mul_ps(_mm_loadu_ps(source + i), gain_v);
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), product));
+        index_v = _mm_add_ps(index_v, step_v);
+    }
+#elif defined(SUSHI_KERNELS_NEON)
+    const float indexes[VECTOR_SIZE] = {0, 1, 2, 3};
+    float32x4_t start_v = vdupq_n_f32(start);
+    float32x4_t index_v = vld1q_f32(indexes);
+    float32x4_t step_v = vdupq_n_f32(VECTOR_SIZE);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        float32x4_t gain_v = vmlaq_n_f32(start_v, index_v, increment);
+        vst1q_f32(dest + i, vmlaq_f32(vld1q_f32(dest + i), vld1q_f32(source + i), gain_v));
+        index_v = vaddq_f32(index_v, step_v);
+    }
+#endif
+    for (; i < samples; ++i)
+    {
+        dest[i] += source[i] * (start + i * increment);
+    }
+}
+
+/**
+ * @brief data[i] *= gain
+ */
+inline void apply_gain(float* data, float gain, int samples)
+{
+    int i = 0;
+#if defined(SUSHI_KERNELS_AVX)
+    __m256 gain_v = _mm256_set1_ps(gain);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), gain_v));
+    }
+#elif defined(SUSHI_KERNELS_SSE)
+    __m128 gain_v = _mm_set1_ps(gain);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), gain_v));
+    }
+#elif defined(SUSHI_KERNELS_NEON)
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), gain));
+    }
+#endif
+    for (; i < samples; ++i)
+    {
+        data[i] *= gain;
+    }
+}
+
+/**
+ * @brief data[i] *= start + i * increment
+ */
+inline void ramp(float* data, float start, float increment, int samples)
+{
+    int i = 0;
+#if defined(SUSHI_KERNELS_AVX)
+    __m256 start_v = _mm256_set1_ps(start);
+    __m256 inc_v = _mm256_set1_ps(increment);
+    __m256 index_v = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 step_v = _mm256_set1_ps(VECTOR_SIZE);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        __m256 gain_v = _mm256_add_ps(start_v, _mm256_mul_ps(index_v, inc_v));
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), gain_v));
+        index_v = _mm256_add_ps(index_v, step_v);
+    }
+#elif defined(SUSHI_KERNELS_SSE)
+    __m128 start_v = _mm_set1_ps(start);
+    __m128 inc_v = _mm_set1_ps(increment);
+    __m128 index_v = _mm_setr_ps(0, 1, 2, 3);
+    __m128 step_v = _mm_set1_ps(VECTOR_SIZE);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        __m128 gain_v = _mm_add_ps(start_v, _mm_mul_ps(index_v, inc_v));
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), gain_v));
+        index_v = _mm_add_ps(index_v, step_v);
+    }
+#elif defined(SUSHI_KERNELS_NEON)
+    const float indexes[VECTOR_SIZE] = {0, 1, 2, 3};
+    float32x4_t start_v = vdupq_n_f32(start);
+    float32x4_t index_v = vld1q_f32(indexes);
+    float32x4_t step_v = vdupq_n_f32(VECTOR_SIZE);
+    for (; i + VECTOR_SIZE <= samples; i += VECTOR_SIZE)
+    {
+        float32x4_t gain_v = vmlaq_n_f32(start_v, index_v, increment);
+        vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), gain_v));
+        index_v = vaddq_f32(index_v, step_v);
+    }
+#endif
+    for (; i < samples; ++i)
+    {
+        data[i] *= start + i * increment;
+    }
+}
+
+/**
+ * @brief Split interleaved stereo data into separate left and right channels
+ */
+inline void deinterleave_stereo(float* left, float* right, const float* interleaved, int samples)
+{
+    int i = 0;
+    [[maybe_unused]] int vector_samples = samples - samples % 4;
+#if defined(SUSHI_KERNELS_SSE) || defined(SUSHI_KERNELS_AVX)
+    for (; i < vector_samples; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(interleaved + 2 * i);
+        __m128 b = _mm_loadu_ps(interleaved + 2 * i + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#elif defined(SUSHI_KERNELS_NEON)
+    for (; i < vector_samples; i += 4)
+    {
+        float32x4x2_t channels = vld2q_f32(interleaved + 2 * i);
+        vst1q_f32(left + i, channels.val[0]);
+        vst1q_f32(right + i, channels.val[1]);
+    }
+#endif
+    for (; i < samples; ++i)
+    {
+        left[i] = interleaved[2 * i];
+        right[i] = interleaved[2 * i + 1];
+    }
+}
+
+/**
+ * @brief Merge separate left and right channels into interleaved stereo data
+ */
+inline void interleave_stereo(float* interleaved, const float* left, const float* right, int samples)
+{
+    int i = 0;
+    [[maybe_unused]] int vector_samples = samples - samples % 4;
+#if defined(SUSHI_KERNELS_SSE) || defined(SUSHI_KERNELS_AVX)
+    for (; i < vector_samples; i += 4)
+    {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(interleaved + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(interleaved + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+#elif defined(SUSHI_KERNELS_NEON)
+    for (; i < vector_samples; i += 4)
+    {
+        float32x4x2_t channels = {vld1q_f32(left + i), vld1q_f32(right + i)};
+        vst2q_f32(interleaved + 2 * i, channels);
+    }
+#endif
+    for (; i < samples; ++i)
+    {
+        interleaved[2 * i] = left[i];
+        interleaved[2 * i + 1] = right[i];
+    }
+}
+
+} // namespace kernels
+} // namespace sushi
+
+#endif //SUSHI_SAMPLE_BUFFER_KERNELS_H
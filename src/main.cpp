@@ -33,6 +33,7 @@
 #include "engine/json_configurator.h"
 #include "control_frontends/osc_frontend.h"
 #include "control_frontends/alsa_midi_frontend.h"
+#include "control_frontends/alsa_rawmidi_frontend.h"
 #include "library/parameter_dump.h"
 #include "compile_time_settings.h"
 
@@ -147,9 +148,12 @@ int main(int argc, char* argv[])
     bool debug_mode_switches = false;
     int  rt_cpu_cores = 1;
     bool enable_timings = false;
+    std::string deadline_miss_file;
     bool enable_flush_interval = false;
     bool enable_parameter_dump = false;
     std::chrono::seconds log_flush_interval = std::chrono::seconds(0);
+    int parameter_notification_rate = 0;
+    std::vector<std::string> rawmidi_devices;
 
     for (int i = 0; i<cl_parser.optionsCount(); i++)
     {
@@ -238,6 +242,11 @@ int main(int argc, char* argv[])
             enable_timings = true;
             break;
 
+        case OPT_IDX_DEADLINE_MISS_LOG:
+            enable_timings = true;
+            deadline_miss_file = opt.arg;
+            break;
+
         case OPT_IDX_OSC_RECEIVE_PORT:
             osc_server_port = atoi(opt.arg);
             break;
@@ -250,12 +259,25 @@ int main(int argc, char* argv[])
             grpc_listening_address = opt.arg;
             break;
 
+        case OPT_IDX_PARAMETER_NOTIFICATION_RATE:
+            parameter_notification_rate = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_RAWMIDI_DEVICE:
+            rawmidi_devices.emplace_back(opt.arg);
+            break;
+
         default:
             SushiArg::print_error("Unhandled option '", opt, "' \n");
             break;
         }
     }
 
+    if (rawmidi_devices.empty() == false && frontend_type != FrontendType::JACK && frontend_type != FrontendType::XENOMAI_RASPA)
+    {
+        error_exit("Rawmidi devices can only be used with the Jack and Xenomai frontends");
+    }
+
     if (enable_parameter_dump == false)
     {
         print_sushi_headline();
@@ -291,7 +313,7 @@ int main(int argc, char* argv[])
     }
     auto engine = std::make_unique<sushi::engine::AudioEngine>(CompileTimeSettings::sample_rate_default, rt_cpu_cores);
     auto event_dispatcher = engine->event_dispatcher();
-    auto midi_dispatcher = std::make_unique<sushi::midi_dispatcher::MidiDispatcher>(engine->event_dispatcher());
+    auto midi_dispatcher = std::make_unique<sushi::midi_dispatcher::MidiDispatcher>(engine->event_dispatcher(), engine.get());
     auto configurator = std::make_unique<sushi::jsonconfig::JsonConfigurator>(engine.get(),
                                                                               midi_dispatcher.get(),
                                                                               engine->processor_container(),
@@ -429,6 +451,12 @@ int main(int argc, char* argv[])
     // Set up Controller and Control Frontends //
     ////////////////////////////////////////////////////////////////////////////////
     auto controller = std::make_unique<sushi::engine::Controller>(engine.get(), midi_dispatcher.get());
+    sushi::Time parameter_notification_interval = sushi::IMMEDIATE_PROCESS;
+    if (parameter_notification_rate > 0)
+    {
+        parameter_notification_interval = std::chrono::microseconds(1'000'000 / parameter_notification_rate);
+        controller->set_parameter_notification_interval(parameter_notification_interval);
+    }
 
     if (enable_parameter_dump)
     {
@@ -438,7 +466,17 @@ int main(int argc, char* argv[])
 
     if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::XENOMAI_RASPA)
     {
-        midi_frontend = std::make_unique<sushi::midi_frontend::AlsaMidiFrontend>(midi_inputs, midi_outputs, midi_dispatcher.get());
+        if (rawmidi_devices.empty())
+        {
+            midi_frontend = std::make_unique<sushi::midi_frontend::AlsaMidiFrontend>(midi_inputs, midi_outputs, midi_dispatcher.get());
+        }
+        else
+        {
+            midi_frontend = std::make_unique<sushi::midi_frontend::AlsaRawMidiFrontend>(midi_inputs,
+                                                                                       midi_outputs,
+                                                                                       rawmidi_devices,
+                                                                                       midi_dispatcher.get());
+        }
         osc_frontend = std::make_unique<sushi::control_frontend::OSCFrontend>(engine.get(),
                                                                               controller.get(),
                                                                               osc_server_port,
@@ -451,6 +489,7 @@ int main(int argc, char* argv[])
         {
             error_exit("Failed to setup OSC frontend");
         }
+        event_dispatcher->set_parameter_notification_interval(osc_frontend.get(), parameter_notification_interval);
 
         status = configurator->load_osc();
         if (status != sushi::jsonconfig::JsonConfigReturnStatus::OK && status != sushi::jsonconfig::JsonConfigReturnStatus::NO_OSC_DEFINITIONS)
@@ -483,6 +522,7 @@ int main(int argc, char* argv[])
     if (enable_timings)
     {
         engine->performance_timer()->enable(true);
+        engine->enable_deadline_miss_recording(deadline_miss_file.empty() == false, deadline_miss_file);
     }
 
     audio_frontend->run();
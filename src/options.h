@@ -119,9 +119,12 @@ enum OptionIndex
     OPT_IDX_XENOMAI_DEBUG_MODE_SW,
     OPT_IDX_MULTICORE_PROCESSING,
     OPT_IDX_TIMINGS_STATISTICS,
+    OPT_IDX_DEADLINE_MISS_LOG,
     OPT_IDX_OSC_RECEIVE_PORT,
     OPT_IDX_OSC_SEND_PORT,
-    OPT_IDX_GRPC_LISTEN_ADDRESS
+    OPT_IDX_GRPC_LISTEN_ADDRESS,
+    OPT_IDX_PARAMETER_NOTIFICATION_RATE,
+    OPT_IDX_RAWMIDI_DEVICE
 };
 
 // Option types (UNUSED is generally used for options that take a value as argument)
@@ -295,6 +298,14 @@ const optionparser::Descriptor usage[] =
         SushiArg::Optional,
         "\t\t--timing-statistics \tEnable performance timings on all audio processors."
     },
+    {
+        OPT_IDX_DEADLINE_MISS_LOG,
+        OPT_TYPE_UNUSED,
+        "",
+        "deadline-miss-log",
+        SushiArg::NonEmpty,
+        "\t\t--deadline-miss-log=<file> \tAppend the processing history of chunks where the engine misses its deadline to <file>. Enables timing statistics."
+    },
     {
         OPT_IDX_OSC_RECEIVE_PORT,
         OPT_TYPE_UNUSED,
@@ -319,6 +330,22 @@ const optionparser::Descriptor usage[] =
         SushiArg::NonEmpty,
         "\t\t--grpc-address=<port> \tgRPC listening address in the format: address:port. By default accepts incoming connections from all ip:s [default port=" SUSHI_GRPC_LISTENING_PORT "]."
     },
+    {
+        OPT_IDX_PARAMETER_NOTIFICATION_RATE,
+        OPT_TYPE_UNUSED,
+        "",
+        "parameter-notification-rate",
+        SushiArg::Numeric,
+        "\t\t--parameter-notification-rate=<hz> \tMaximum rate of parameter change notifications to OSC and gRPC clients. Only the latest value of each parameter is sent [default=no limit]."
+    },
+    {
+        OPT_IDX_RAWMIDI_DEVICE,
+        OPT_TYPE_UNUSED,
+        "",
+        "rawmidi-device",
+        SushiArg::NonEmpty,
+        "\t\t--rawmidi-device=<device> \tRead and write midi directly from an Alsa rawmidi device, i.e. 'hw:1,0,0', instead of using the Alsa sequencer. Repeat to use several devices, the nth device is used for midi input and output n. 'virtual' creates a virtual device. Only available with the Jack and Xenomai frontends."
+    },
     // Don't touch this one (set default values for optionparse library)
     { 0, 0, 0, 0, 0, 0}
 };
@@ -57,11 +57,7 @@ ProcessorReturnCode EqualizerPlugin::init(float sample_rate)
 {
     _sample_rate = sample_rate;
 
-    for (auto& f : _filters)
-    {
-        f.set_smoothing(AUDIO_CHUNK_SIZE);
-        f.reset();
-    }
+    _filter.reset();
 
     return ProcessorReturnCode::OK;
 }
@@ -94,11 +90,17 @@ void EqualizerPlugin::process_audio(const ChunkSampleBuffer &in_buffer, ChunkSam
          * predictable cpu load for every chunk */
         dsp::biquad::Coefficients coefficients;
         dsp::biquad::calc_biquad_peak(coefficients, _sample_rate, frequency, q, gain);
+        _filter.set_coefficients(coefficients);
+
+        /* All channels are filtered in parallel, changes are interpolated over the chunk */
+        const float* inputs[MAX_CHANNELS_SUPPORTED];
+        float* outputs[MAX_CHANNELS_SUPPORTED];
         for (int i = 0; i < _current_input_channels; ++i)
         {
-            _filters[i].set_coefficients(coefficients);
-            _filters[i].process(in_buffer.channel(i), out_buffer.channel(i), AUDIO_CHUNK_SIZE);
+            inputs[i] = in_buffer.channel(i);
+            outputs[i] = out_buffer.channel(i);
         }
+        _filter.process(inputs, outputs, _current_input_channels, AUDIO_CHUNK_SIZE);
     }
     else
     {
@@ -22,12 +22,12 @@
 #define EQUALIZER_PLUGIN_H
 
 #include "library/internal_plugin.h"
-#include "dsp_library/biquad_filter.h"
+#include "dsp_library/multichannel_biquad_filter.h"
 
 namespace sushi {
 namespace equalizer_plugin {
 
-constexpr int MAX_CHANNELS_SUPPORTED = 2;
+constexpr int MAX_CHANNELS_SUPPORTED = 8;
 
 class EqualizerPlugin : public InternalPlugin
 {
@@ -46,7 +46,7 @@ public:
 
 private:
     float _sample_rate;
-    dsp::biquad::BiquadFilter _filters[MAX_CHANNELS_SUPPORTED];
+    dsp::biquad::MultiChannelBiquadFilter<MAX_CHANNELS_SUPPORTED> _filter;
 
     FloatParameterValue* _frequency;
     FloatParameterValue* _gain;
@@ -0,0 +1,127 @@
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "control_frontends/alsa_rawmidi_frontend.cpp"
+#undef private
+#include "engine/midi_receiver.h"
+
+using namespace sushi;
+using namespace sushi::midi_frontend;
+
+class MidiReceiverMockup : public midi_receiver::MidiReceiver
+{
+public:
+    struct Message
+    {
+        int port;
+        MidiDataByte data;
+        Time timestamp;
+    };
+
+    void send_midi(int port, MidiDataByte data, Time timestamp) override
+    {
+        messages.push_back({port, data, timestamp});
+    }
+
+    std::vector<Message> messages;
+};
+
+class TestAlsaRawMidiFrontend : public ::testing::Test
+{
+protected:
+    TestAlsaRawMidiFrontend() {}
+
+    void SetUp()
+    {
+        /* The virtual device needs the Alsa sequencer, which is not available everywhere */
+        if (_module_under_test.init() == false)
+        {
+            GTEST_SKIP() << "Alsa sequencer not available, skipping rawmidi tests";
+        }
+    }
+
+    void TearDown()
+    {
+        _module_under_test.stop();
+    }
+
+    MidiReceiverMockup _receiver;
+    AlsaRawMidiFrontend _module_under_test{1, 1, {"virtual"}, &_receiver};
+};
+
+TEST_F(TestAlsaRawMidiFrontend, TestOpenVirtualDevice)
+{
+    EXPECT_EQ(1u, _module_under_test._input_devices.size());
+    EXPECT_EQ(1u, _module_under_test._output_devices.size());
+    EXPECT_EQ(1u, _module_under_test._output_buffers.size());
+
+    _module_under_test.run();
+    EXPECT_TRUE(_module_under_test._worker.joinable());
+    _module_under_test.stop();
+    EXPECT_FALSE(_module_under_test._worker.joinable());
+}
+
+TEST_F(TestAlsaRawMidiFrontend, TestFailedInputDevice)
+{
+    /* Closing the descriptors of the device under the running reader makes poll return
+     * POLLNVAL for them on every call, as for a device that failed */
+    auto handle = _module_under_test._input_devices[0].handle;
+    std::vector<pollfd> descriptors(snd_rawmidi_poll_descriptors_count(handle));
+    snd_rawmidi_poll_descriptors(handle, descriptors.data(), descriptors.size());
+    _module_under_test.run();
+    for (const auto& descriptor : descriptors)
+    {
+        close(descriptor.fd);
+    }
+
+    /* The device should be dropped, and with no inputs left, the thread should end
+     * instead of spinning */
+    for (int i = 0; i < 100 && _module_under_test._running; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_FALSE(_module_under_test._running);
+}
+
+TEST_F(TestAlsaRawMidiFrontend, TestParseAndDispatch)
+{
+    Time timestamp = std::chrono::milliseconds(5);
+
+    /* A note on split over two reads, followed by a note using running status */
+    const uint8_t first_read[] = {0x91, 62};
+    const uint8_t second_read[] = {55, 64, 0};
+    _module_under_test._parse_input(0, first_read, sizeof(first_read), timestamp);
+    EXPECT_TRUE(_receiver.messages.empty());
+    _module_under_test._parse_input(0, second_read, sizeof(second_read), timestamp);
+
+    ASSERT_EQ(2u, _receiver.messages.size());
+    EXPECT_EQ(0, _receiver.messages[0].port);
+    EXPECT_EQ(timestamp, _receiver.messages[0].timestamp);
+    EXPECT_EQ(0x91, _receiver.messages[0].data[0]);
+    EXPECT_EQ(62, _receiver.messages[0].data[1]);
+    EXPECT_EQ(55, _receiver.messages[0].data[2]);
+    EXPECT_EQ(0x91, _receiver.messages[1].data[0]);
+    EXPECT_EQ(64, _receiver.messages[1].data[1]);
+    EXPECT_EQ(0, _receiver.messages[1].data[2]);
+}
+
+TEST_F(TestAlsaRawMidiFrontend, TestWriteOutput)
+{
+    /* Whole messages should be written, and a message for a missing output ignored */
+    MidiDataByte note_on = {0x92, 60, 100, 0};
+    EXPECT_EQ(3, _module_under_test._write_output(0, note_on.data(), 3));
+    _module_under_test.send_midi(0, note_on, IMMEDIATE_PROCESS);
+    _module_under_test.send_midi(1, note_on, IMMEDIATE_PROCESS);
+
+    std::vector<MidiOutputMessage> batch = {{0, {0x92, 60, 100, 0}, IMMEDIATE_PROCESS},
+                                            {0, {0xC2, 5, 0, 0}, IMMEDIATE_PROCESS},
+                                            {3, {0x82, 60, 0, 0}, IMMEDIATE_PROCESS}};
+    _module_under_test.send_midi_batch(batch);
+    const std::vector<uint8_t> expected = {0x92, 60, 100, 0xC2, 5};
+    EXPECT_EQ(expected, _module_under_test._output_buffers[0]);
+}
@@ -87,6 +87,9 @@ TEST_F(TestOSCFrontend, TestAddAndRemoveConnections)
     auto event = AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_CREATED,
                                              processor_id, 0, IMMEDIATE_PROCESS);
     _module_under_test.process(&event);
+    /* New connections are published when the batch of notifications ends */
+    EXPECT_EQ(0u, _module_under_test._published_connections.read()->size());
+    _module_under_test.engine_notification_batch_done();
     lo_send(_address, "/parameter/proc_1/param_1", "f", 0.5f);
     EXPECT_TRUE(wait_for_event());
 
@@ -94,6 +97,7 @@ TEST_F(TestOSCFrontend, TestAddAndRemoveConnections)
                                         processor_id, 0, IMMEDIATE_PROCESS);
 
     _module_under_test.process(&event);
+    _module_under_test.engine_notification_batch_done();
     lo_send(_address, "/parameter/proc_1/param_1", "f", 0.5f);
     EXPECT_FALSE(wait_for_event(2));
 }
@@ -101,6 +105,7 @@ TEST_F(TestOSCFrontend, TestAddAndRemoveConnections)
 TEST_F(TestOSCFrontend, TestSendParameterChange)
 {
     ASSERT_TRUE(_module_under_test._connect_to_parameter("sampler", "volume", 0, 0));
+    _module_under_test._publish_connections();
     lo_send(_address, "/parameter/sampler/volume", "f", 5.0f);
 
     ASSERT_TRUE(wait_for_event());
@@ -109,15 +114,75 @@ TEST_F(TestOSCFrontend, TestSendParameterChange)
     EXPECT_EQ(0, std::stoi(args["parameter id"]));
     EXPECT_FLOAT_EQ(5.0f, std::stof(args["value"]));
 
+    /* Numerical arguments of other types should be converted */
+    lo_send(_address, "/parameter/sampler/volume", "i", 3);
+    ASSERT_TRUE(wait_for_event());
+    args = _controller.parameter_controller_mockup()->get_args_from_last_call();
+    EXPECT_FLOAT_EQ(3.0f, std::stof(args["value"]));
+
+    /* Arguments that can't be converted should not match */
+    lo_send(_address, "/parameter/sampler/volume", "s", "3");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_FALSE(_controller.was_recently_called());
+
     /* Test with a not registered path */
     lo_send(_address, "/parameter/sampler/attack", "f", 5.0f);
     std::this_thread::sleep_for(std::chrono::milliseconds(5));
     ASSERT_FALSE(_controller.was_recently_called());
 }
 
+TEST_F(TestOSCFrontend, TestSendParameterChangePattern)
+{
+    ASSERT_TRUE(_module_under_test._connect_to_parameter("sampler", "volume", 0, 0));
+    ASSERT_TRUE(_module_under_test._connect_to_parameter("sampler", "attack", 0, 1));
+    _module_under_test._publish_connections();
+
+    /* Messages to address patterns should reach every matching connection */
+    lo_send(_address, "/parameter/sampler/*", "f", 0.5f);
+    ASSERT_TRUE(wait_for_event());
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    auto args = _controller.parameter_controller_mockup()->get_args_from_last_call();
+    EXPECT_FLOAT_EQ(0.5f, std::stof(args["value"]));
+
+    lo_send(_address, "/parameter/sampl?r/{volume,release}", "f", 0.25f);
+    ASSERT_TRUE(wait_for_event());
+    args = _controller.parameter_controller_mockup()->get_args_from_last_call();
+    EXPECT_EQ(0, std::stoi(args["parameter id"]));
+    EXPECT_FLOAT_EQ(0.25f, std::stof(args["value"]));
+
+    /* Test with a pattern not matching any path */
+    lo_send(_address, "/parameter/drums/*", "f", 5.0f);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_FALSE(_controller.was_recently_called());
+}
+
+TEST_F(TestOSCFrontend, TestSendParameterChangeBundle)
+{
+    ASSERT_TRUE(_module_under_test._connect_to_parameter("sampler", "volume", 0, 0));
+    ASSERT_TRUE(_module_under_test._connect_to_parameter("sampler", "attack", 0, 1));
+    _module_under_test._publish_connections();
+    lo_bundle bundle = lo_bundle_new(LO_TT_IMMEDIATE);
+    lo_message volume_msg = lo_message_new();
+    lo_message_add_float(volume_msg, 0.25f);
+    lo_bundle_add_message(bundle, "/parameter/sampler/volume", volume_msg);
+    lo_message attack_msg = lo_message_new();
+    lo_message_add_float(attack_msg, 0.5f);
+    lo_bundle_add_message(bundle, "/parameter/sampler/attack", attack_msg);
+    lo_send_bundle(_address, bundle);
+    lo_bundle_free_recursive(bundle);
+
+    /* Both changes should arrive in a single call */
+    ASSERT_TRUE(wait_for_event());
+    auto args = _controller.parameter_controller_mockup()->get_args_from_last_call();
+    EXPECT_EQ(2, std::stoi(args["changes"]));
+    EXPECT_EQ(1, std::stoi(args["parameter id"]));
+    EXPECT_FLOAT_EQ(0.5f, std::stof(args["value"]));
+}
+
 TEST_F(TestOSCFrontend, TestSendPropertyChange)
 {
     ASSERT_TRUE(_module_under_test._connect_to_property("sampler", "sample_file", 0, 0));
+    _module_under_test._publish_connections();
     lo_send(_address, "/property/sampler/sample_file", "s", "Sample file");
 
     ASSERT_TRUE(wait_for_event());
@@ -0,0 +1,152 @@
+#include <array>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "dsp_library/multichannel_biquad_filter.h"
+
+using namespace dsp::biquad;
+
+constexpr int TEST_CHANNELS = 6;
+constexpr int TEST_SAMPLES = 32;
+/* A peak filter at 1 kHz with 6dB gain at 48 kHz */
+constexpr Coefficients TEST_COEFFICIENTS = {1.0230f, -1.9469f, 0.9315f, -1.9469f, 0.9545f};
+
+/* Straightforward single channel implementation to compare against */
+void reference_biquad(const Coefficients& c, DelayRegisters& z, const float* input, float* output, int samples)
+{
+    for (int n = 0; n < samples; ++n)
+    {
+        float x = input[n];
+        float y = c.b0 * x + z.z1;
+        z.z1 = c.b1 * x - c.a1 * y + z.z2;
+        z.z2 = c.b2 * x - c.a2 * y;
+        output[n] = y;
+    }
+}
+
+class TestMultiChannelBiquadFilter : public ::testing::Test
+{
+protected:
+    TestMultiChannelBiquadFilter() {}
+
+    void SetUp()
+    {
+        _module_under_test.set_coefficients(TEST_COEFFICIENTS);
+        _module_under_test.reset();
+        for (int c = 0; c < TEST_CHANNELS; ++c)
+        {
+            _input[c].fill(0.0f);
+            /* Impulses of different amplitude and position in every channel */
+            _input[c][c] = 1.0f / (c + 1);
+            _input_ptrs[c] = _input[c].data();
+            _output_ptrs[c] = _output[c].data();
+        }
+    }
+
+    MultiChannelBiquadFilter<TEST_CHANNELS> _module_under_test;
+    std::array<std::array<float, TEST_SAMPLES>, TEST_CHANNELS> _input;
+    std::array<std::array<float, TEST_SAMPLES>, TEST_CHANNELS> _output;
+    const float* _input_ptrs[TEST_CHANNELS];
+    float* _output_ptrs[TEST_CHANNELS];
+};
+
+TEST_F(TestMultiChannelBiquadFilter, TestStationaryCoefficients)
+{
+    /* Process in 2 chunks to verify that state is kept between calls */
+    _module_under_test.process(_input_ptrs, _output_ptrs, TEST_CHANNELS, TEST_SAMPLES / 2);
+    float* second_half[TEST_CHANNELS];
+    const float* second_half_in[TEST_CHANNELS];
+    for (int c = 0; c < TEST_CHANNELS; ++c)
+    {
+        second_half_in[c] = _input[c].data() + TEST_SAMPLES / 2;
+        second_half[c] = _output[c].data() + TEST_SAMPLES / 2;
+    }
+    _module_under_test.process(second_half_in, second_half, TEST_CHANNELS, TEST_SAMPLES / 2);
+
+    for (int c = 0; c < TEST_CHANNELS; ++c)
+    {
+        std::array<float, TEST_SAMPLES> expected;
+        DelayRegisters z{0.0f, 0.0f};
+        reference_biquad(TEST_COEFFICIENTS, z, _input[c].data(), expected.data(), TEST_SAMPLES);
+        for (int i = 0; i < TEST_SAMPLES; ++i)
+        {
+            ASSERT_NEAR(expected[i], _output[c][i], 1.0e-6f);
+        }
+    }
+}
+
+TEST_F(TestMultiChannelBiquadFilter, TestInPlaceProcessing)
+{
+    auto expected = _input;
+    for (int c = 0; c < TEST_CHANNELS; ++c)
+    {
+        DelayRegisters z{0.0f, 0.0f};
+        reference_biquad(TEST_COEFFICIENTS, z, _input[c].data(), expected[c].data(), TEST_SAMPLES);
+    }
+    float* buffers[TEST_CHANNELS];
+    for (int c = 0; c < TEST_CHANNELS; ++c)
+    {
+        buffers[c] = _input[c].data();
+    }
+    _module_under_test.process(buffers, buffers, TEST_CHANNELS, TEST_SAMPLES);
+
+    for (int c = 0; c < TEST_CHANNELS; ++c)
+    {
+        for (int i = 0; i < TEST_SAMPLES; ++i)
+        {
+            ASSERT_NEAR(expected[c][i], _input[c][i], 1.0e-6f);
+        }
+    }
+}
+
+TEST_F(TestMultiChannelBiquadFilter, TestCoefficientInterpolation)
+{
+    /* Coefficient changes should reach their target after exactly one call */
+    Coefficients passthrough = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    _module_under_test.set_coefficients(passthrough);
+    ASSERT_FALSE(_module_under_test._stationary());
+
+    _module_under_test.process(_input_ptrs, _output_ptrs, TEST_CHANNELS, TEST_SAMPLES);
+    EXPECT_TRUE(_module_under_test._stationary());
+    EXPECT_FLOAT_EQ(1.0f, _module_under_test._coefficients.b0);
+    EXPECT_FLOAT_EQ(0.0f, _module_under_test._coefficients.a2);
+    /* The impulse in channel 0 is hit on the first sample of the ramp */
+    EXPECT_NEAR(TEST_COEFFICIENTS.b0 + (1.0f - TEST_COEFFICIENTS.b0) / TEST_SAMPLES, _output[0][0], 1.0e-6f);
+
+    /* Fewer channels than max should leave the rest untouched */
+    _output[TEST_CHANNELS - 1].fill(2.0f);
+    _module_under_test.process(_input_ptrs, _output_ptrs, TEST_CHANNELS - 1, TEST_SAMPLES);
+    EXPECT_FLOAT_EQ(2.0f, _output[TEST_CHANNELS - 1][0]);
+    EXPECT_FLOAT_EQ(_input[1][1], _output[1][1]);
+}
+
+TEST_F(TestMultiChannelBiquadFilter, TestActiveVectors)
+{
+    /* Only the vectors holding processed channels should be filtered */
+    _module_under_test.process(_input_ptrs, _output_ptrs, 1, TEST_SAMPLES);
+    EXPECT_EQ(1, _module_under_test._active_vectors);
+    for (int v = 1; v < _module_under_test.VECTORS; ++v)
+    {
+        for (int lane = 0; lane < SIMD_LANES; ++lane)
+        {
+            EXPECT_FLOAT_EQ(0.0f, _module_under_test._z1[v][lane]);
+        }
+    }
+
+    /* Vectors taken into use again should start from a cleared state */
+    _module_under_test.process(_input_ptrs, _output_ptrs, TEST_CHANNELS, TEST_SAMPLES);
+    EXPECT_EQ(_module_under_test.VECTORS, _module_under_test._active_vectors);
+    int last_channel = TEST_CHANNELS - 1;
+    if (last_channel >= SIMD_LANES)
+    {
+        std::array<float, TEST_SAMPLES> expected;
+        DelayRegisters z{0.0f, 0.0f};
+        reference_biquad(TEST_COEFFICIENTS, z, _input[last_channel].data(), expected.data(), TEST_SAMPLES);
+        for (int i = 0; i < TEST_SAMPLES; ++i)
+        {
+            ASSERT_NEAR(expected[i], _output[last_channel][i], 1.0e-6f);
+        }
+    }
+}
@@ -65,17 +65,60 @@ TEST_F(TestAudioGraph, TestMultiCoreOperation)
     ASSERT_EQ(1u, _module_under_test->_audio_graph[0].size());
     ASSERT_EQ(1u, _module_under_test->_audio_graph[1].size());
     ASSERT_EQ(0u, _module_under_test->_audio_graph[2].size());
+    EXPECT_EQ(0, _module_under_test->core_of(&_track_1));
+    EXPECT_EQ(1, _module_under_test->core_of(&_track_2));
 
     auto event = RtEvent::make_note_on_event(_track_1.id(), 0, 0, 48, 1.0f);
     _track_1.process_event(event);
     _track_2.process_event(event);
     _module_under_test->render();
 
-    // Test that events were properly passed through
+    // Test that events were properly passed through, tracks can be rendered
+    // by any core so only check the total number of events
     auto queues = _module_under_test->event_outputs();
-    EXPECT_EQ(1, queues[0].size());
-    EXPECT_EQ(1, queues[1].size());
-    EXPECT_EQ(0, queues[2].size());
+    EXPECT_EQ(2, queues[0].size() + queues[1].size() + queues[2].size());
+}
+
+TEST_F(TestAudioGraph, TestWorkStealing)
+{
+    SetUp(2);
+    ASSERT_TRUE(_module_under_test->add_to_core(&_track_1, 0));
+    ASSERT_TRUE(_module_under_test->add_to_core(&_track_2, 0));
+    ASSERT_EQ(0u, _module_under_test->_audio_graph[1].size());
+
+    auto event = RtEvent::make_note_on_event(_track_1.id(), 0, 0, 48, 1.0f);
+    for (int i = 0; i < 10; ++i)
+    {
+        _track_1.process_event(event);
+        _track_2.process_event(event);
+        _module_under_test->render();
+
+        // Every track should be rendered exactly once per cycle, regardless of which core got it
+        for (auto& core_nodes : _module_under_test->_graph_nodes)
+        {
+            for (auto node : core_nodes)
+            {
+                EXPECT_EQ(_module_under_test->_cycle, node->claimed_cycle.load());
+            }
+        }
+        auto& queues = _module_under_test->event_outputs();
+        EXPECT_EQ(2, queues[0].size() + queues[1].size());
+        RtEvent e;
+        for (auto& queue : queues)
+        {
+            while (queue.pop(e)) {}
+        }
+    }
+
+    // Nodes of removed tracks should be reused
+    ASSERT_TRUE(_module_under_test->remove(&_track_1));
+    EXPECT_FALSE(_module_under_test->core_of(&_track_1).has_value());
+    ASSERT_TRUE(_module_under_test->move_to_core(&_track_2, 1));
+    EXPECT_EQ(1, _module_under_test->core_of(&_track_2));
+    ASSERT_TRUE(_module_under_test->add_to_core(&_track_1, 1));
+    _module_under_test->render();
+    EXPECT_EQ(_module_under_test->_cycle, _module_under_test->_graph_nodes[1][0]->claimed_cycle.load());
+    EXPECT_EQ(_module_under_test->_cycle, _module_under_test->_graph_nodes[1][1]->claimed_cycle.load());
 }
 
 TEST_F(TestAudioGraph, TestMaxNumberOfTracks)
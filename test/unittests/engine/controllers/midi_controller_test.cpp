@@ -127,6 +127,7 @@ TEST_F(MidiControllerEventTestFrontend, TestKbdOutputConectionDisconnection)
     /* Send midi message without connections */
     auto status1 = _midi_dispatcher.process(&event_ch3);
     EXPECT_EQ(EventStatus::HANDLED_OK, status1);
+    _midi_dispatcher.keyboard_event_batch_done();
     EXPECT_FALSE(_test_frontend.midi_sent_on_input(0));
 
     auto event_status_connect = _midi_controller.connect_kbd_output_from_track(track_id, channel_3, port);
@@ -136,6 +137,7 @@ TEST_F(MidiControllerEventTestFrontend, TestKbdOutputConectionDisconnection)
 
     auto status2 = _midi_dispatcher.process(&event_ch3);
     EXPECT_EQ(EventStatus::HANDLED_OK, status2);
+    _midi_dispatcher.keyboard_event_batch_done();
     EXPECT_TRUE(_test_frontend.midi_sent_on_input(0));
 
     auto event_status_disconnect =  _midi_controller.disconnect_kbd_output(track_id, channel_3, port);
@@ -145,6 +147,7 @@ TEST_F(MidiControllerEventTestFrontend, TestKbdOutputConectionDisconnection)
 
     auto status3 = _midi_dispatcher.process(&event_ch3);
     EXPECT_EQ(EventStatus::HANDLED_OK, status3);
+    _midi_dispatcher.keyboard_event_batch_done();
     EXPECT_FALSE(_test_frontend.midi_sent_on_input(0));
 }
 
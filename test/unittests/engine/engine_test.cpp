@@ -167,6 +167,61 @@ TEST_F(TestEngine, TestOutputMixing)
     test_utils::assert_buffer_value(2.0f, main_bus, test_utils::DECIBEL_ERROR);
 }
 
+TEST_F(TestEngine, TestDirectAudioRouting)
+{
+    /* A track with all channels connected 1:1 renders directly into the output buffer */
+    auto [status, track_id] = _module_under_test->create_track("direct", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, status);
+    _module_under_test->connect_audio_input_bus(1, 0, track_id);
+    _module_under_test->connect_audio_output_bus(1, 0, track_id);
+
+    /* Two gain plugins, so that the track's internal buffer is used for intermediate data */
+    PluginInfo plugin_info{.uid = "sushi.testing.gain", .path = "", .type = PluginType::INTERNAL};
+    for (auto name : {"gain_1", "gain_2"})
+    {
+        auto [load_status, plugin_id] = _module_under_test->create_processor(plugin_info, name);
+        ASSERT_EQ(EngineReturnStatus::OK, load_status);
+        ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->add_plugin_to_track(plugin_id, track_id));
+    }
+
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(TEST_CHANNEL_COUNT);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(TEST_CHANNEL_COUNT);
+    ControlBuffer control_buffer;
+    test_utils::fill_sample_buffer(in_buffer, 1.0f);
+    test_utils::fill_sample_buffer(out_buffer, 0.5f);
+
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    ASSERT_EQ(1u, _module_under_test->_input_aliases.size());
+    ASSERT_EQ(1u, _module_under_test->_output_aliases.size());
+    EXPECT_TRUE(_module_under_test->_copied_input_connections.empty());
+    EXPECT_TRUE(_module_under_test->_copied_output_connections.empty());
+
+    auto main_bus = SampleBuffer<AUDIO_CHUNK_SIZE>::create_non_owning_buffer(out_buffer, 0, 2);
+    auto second_bus = SampleBuffer<AUDIO_CHUNK_SIZE>::create_non_owning_buffer(out_buffer, 2, 2);
+    test_utils::assert_buffer_value(0.0f, main_bus, test_utils::DECIBEL_ERROR);
+    test_utils::assert_buffer_value(1.0f, second_bus, test_utils::DECIBEL_ERROR);
+    /* The input must never be written to */
+    test_utils::assert_buffer_value(1.0f, in_buffer);
+
+    /* Fanning out the track output to a second bus falls back to copying */
+    _module_under_test->connect_audio_output_bus(0, 0, track_id);
+    test_utils::fill_sample_buffer(out_buffer, 0.5f);
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_EQ(1u, _module_under_test->_input_aliases.size());
+    EXPECT_TRUE(_module_under_test->_output_aliases.empty());
+    test_utils::assert_buffer_value(1.0f, out_buffer, test_utils::DECIBEL_ERROR);
+
+    /* Processing in place, as the offline frontend does, must give the same result */
+    _module_under_test->disconnect_audio_output_channel(0, 0, track_id);
+    _module_under_test->disconnect_audio_output_channel(1, 1, track_id);
+    _module_under_test->process_chunk(&in_buffer, &in_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_EQ(1u, _module_under_test->_output_aliases.size());
+    main_bus = SampleBuffer<AUDIO_CHUNK_SIZE>::create_non_owning_buffer(in_buffer, 0, 2);
+    second_bus = SampleBuffer<AUDIO_CHUNK_SIZE>::create_non_owning_buffer(in_buffer, 2, 2);
+    test_utils::assert_buffer_value(0.0f, main_bus, test_utils::DECIBEL_ERROR);
+    test_utils::assert_buffer_value(1.0f, second_bus, test_utils::DECIBEL_ERROR);
+}
+
 TEST_F(TestEngine, TestCreateEmptyTrack)
 {
     auto [status, track_id] = _module_under_test->create_track("left", 2);
@@ -386,6 +441,248 @@ TEST_F(TestEngine, TestRealtimeConfiguration)
     ASSERT_FALSE(_module_under_test->_realtime_processors[plugin_id]);
 }
 
+TEST_F(TestEngine, TestGraphTransaction)
+{
+    auto faux_rt_thread = [](AudioEngine* e)
+    {
+        SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(2);
+        SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(2);
+        ControlBuffer control_buffer;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        e->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    };
+
+    PluginInfo gain_plugin_info;
+    gain_plugin_info.uid = "sushi.testing.gain";
+    gain_plugin_info.path = "";
+    gain_plugin_info.type = PluginType::INTERNAL;
+
+    // Build a track with a plugin and a connection without running the rt part in between
+    _module_under_test->enable_realtime(true);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->begin_graph_transaction());
+    ASSERT_EQ(EngineReturnStatus::ERROR, _module_under_test->begin_graph_transaction());
+
+    auto [track_status, track_id] = _module_under_test->create_track("main", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, track_status);
+    auto [load_status, plugin_id] = _module_under_test->create_processor(gain_plugin_info, "gain_0_r");
+    ASSERT_EQ(EngineReturnStatus::OK, load_status);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->add_plugin_to_track(plugin_id, track_id));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_audio_input_channel(0, 0, track_id));
+    ASSERT_EQ(EngineReturnStatus::ERROR, _module_under_test->delete_plugin(plugin_id));
+
+    // Nothing should have been sent to the rt part yet
+    EXPECT_FALSE(_module_under_test->_realtime_processors[track_id]);
+    EXPECT_FALSE(_module_under_test->_realtime_processors[plugin_id]);
+    EXPECT_EQ(5u, _module_under_test->_graph_transaction->size());
+
+    // All edits should be applied by a single call to process_chunk()
+    auto rt = std::thread(faux_rt_thread, _module_under_test.get());
+    auto status = _module_under_test->commit_graph_transaction();
+    rt.join();
+    ASSERT_EQ(EngineReturnStatus::OK, status);
+    EXPECT_TRUE(_module_under_test->_realtime_processors[track_id]);
+    EXPECT_TRUE(_module_under_test->_realtime_processors[plugin_id]);
+    ASSERT_EQ(1u, _module_under_test->_audio_graph._audio_graph[0].size());
+    EXPECT_EQ(1u, _module_under_test->_audio_graph._audio_graph[0][0]->_processors.size());
+    EXPECT_EQ(1u, _module_under_test->_audio_in_connections._items_rt.size());
+
+    ASSERT_EQ(EngineReturnStatus::ERROR, _module_under_test->commit_graph_transaction());
+}
+
+TEST_F(TestEngine, TestGraphTransactionRollback)
+{
+    auto faux_rt_thread = [](AudioEngine* e)
+    {
+        SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(2);
+        SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(2);
+        ControlBuffer control_buffer;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        e->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    };
+
+    _module_under_test->enable_realtime(true);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->begin_graph_transaction());
+
+    // Only one thread at a time can have a transaction open
+    std::thread([&]()
+    {
+        EXPECT_EQ(EngineReturnStatus::ERROR, _module_under_test->begin_graph_transaction());
+        EXPECT_EQ(EngineReturnStatus::ERROR, _module_under_test->commit_graph_transaction());
+    }).join();
+
+    auto [track_status, track_id] = _module_under_test->create_track("main", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, track_status);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_audio_input_channel(0, 0, track_id));
+
+    // Add an edit that will fail in the rt thread, all edits should be rolled back
+    bool rolled_back = false;
+    ASSERT_TRUE(_module_under_test->_send_graph_events({RtEvent::make_remove_track_event(ObjectId(12345))},
+                                                       [&]() {rolled_back = true;}));
+
+    auto rt = std::thread(faux_rt_thread, _module_under_test.get());
+    auto status = _module_under_test->commit_graph_transaction();
+    rt.join();
+    ASSERT_EQ(EngineReturnStatus::ERROR, status);
+    EXPECT_TRUE(rolled_back);
+    EXPECT_FALSE(_processors->processor_exists(track_id));
+    EXPECT_FALSE(_module_under_test->_realtime_processors[track_id]);
+    EXPECT_EQ(0u, _module_under_test->_audio_graph._audio_graph[0].size());
+    EXPECT_EQ(0u, _module_under_test->audio_input_connections().size());
+    EXPECT_EQ(0u, _module_under_test->_audio_in_connections._items_rt.size());
+    EXPECT_TRUE(_module_under_test->_event_receiver._receive_list.empty());
+
+    // If the rt thread doesn't respond in time, the events must stay valid until it does
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->begin_graph_transaction());
+    auto [track_2_status, track_2_id] = _module_under_test->create_track("second", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, track_2_status);
+    ASSERT_EQ(EngineReturnStatus::ERROR, _module_under_test->commit_graph_transaction());
+    EXPECT_TRUE(_processors->processor_exists(track_2_id));
+    EXPECT_FALSE(_module_under_test->_realtime_processors[track_2_id]);
+
+    faux_rt_thread(_module_under_test.get());
+    EXPECT_TRUE(_module_under_test->_realtime_processors[track_2_id]);
+    // Receiving the late transaction deletes its events, and its responses are dropped
+    EXPECT_FALSE(_module_under_test->_event_receiver.has_response(EventId(0)));
+    EXPECT_TRUE(_module_under_test->_event_receiver._receive_list.empty());
+    EXPECT_TRUE(_module_under_test->_event_receiver._discarded_ids.empty());
+}
+
+TEST_F(TestEngine, TestGraphTransactionWithFullGraph)
+{
+    auto faux_rt_thread = [](AudioEngine* e)
+    {
+        SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(2);
+        SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(2);
+        ControlBuffer control_buffer;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        e->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    };
+
+    // Fill the graph so that adding another track fails in the rt thread
+    int track_count = 0;
+    while (_module_under_test->create_track("track_" + std::to_string(track_count), 2).first == EngineReturnStatus::OK)
+    {
+        track_count++;
+    }
+    ASSERT_GT(track_count, 0);
+
+    _module_under_test->enable_realtime(true);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->begin_graph_transaction());
+    auto [track_status, track_id] = _module_under_test->create_track("one_too_many", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, track_status);
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_audio_input_channel(0, 0, track_id));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->connect_audio_output_channel(0, 0, track_id));
+
+    auto rt = std::thread(faux_rt_thread, _module_under_test.get());
+    auto status = _module_under_test->commit_graph_transaction();
+    rt.join();
+    ASSERT_EQ(EngineReturnStatus::ERROR, status);
+
+    // Nothing from the transaction should be left in the rt part, as the track is now deleted
+    EXPECT_FALSE(_processors->processor_exists(track_id));
+    EXPECT_FALSE(_module_under_test->_realtime_processors[track_id]);
+    EXPECT_EQ(0u, _module_under_test->_audio_in_connections._items_rt.size());
+    EXPECT_EQ(0u, _module_under_test->_audio_out_connections._items_rt.size());
+    EXPECT_EQ(0u, _module_under_test->audio_input_connections().size());
+    EXPECT_EQ(0u, _module_under_test->audio_output_connections().size());
+    EXPECT_EQ(static_cast<size_t>(track_count), _module_under_test->_audio_graph._audio_graph[0].size());
+
+    // And the engine should still process the remaining tracks
+    faux_rt_thread(_module_under_test.get());
+}
+
+TEST_F(TestEngine, TestRtEventQueueCapacity)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(2);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(2);
+    ControlBuffer control_buffer;
+
+    auto [track_status, track_id] = _module_under_test->create_track("main", 2);
+    ASSERT_EQ(EngineReturnStatus::OK, track_status);
+
+    EXPECT_EQ(EngineReturnStatus::ERROR, _module_under_test->set_rt_event_queue_capacity(0));
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->set_rt_event_queue_capacity(5));
+    auto statistics = _module_under_test->rt_event_queue_statistics();
+    EXPECT_EQ(8, statistics.input_capacity);
+
+    // Fill the queue, the last event should be counted as dropped
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_EQ(EngineReturnStatus::OK, _module_under_test->send_rt_event(RtEvent::make_note_on_event(track_id, 0, 0, 48, 1.0f)));
+    }
+    EXPECT_EQ(EngineReturnStatus::QUEUE_FULL, _module_under_test->send_rt_event(RtEvent::make_note_on_event(track_id, 0, 0, 48, 1.0f)));
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    statistics = _module_under_test->rt_event_queue_statistics();
+    EXPECT_EQ(1, statistics.input_overflows);
+    EXPECT_EQ(8, statistics.input_high_water_mark);
+    EXPECT_EQ(0, statistics.input_deferrals);
+
+    // Events exceeding what can be passed on in one chunk should be left for the next chunk
+    int event_count = MAX_RT_EVENTS_PER_CHUNK + 10;
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->set_rt_event_queue_capacity(2 * MAX_RT_EVENTS_PER_CHUNK));
+    for (int i = 0; i < event_count; ++i)
+    {
+        ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->send_rt_event(RtEvent::make_note_on_event(track_id, 0, 0, 48, 1.0f)));
+    }
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    statistics = _module_under_test->rt_event_queue_statistics();
+    EXPECT_EQ(1, statistics.input_deferrals);
+    EXPECT_EQ(0, statistics.input_overflows);
+    EXPECT_EQ(0, statistics.track_overflows);
+    EXPECT_EQ(10, _module_under_test->_main_in_queue.size());
+
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_TRUE(_module_under_test->_main_in_queue.empty());
+    EXPECT_EQ(1, _module_under_test->rt_event_queue_statistics().input_deferrals);
+
+    // Scheduled events that are due share the same limit as the input queue
+    for (int i = 0; i < MAX_RT_EVENTS_PER_CHUNK - 10; ++i)
+    {
+        ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->send_rt_event(RtEvent::make_note_on_event(track_id, 0, 0, 48, 1.0f)));
+    }
+    for (int i = 0; i < 20; ++i)
+    {
+        ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->send_scheduled_rt_event(RtEvent::make_note_on_event(track_id, 0, 0, 48, 1.0f), Time(0)));
+    }
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    statistics = _module_under_test->rt_event_queue_statistics();
+    EXPECT_EQ(2, statistics.input_deferrals);
+    EXPECT_EQ(0, statistics.track_overflows);
+    EXPECT_EQ(10, _module_under_test->_event_scheduler.size());
+
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_TRUE(_module_under_test->_event_scheduler.empty());
+    EXPECT_EQ(2, _module_under_test->rt_event_queue_statistics().input_deferrals);
+}
+
+TEST_F(TestEngine, TestDispatcherSignalling)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(2);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(2);
+    ControlBuffer control_buffer;
+
+    // Only sync events are queued, the dispatcher should not be woken up
+    for (int i = 0; i < 10; ++i)
+    {
+        _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    }
+    EXPECT_EQ(10u, _module_under_test->_unsignaled_chunks);
+
+    // Any other event should wake it up
+    _module_under_test->_main_out_queue.push(RtEvent::make_note_on_event(0, 0, 0, 48, 1.0f));
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_EQ(0u, _module_under_test->_unsignaled_chunks);
+
+    // And so should too many sync events piling up
+    for (uint32_t i = 0; i < MAX_UNSIGNALED_CHUNKS - 1; ++i)
+    {
+        _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    }
+    EXPECT_EQ(MAX_UNSIGNALED_CHUNKS - 1, _module_under_test->_unsignaled_chunks);
+    _module_under_test->process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    EXPECT_EQ(0u, _module_under_test->_unsignaled_chunks);
+}
+
 TEST_F(TestEngine, TestAudioConnections)
 {
     auto faux_rt_thread = [](AudioEngine* e, ChunkSampleBuffer* in, ChunkSampleBuffer* out, ControlBuffer* ctrl)
@@ -548,4 +845,70 @@ TEST_F(TestEngine, TestGateRouting)
     // A gate high event on gate input 1 should result in a gate high on gate output 0
     ASSERT_TRUE(out_controls.gate_values[0]);
     ASSERT_EQ(1u, out_controls.gate_values.count());
-}
\ No newline at end of file
+}
+
+TEST(TestAudioRouting, TestCanAliasTrackChannels)
+{
+    std::vector<AudioConnection> connections = {{2, 0, 10}, {3, 1, 10}, {0, 0, 11}, {0, 1, 12}, {1, 1, 12}};
+
+    /* Contiguous and complete */
+    EXPECT_TRUE(can_alias_track_channels(connections, connections[0], 2, 4, true));
+    /* Not enough engine channels */
+    EXPECT_FALSE(can_alias_track_channels(connections, connections[0], 2, 3, true));
+    /* Only one of 2 channels connected */
+    EXPECT_FALSE(can_alias_track_channels(connections, connections[2], 2, 4, false));
+    EXPECT_TRUE(can_alias_track_channels(connections, connections[2], 1, 4, false));
+    /* Engine channel 0 is shared with track 12, fine for inputs but not outputs */
+    connections.push_back({1, 1, 11});
+    EXPECT_TRUE(can_alias_track_channels(connections, connections[2], 2, 4, false));
+    EXPECT_FALSE(can_alias_track_channels(connections, connections[2], 2, 4, true));
+    /* Fan out from channel 0 of track 10 */
+    connections.push_back({1, 0, 10});
+    EXPECT_FALSE(can_alias_track_channels(connections, connections[0], 2, 4, false));
+}
+
+TEST(TestTrackBalancing, TestBalanceTrackLoads)
+{
+    std::map<ObjectId, float> loads = {{1, 0.4f}, {2, 0.3f}, {3, 0.2f}, {4, 0.1f}};
+    auto assignment = balance_track_loads(loads, 2);
+    ASSERT_EQ(4u, assignment.size());
+    EXPECT_FLOAT_EQ(0.5f, max_core_load(loads, assignment, 2));
+
+    std::map<ObjectId, int> unbalanced = {{1, 0}, {2, 0}, {3, 1}, {4, 1}};
+    EXPECT_FLOAT_EQ(0.7f, max_core_load(loads, unbalanced, 2));
+}
+
+TEST(TestTrackBalancing, TestMoveTracks)
+{
+    AudioEngine engine(SAMPLE_RATE, 2);
+    std::map<ObjectId, float> loads;
+    for (float load : {0.5f, 0.1f, 0.4f})
+    {
+        auto [status, track_id] = engine.create_track("track_" + std::to_string(loads.size()), 2);
+        ASSERT_EQ(EngineReturnStatus::OK, status);
+        engine._process_timer._timings[track_id].timings.avg_case = load;
+        loads[track_id] = load;
+    }
+
+    // All moves should be applied by a single call to process_chunk()
+    engine.enable_realtime(true);
+    auto rt = std::thread([&]()
+    {
+        SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(2);
+        SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(2);
+        ControlBuffer control_buffer;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        engine.process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer, Time(0), 0);
+    });
+    engine._balance_track_loads();
+    rt.join();
+
+    ASSERT_EQ(3u, engine._track_cores.size());
+    EXPECT_FLOAT_EQ(0.5f, max_core_load(loads, engine._track_cores, 2));
+    for (const auto& [track_id, core] : engine._track_cores)
+    {
+        auto track = static_cast<Track*>(engine._realtime_processors[track_id]);
+        EXPECT_EQ(core, engine._audio_graph.core_of(track));
+    }
+    EXPECT_TRUE(engine._event_receiver._receive_list.empty());
+}
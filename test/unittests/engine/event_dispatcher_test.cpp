@@ -39,8 +39,22 @@ public:
         return 100;
     };
 
+    void keyboard_event_batch_done() override
+    {
+        _batches_done++;
+    }
+
+    void engine_notification_batch_done() override
+    {
+        _notification_batches_done++;
+    }
+
     int poster_id() override {return DUMMY_POSTER_ID;}
 
+    int batches_done() const {return _batches_done;}
+
+    int notification_batches_done() const {return _notification_batches_done;}
+
     bool event_received()
     {
         if (_received)
@@ -53,6 +67,8 @@ public:
 
 private:
     bool _received{false};
+    int  _batches_done{0};
+    int  _notification_batches_done{0};
 };
 
 class TestEventDispatcher : public ::testing::Test
@@ -72,7 +88,8 @@ protected:
     {
         _module_under_test = new EventDispatcher(&_test_engine,
                                                  &_in_rt_queue,
-                                                 &_out_rt_queue);
+                                                 &_out_rt_queue,
+                                                 &_scheduled_rt_queue);
     }
 
     void TearDown()
@@ -83,7 +100,8 @@ protected:
     EventDispatcher*    _module_under_test;
     EngineMockup        _test_engine{TEST_SAMPLE_RATE};
     RtSafeRtEventFifo   _in_rt_queue;
-    RtSafeRtEventFifo   _out_rt_queue;
+    RtSafeMpscRtEventFifo _out_rt_queue;
+    RtSafeScheduledRtEventFifo _scheduled_rt_queue;
     DummyPoster         _poster;
 };
 
@@ -154,6 +172,7 @@ TEST_F(TestEventDispatcher, TestFromRtEventNoteOnEvent)
 {
     RtEvent rt_event = RtEvent::make_note_on_event(10, 0, 0, 50, 10.f);
     _in_rt_queue.push(rt_event);
+    _module_under_test->signal_rt_events();
 
     _module_under_test->subscribe_to_keyboard_events(&_poster);
     crank_event_loop_once();
@@ -161,10 +180,23 @@ TEST_F(TestEventDispatcher, TestFromRtEventNoteOnEvent)
     ASSERT_TRUE(_poster.event_received());
 }
 
+TEST_F(TestEventDispatcher, TestKeyboardEventBatch)
+{
+    _module_under_test->subscribe_to_keyboard_events(&_poster);
+    _in_rt_queue.push(RtEvent::make_note_on_event(10, 0, 0, 50, 1.0f));
+    _in_rt_queue.push(RtEvent::make_note_off_event(10, 8, 0, 50, 1.0f));
+    _in_rt_queue.push(RtEvent::make_synchronisation_event(std::chrono::seconds(1)));
+    crank_event_loop_once();
+
+    ASSERT_TRUE(_poster.event_received());
+    EXPECT_EQ(1, _poster.batches_done());
+}
+
 TEST_F(TestEventDispatcher, TestFromRtEventParameterChangeNotification)
 {
     RtEvent rt_event = RtEvent::make_parameter_change_event(10, 0, 10, 5.f);
     _in_rt_queue.push(rt_event);
+    _module_under_test->signal_rt_events();
 
     _module_under_test->subscribe_to_parameter_change_notifications(&_poster);
     crank_event_loop_once();
@@ -172,16 +204,70 @@ TEST_F(TestEventDispatcher, TestFromRtEventParameterChangeNotification)
     ASSERT_TRUE(_poster.event_received());
 }
 
+TEST_F(TestEventDispatcher, TestRateLimitedParameterNotifications)
+{
+    class NotificationRecorder : public EventPoster
+    {
+    public:
+        int process(Event* event) override
+        {
+            auto typed_event = static_cast<ParameterChangeNotificationEvent*>(event);
+            values.push_back({typed_event->parameter_id(), typed_event->float_value()});
+            return EventStatus::HANDLED_OK;
+        }
+        int poster_id() override {return DUMMY_POSTER_ID;}
+        std::vector<std::pair<ObjectId, float>> values;
+    } recorder;
+
+    ASSERT_EQ(EventDispatcherStatus::UNKNOWN_POSTER,
+              _module_under_test->set_parameter_notification_interval(&recorder, std::chrono::seconds(10)));
+    _module_under_test->subscribe_to_parameter_change_notifications(&recorder);
+    ASSERT_EQ(EventDispatcherStatus::OK,
+              _module_under_test->set_parameter_notification_interval(&recorder, std::chrono::seconds(10)));
+
+    /* Only the latest value of each parameter should be delivered */
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 1, 0.1f));
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 2, 0.2f));
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 1, 0.3f));
+    crank_event_loop_once();
+    ASSERT_EQ(2u, recorder.values.size());
+    EXPECT_EQ(1u, recorder.values[0].first);
+    EXPECT_FLOAT_EQ(0.3f, recorder.values[0].second);
+    EXPECT_EQ(2u, recorder.values[1].first);
+    EXPECT_FLOAT_EQ(0.2f, recorder.values[1].second);
+
+    /* Further notifications are held back until the interval has passed */
+    recorder.values.clear();
+    _in_rt_queue.push(RtEvent::make_parameter_change_event(10, 0, 1, 0.4f));
+    crank_event_loop_once();
+    EXPECT_TRUE(recorder.values.empty());
+    EXPECT_EQ(1u, _module_under_test->_parameter_change_listeners[0].pending.size());
+
+    _module_under_test->set_parameter_notification_interval(&recorder, Time(0));
+    _module_under_test->_parameter_change_listeners[0].last_delivery = Time(0);
+    crank_event_loop_once();
+    ASSERT_EQ(1u, recorder.values.size());
+    EXPECT_FLOAT_EQ(0.4f, recorder.values[0].second);
+    _module_under_test->unsubscribe_from_parameter_change_notifications(&recorder);
+}
+
 TEST_F(TestEventDispatcher, TestEngineNotificationForwarding)
 {
     auto event = new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_ADDED_TO_TRACK,
                                                  123, 234, IMMEDIATE_PROCESS);
     _module_under_test->post_event(event);
+    event = new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::PROCESSOR_ADDED_TO_TRACK,
+                                            124, 234, IMMEDIATE_PROCESS);
+    _module_under_test->post_event(event);
 
     _module_under_test->subscribe_to_engine_notifications(&_poster);
     crank_event_loop_once();
 
     ASSERT_TRUE(_poster.event_received());
+    /* Notifications received in the same pass should be ended as one batch */
+    EXPECT_EQ(1, _poster.notification_batches_done());
+    crank_event_loop_once();
+    EXPECT_EQ(1, _poster.notification_batches_done());
 }
 
 
@@ -207,6 +293,7 @@ TEST_F(TestEventDispatcher, TestAsyncCallbackFromProcessor)
     auto rt_event = RtEvent::make_async_work_event(dummy_processor_callback, 123, nullptr);
     EventId sending_ev_id = rt_event.async_work_event()->event_id();
     _in_rt_queue.push(rt_event);
+    _module_under_test->signal_rt_events();
 
     /* Run the process loop once to convert from RtEvent and send the event to the worker,
      * then run the workers process loop once to execute the event, finally run the
@@ -226,6 +313,72 @@ TEST_F(TestEventDispatcher, TestAsyncCallbackFromProcessor)
     EXPECT_EQ(123u, typed_event->processor_id());
 }
 
+TEST_F(TestEventDispatcher, TestParameterChangeBatch)
+{
+    std::vector<ParameterChangeBatchEvent::ParameterChange> changes = {{1, 2, 0.25f}, {1, 3, 0.5f}, {4, 2, 0.75f}};
+    _module_under_test->post_event(new ParameterChangeBatchEvent(changes, IMMEDIATE_PROCESS));
+    crank_event_loop_once();
+
+    for (const auto& change : changes)
+    {
+        RtEvent rt_event;
+        ASSERT_TRUE(_out_rt_queue.pop(rt_event));
+        ASSERT_EQ(RtEventType::FLOAT_PARAMETER_CHANGE, rt_event.type());
+        auto typed_event = rt_event.parameter_change_event();
+        EXPECT_EQ(change.processor_id, typed_event->processor_id());
+        EXPECT_EQ(change.parameter_id, typed_event->param_id());
+        EXPECT_FLOAT_EQ(change.value, typed_event->value());
+    }
+    EXPECT_TRUE(_out_rt_queue.empty());
+}
+
+TEST_F(TestEventDispatcher, TestScheduledEvent)
+{
+    Time now = std::chrono::seconds(1);
+    Time timestamp = now + std::chrono::milliseconds(100);
+    _module_under_test->set_time(now);
+    _module_under_test->post_event(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                                            1, 2, 0.5f, timestamp));
+    crank_event_loop_once();
+
+    /* The event should be handed over to the engine's scheduler instead of waiting */
+    EXPECT_TRUE(_out_rt_queue.empty());
+    EXPECT_TRUE(_module_under_test->_waiting_list.empty());
+    ScheduledRtEvent scheduled_event;
+    ASSERT_TRUE(_scheduled_rt_queue.pop(scheduled_event));
+    EXPECT_EQ(timestamp, scheduled_event.time);
+    ASSERT_EQ(RtEventType::FLOAT_PARAMETER_CHANGE, scheduled_event.event.type());
+    EXPECT_EQ(1u, scheduled_event.event.processor_id());
+    EXPECT_FLOAT_EQ(0.5f, scheduled_event.event.parameter_change_event()->value());
+}
+
+TEST_F(TestEventDispatcher, TestEventOutsideSchedulingHorizon)
+{
+    Time now = std::chrono::seconds(1);
+    Time timestamp = now + RT_SCHEDULING_HORIZON + std::chrono::seconds(1);
+    _module_under_test->set_time(now);
+    _module_under_test->post_event(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                                            1, 2, 0.5f, timestamp));
+    _in_rt_queue.push(RtEvent::make_note_on_event(10, 0, 0, 50, 10.f));
+    _module_under_test->subscribe_to_keyboard_events(&_poster);
+
+    /* The event should stay in the dispatcher without blocking the rest of the loop */
+    crank_event_loop_once();
+    EXPECT_EQ(1u, _module_under_test->_waiting_list.size());
+    EXPECT_TRUE(_scheduled_rt_queue.empty());
+    EXPECT_TRUE(_out_rt_queue.empty());
+    EXPECT_TRUE(_in_rt_queue.empty());
+    EXPECT_TRUE(_poster.event_received());
+
+    /* And be handed over to the engine's scheduler once within the horizon */
+    _module_under_test->set_time(timestamp - std::chrono::milliseconds(100));
+    crank_event_loop_once();
+    EXPECT_TRUE(_module_under_test->_waiting_list.empty());
+    ScheduledRtEvent scheduled_event;
+    ASSERT_TRUE(_scheduled_rt_queue.pop(scheduled_event));
+    EXPECT_EQ(timestamp, scheduled_event.time);
+}
+
 class TestWorker : public ::testing::Test
 {
 public:
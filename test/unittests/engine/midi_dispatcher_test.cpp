@@ -1,8 +1,7 @@
 #include "gtest/gtest.h"
 
-#include "test_utils/engine_mockup.h"
-
 #define private public
+#include "test_utils/engine_mockup.h"
 #include "engine/midi_dispatcher.cpp"
 
 using namespace midi;
@@ -23,78 +22,61 @@ TEST(TestMidiDispatcherEventCreation, TestMakeNoteOnEvent)
 {
     InputConnection connection = {25, 26, 0, 1, false, 64};
     NoteOnMessage message = {1, 46, 64};
-    Event* event = make_note_on_event(connection, message, IMMEDIATE_PROCESS);
-    EXPECT_TRUE(event->is_keyboard_event());
-    EXPECT_EQ(IMMEDIATE_PROCESS, event->time());
-    auto typed_event = static_cast<KeyboardEvent*>(event);
-    EXPECT_EQ(KeyboardEvent::Subtype::NOTE_ON, typed_event->subtype());
+    RtEvent event = make_note_on_event(connection, message);
+    EXPECT_EQ(RtEventType::NOTE_ON, event.type());
+    EXPECT_EQ(0, event.sample_offset());
+    auto typed_event = event.keyboard_event();
     EXPECT_EQ(25u, typed_event->processor_id());
     EXPECT_EQ(1, typed_event->channel());
     EXPECT_EQ(46, typed_event->note());
     EXPECT_NEAR(0.5, typed_event->velocity(), 0.05);
-    delete event;
 }
 
 TEST(TestMidiDispatcherEventCreation, TestMakeNoteOnWithZeroVelEvent)
 {
     InputConnection connection = {25, 26, 0, 1, false, 64};
     NoteOnMessage message = {1, 60, 0};
-    Event* event = make_note_on_event(connection, message, IMMEDIATE_PROCESS);
-    EXPECT_TRUE(event->is_keyboard_event());
-    EXPECT_EQ(IMMEDIATE_PROCESS, event->time());
-    auto typed_event = static_cast<KeyboardEvent*>(event);
-    EXPECT_EQ(KeyboardEvent::Subtype::NOTE_OFF, typed_event->subtype());
+    RtEvent event = make_note_on_event(connection, message);
+    EXPECT_EQ(RtEventType::NOTE_OFF, event.type());
+    auto typed_event = event.keyboard_event();
     EXPECT_EQ(25u, typed_event->processor_id());
     EXPECT_EQ(1, typed_event->channel());
     EXPECT_EQ(60, typed_event->note());
     EXPECT_NEAR(0.5, typed_event->velocity(), 0.05);
-    delete event;
 }
 
 TEST(TestMidiDispatcherEventCreation, TestMakeNoteOffEvent)
 {
     InputConnection connection = {25, 26, 0, 1, false, 64};
     NoteOffMessage message = {2, 46, 64};
-    Event* event = make_note_off_event(connection, message, IMMEDIATE_PROCESS);
-    EXPECT_TRUE(event->is_keyboard_event());
-    EXPECT_EQ(IMMEDIATE_PROCESS, event->time());
-    auto typed_event = static_cast<KeyboardEvent*>(event);
-    EXPECT_EQ(KeyboardEvent::Subtype::NOTE_OFF, typed_event->subtype());
+    RtEvent event = make_note_off_event(connection, message);
+    EXPECT_EQ(RtEventType::NOTE_OFF, event.type());
+    auto typed_event = event.keyboard_event();
     EXPECT_EQ(25u, typed_event->processor_id());
     EXPECT_EQ(2, typed_event->channel());
     EXPECT_EQ(46, typed_event->note());
     EXPECT_NEAR(0.5, typed_event->velocity(), 0.05);
-    delete event;
 }
 
 TEST(TestMidiDispatcherEventCreation, TestMakeWrappedMidiEvent)
 {
     InputConnection connection = {25, 26, 0, 1, false, 64};
     uint8_t message[] = {3, 46, 64};
-    Event* event = make_wrapped_midi_event(connection, message, sizeof(message), IMMEDIATE_PROCESS);
-    EXPECT_TRUE(event->is_keyboard_event());
-    EXPECT_EQ(IMMEDIATE_PROCESS, event->time());
-    auto typed_event = static_cast<KeyboardEvent*>(event);
-    EXPECT_EQ(KeyboardEvent::Subtype::WRAPPED_MIDI, typed_event->subtype());
+    RtEvent event = make_wrapped_midi_event(connection, message, sizeof(message));
+    EXPECT_EQ(RtEventType::WRAPPED_MIDI_EVENT, event.type());
+    auto typed_event = event.wrapped_midi_event();
     EXPECT_EQ(25u, typed_event->processor_id());
     EXPECT_EQ(3u, typed_event->midi_data()[0]);
     EXPECT_EQ(46u, typed_event->midi_data()[1]);
     EXPECT_EQ(64u, typed_event->midi_data()[2]);
     EXPECT_EQ(0u, typed_event->midi_data()[3]);
-    delete event;
 }
 
-TEST(TestMidiDispatcherEventCreation, TestMakeParameterChangeEvent)
+TEST(TestMidiDispatcherEventCreation, TestCCToParameterValue)
 {
     InputConnection connection = {25, 26, 0, 1, false, 64};
     ControlChangeMessage message = {1, 50, 32};
-    Event* event = make_param_change_event(connection, message, IMMEDIATE_PROCESS);
-    EXPECT_EQ(IMMEDIATE_PROCESS, event->time());
-    auto typed_event = static_cast<ParameterChangeEvent*>(event);
-    EXPECT_EQ(25u, typed_event->processor_id());
-    EXPECT_EQ(26u, typed_event->parameter_id());
-    EXPECT_NEAR(0.25, typed_event->float_value(), 0.01);
-    delete event;
+    EXPECT_NEAR(0.25, cc_to_parameter_value(connection, message), 0.01);
 }
 
 TEST(TestMidiDispatcherEventCreation, TestMakeProgramChangeEvent)
@@ -109,6 +91,28 @@ TEST(TestMidiDispatcherEventCreation, TestMakeProgramChangeEvent)
     delete event;
 }
 
+TEST(TestMidiDispatcherRoutingTable, TestConnectionTable)
+{
+    ConnectionTable table;
+    table.add_slot({{1, 0, 0, 1, false, 64}, {2, 0, 0, 1, false, 64}});
+    table.add_slot({});
+    table.add_slot({{3, 0, 0, 1, false, 64}});
+
+    std::vector<ObjectId> targets;
+    for (const auto& c : table.connections(0))
+    {
+        targets.push_back(c.target);
+    }
+    EXPECT_EQ(std::vector<ObjectId>({1, 2}), targets);
+    EXPECT_EQ(table.connections(1).begin(), table.connections(1).end());
+    ASSERT_EQ(1, table.connections(2).end() - table.connections(2).begin());
+    EXPECT_EQ(3u, table.connections(2).begin()->target);
+
+    /* Slots out of range should be empty */
+    EXPECT_EQ(table.connections(3).begin(), table.connections(3).end());
+    EXPECT_EQ(table.connections(-1).begin(), table.connections(-1).end());
+}
+
 class TestMidiDispatcher : public ::testing::Test
 {
 protected:
@@ -187,6 +191,44 @@ TEST_F(TestMidiDispatcher, TestKeyboardDataConnection)
     EXPECT_TRUE(input_connections.size() == 0);
 }
 
+TEST_F(TestMidiDispatcher, TestDirectRtEventPath)
+{
+    MidiDispatcher module_under_test(&_test_dispatcher, &_test_engine);
+    module_under_test.set_midi_inputs(5);
+    auto track = _test_engine.processor_container()->track("track 1");
+    module_under_test.connect_kb_to_track(1, track->id());
+    module_under_test.connect_cc_to_parameter(1, track->id(), 0, 67, 0, 100, false);
+
+    /* Keyboard data should bypass the event dispatcher and keep its timestamp */
+    Time timestamp = std::chrono::milliseconds(10);
+    module_under_test.send_midi(1, TEST_NOTE_ON_CH2, timestamp);
+    EXPECT_FALSE(_test_dispatcher.got_event());
+    ASSERT_TRUE(_test_engine.got_rt_event);
+    EXPECT_EQ(RtEventType::NOTE_ON, _test_engine.last_rt_event.type());
+    EXPECT_EQ(track->id(), _test_engine.last_rt_event.processor_id());
+    EXPECT_EQ(62, _test_engine.last_rt_event.keyboard_event()->note());
+    EXPECT_EQ(timestamp, _test_engine.last_rt_event_time);
+
+    /* Parameter changes take the same path, so they stay in order with keyboard events */
+    _test_engine.scheduled_rt_events.clear();
+    module_under_test.send_midi(1, TEST_CTRL_CH_CH4_67, timestamp);
+    module_under_test.send_midi(1, TEST_NOTE_ON_CH2, timestamp);
+    EXPECT_FALSE(_test_dispatcher.got_event());
+    ASSERT_EQ(2u, _test_engine.scheduled_rt_events.size());
+    auto param_event = _test_engine.scheduled_rt_events[0];
+    ASSERT_EQ(RtEventType::FLOAT_PARAMETER_CHANGE, param_event.type());
+    EXPECT_EQ(track->id(), param_event.processor_id());
+    EXPECT_FLOAT_EQ(75.0f / midi::MAX_VALUE * 100, param_event.parameter_change_event()->value());
+    EXPECT_EQ(RtEventType::NOTE_ON, _test_engine.scheduled_rt_events[1].type());
+
+    /* Program changes need the non-rt worker and go through the dispatcher */
+    _test_engine.scheduled_rt_events.clear();
+    module_under_test.connect_pc_to_processor(1, track->id());
+    module_under_test.send_midi(1, TEST_PRG_CH_CH5, timestamp);
+    EXPECT_TRUE(_test_dispatcher.got_event());
+    EXPECT_TRUE(_test_engine.scheduled_rt_events.empty());
+}
+
 TEST_F(TestMidiDispatcher, TestKeyboardDataOutConnection)
 {
     auto track = _test_engine.processor_container()->track("track 1");
@@ -252,6 +294,26 @@ TEST_F(TestMidiDispatcher, TestKeyboardDataOutConnection)
     EXPECT_TRUE(output_connections.size() == 0);
 }
 
+TEST_F(TestMidiDispatcher, TestKeyboardDataOutBatch)
+{
+    auto track = _test_engine.processor_container()->track("track 1");
+    ObjectId track_id = track->id();
+    _module_under_test.set_midi_outputs(3);
+    ASSERT_EQ(MidiDispatcherStatus::OK, _module_under_test.connect_track_to_output(1, track_id, midi::MidiChannel::CH_5));
+
+    KeyboardEvent note_on(KeyboardEvent::Subtype::NOTE_ON, track_id, 5, 48, 0.5f, IMMEDIATE_PROCESS);
+    KeyboardEvent note_off(KeyboardEvent::Subtype::NOTE_OFF, track_id, 5, 48, 0.5f, IMMEDIATE_PROCESS);
+    EXPECT_EQ(EventStatus::HANDLED_OK, _module_under_test.process(&note_on));
+    EXPECT_EQ(EventStatus::HANDLED_OK, _module_under_test.process(&note_off));
+
+    /* Output should be held back until the end of the batch */
+    EXPECT_FALSE(_test_frontend.midi_sent_on_input(1));
+    EXPECT_EQ(2u, _module_under_test._output_batch.size());
+    _module_under_test.keyboard_event_batch_done();
+    EXPECT_TRUE(_test_frontend.midi_sent_on_input(1));
+    EXPECT_TRUE(_module_under_test._output_batch.empty());
+}
+
 TEST_F(TestMidiDispatcher, TestRawDataConnection)
 {
     auto track_1 = _test_engine.processor_container()->track("track 1");
@@ -393,6 +455,61 @@ TEST_F(TestMidiDispatcher, TestCCDataConnection)
     EXPECT_TRUE(_test_dispatcher.got_event());
 }
 
+TEST_F(TestMidiDispatcher, TestRelativeCCConnection)
+{
+    auto processor = _test_engine.processor_container()->processor("processor");
+    ObjectId processor_id = processor->id();
+    ObjectId parameter_id = processor->parameter_from_name("param 1")->id();
+
+    _module_under_test.set_midi_inputs(5);
+    _module_under_test.connect_cc_to_parameter(1, processor_id, parameter_id, 67, 0, 100, true);
+    auto& virtual_value = *_module_under_test._cc_routes[1][67][midi::MidiChannel::OMNI][0].relative_value;
+    EXPECT_EQ(RELATIVE_CC_START_VALUE, virtual_value.load());
+
+    /* Increment by 3, then decrement by 1 */
+    _module_under_test.send_midi(1, {0xB3, 67, 3, 0}, IMMEDIATE_PROCESS);
+    EXPECT_TRUE(_test_dispatcher.got_event());
+    EXPECT_EQ(67, virtual_value.load());
+    _module_under_test.send_midi(1, {0xB3, 67, 127, 0}, IMMEDIATE_PROCESS);
+    EXPECT_TRUE(_test_dispatcher.got_event());
+    EXPECT_EQ(66, virtual_value.load());
+
+    /* Changing other connections republishes the routing table but should not reset the value */
+    _module_under_test.connect_kb_to_track(1, processor_id);
+    _module_under_test.send_midi(1, {0xB3, 67, 1, 0}, IMMEDIATE_PROCESS);
+    EXPECT_TRUE(_test_dispatcher.got_event());
+    EXPECT_EQ(67, virtual_value.load());
+}
+
+TEST_F(TestMidiDispatcher, TestTwoRelativeCCConnections)
+{
+    auto processor = _test_engine.processor_container()->processor("processor");
+    ObjectId processor_id = processor->id();
+    ObjectId parameter_id = processor->parameter_from_name("param 1")->id();
+
+    _module_under_test.set_midi_inputs(5);
+    _module_under_test.connect_cc_to_parameter(1, processor_id, parameter_id, 67, 0, 100, true);
+    _module_under_test.send_midi(1, {0xB3, 67, 3, 0}, IMMEDIATE_PROCESS);
+    EXPECT_TRUE(_test_dispatcher.got_event());
+
+    /* Adding a second connection on the same cc should not reset the first one */
+    _module_under_test.connect_cc_to_parameter(1, processor_id, parameter_id, 67, 0, 100, true);
+    const auto& connections = _module_under_test._cc_routes[1][67][midi::MidiChannel::OMNI];
+    ASSERT_EQ(2u, connections.size());
+    auto& virtual_value_1 = *connections[0].relative_value;
+    auto& virtual_value_2 = *connections[1].relative_value;
+    EXPECT_EQ(67, virtual_value_1.load());
+    EXPECT_EQ(RELATIVE_CC_START_VALUE, virtual_value_2.load());
+
+    /* Each connection should step its own value exactly once per message */
+    _module_under_test.send_midi(1, {0xB3, 67, 2, 0}, IMMEDIATE_PROCESS);
+    EXPECT_EQ(69, virtual_value_1.load());
+    EXPECT_EQ(66, virtual_value_2.load());
+    _module_under_test.send_midi(1, {0xB3, 67, 127, 0}, IMMEDIATE_PROCESS);
+    EXPECT_EQ(68, virtual_value_1.load());
+    EXPECT_EQ(65, virtual_value_2.load());
+}
+
 TEST_F(TestMidiDispatcher, TestProgramChangeConnection)
 {
     auto processor = _test_engine.processor_container()->processor("processor");
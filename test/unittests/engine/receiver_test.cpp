@@ -1,3 +1,5 @@
+#include <thread>
+
 #include "gtest/gtest.h"
 
 #define private public
@@ -52,4 +54,87 @@ TEST_F(TestAsyncReceiver, TestMultipleEvents)
     // Get the acks in the reverse order to exercise more of the code
     ASSERT_TRUE(_module_under_test.wait_for_response(id2, ZERO_TIMEOUT));
     ASSERT_TRUE(_module_under_test.wait_for_response(id1, ZERO_TIMEOUT));
-}
\ No newline at end of file
+}
+
+TEST_F(TestAsyncReceiver, TestWaitForMultipleResponses)
+{
+    auto event1 = RtEvent::make_insert_processor_event(nullptr);
+    auto event2 = RtEvent::make_add_track_event(123);
+    event1.returnable_event()->set_handled(true);
+    event2.returnable_event()->set_handled(true);
+    EventId id1 = event1.returnable_event()->event_id();
+    EventId id2 = event2.returnable_event()->event_id();
+    _queue.push(event2);
+    ASSERT_FALSE(_module_under_test.wait_for_responses({id1, id2}, ZERO_TIMEOUT));
+
+    /* Responses received before a timeout should not be lost */
+    _queue.push(event1);
+    ASSERT_TRUE(_module_under_test.wait_for_responses({id1, id2}, ZERO_TIMEOUT));
+    EXPECT_TRUE(_module_under_test._receive_list.empty());
+
+    /* A failed event should fail the whole group */
+    auto event3 = RtEvent::make_remove_track_event(123);
+    event3.returnable_event()->set_handled(false);
+    EventId id3 = event3.returnable_event()->event_id();
+    _queue.push(event2);
+    _queue.push(event3);
+    ASSERT_FALSE(_module_under_test.wait_for_responses({id2, id3}, ZERO_TIMEOUT));
+    EXPECT_TRUE(_module_under_test._receive_list.empty());
+}
+
+TEST_F(TestAsyncReceiver, TestDiscardResponses)
+{
+    auto event1 = RtEvent::make_insert_processor_event(nullptr);
+    auto event2 = RtEvent::make_add_track_event(123);
+    event1.returnable_event()->set_handled(true);
+    event2.returnable_event()->set_handled(true);
+    EventId id1 = event1.returnable_event()->event_id();
+    EventId id2 = event2.returnable_event()->event_id();
+    _queue.push(event1);
+    ASSERT_FALSE(_module_under_test.wait_for_responses({id1, id2}, ZERO_TIMEOUT, true));
+    EXPECT_TRUE(_module_under_test._receive_list.empty());
+
+    /* Responses arriving after giving up should be dropped */
+    _queue.push(event2);
+    EXPECT_FALSE(_module_under_test.has_response(id2));
+    EXPECT_TRUE(_module_under_test._receive_list.empty());
+    EXPECT_TRUE(_module_under_test._discarded_ids.empty());
+}
+
+TEST_F(TestAsyncReceiver, TestGraphTransaction)
+{
+    auto graph_events = new std::vector<RtEvent>({RtEvent::make_add_track_event(123),
+                                                  RtEvent::make_remove_track_event(234)});
+    graph_events->at(0).returnable_event()->set_handled(true);
+    graph_events->at(1).returnable_event()->set_handled(false);
+    EventId id1 = graph_events->at(0).returnable_event()->event_id();
+    EventId id2 = graph_events->at(1).returnable_event()->event_id();
+    auto event = RtEvent::make_graph_transaction_event(graph_events, new std::vector<RtEvent>());
+    event.returnable_event()->set_handled(false);
+
+    /* The events of the transaction are returned individually and deleted by the receiver */
+    _queue.push(event);
+    ASSERT_FALSE(_module_under_test.wait_for_response(event.returnable_event()->event_id(), ZERO_TIMEOUT));
+    EXPECT_TRUE(_module_under_test.has_response(id1));
+    EXPECT_TRUE(_module_under_test.wait_for_response(id1, ZERO_TIMEOUT));
+    EXPECT_FALSE(_module_under_test.wait_for_response(id2, ZERO_TIMEOUT));
+    EXPECT_FALSE(_module_under_test.has_response(id2));
+}
+
+TEST_F(TestAsyncReceiver, TestNotification)
+{
+    auto event = RtEvent::make_insert_processor_event(nullptr);
+    event.returnable_event()->set_handled(true);
+    EventId id = event.returnable_event()->event_id();
+
+    std::thread rt_thread([&]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        _queue.push(event);
+        _module_under_test.notify();
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(_module_under_test.wait_for_response(id, std::chrono::seconds(10)));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    rt_thread.join();
+}
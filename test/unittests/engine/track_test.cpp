@@ -93,6 +93,9 @@ TEST_F(TrackTest, TestAddAndRemove)
     EXPECT_EQ(2u, _module_under_test._processors.size());
     EXPECT_EQ(&test_processor_2, _module_under_test._processors[0]);
     EXPECT_EQ(&test_processor, _module_under_test._processors[1]);
+    EXPECT_EQ(test_processor.id(), _module_under_test.next_processor(test_processor_2.id()));
+    EXPECT_FALSE(_module_under_test.next_processor(test_processor.id()).has_value());
+    EXPECT_FALSE(_module_under_test.next_processor(1234567u).has_value());
 
     EXPECT_TRUE(_module_under_test.remove(test_processor.id()));
     EXPECT_TRUE(_module_under_test.remove(test_processor_2.id()));
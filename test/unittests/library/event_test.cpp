@@ -81,6 +81,15 @@ TEST(EventTest, TestToRtEvent)
     EXPECT_EQ(50u, rt_event.parameter_change_event()->param_id());
     EXPECT_FLOAT_EQ(1.0f, rt_event.parameter_change_event()->value());
 
+    auto param_batch_event = ParameterChangeBatchEvent({{6, 50, 1.0f}, {7, 51, 0.5f}}, IMMEDIATE_PROCESS);
+    EXPECT_FALSE(param_batch_event.maps_to_rt_event());
+    rt_event = param_batch_event.change_to_rt_event(1, 9);
+    EXPECT_EQ(RtEventType::FLOAT_PARAMETER_CHANGE, rt_event.type());
+    EXPECT_EQ(9, rt_event.sample_offset());
+    EXPECT_EQ(7u, rt_event.parameter_change_event()->processor_id());
+    EXPECT_EQ(51u, rt_event.parameter_change_event()->param_id());
+    EXPECT_FLOAT_EQ(0.5f, rt_event.parameter_change_event()->value());
+
     BlobData testdata = {0, nullptr};
     auto data_pro_ch_event = DataPropertyEvent(8, 52, testdata, IMMEDIATE_PROCESS);
     EXPECT_TRUE(data_pro_ch_event.maps_to_rt_event());
@@ -258,3 +267,53 @@ TEST(EventTest, TestFromRtEvent)
     EXPECT_TRUE(event->process_asynchronously());
     delete event;
 }
+
+TEST(EventPoolTest, TestBlockRecycling)
+{
+    EventPool pool;
+    EXPECT_EQ(0, pool.capacity());
+    void* block_1 = pool.allocate(48);
+    void* block_2 = pool.allocate(100);
+    ASSERT_NE(nullptr, block_1);
+    ASSERT_NE(nullptr, block_2);
+    EXPECT_EQ(2 * EVENT_POOL_BLOCKS_PER_SLAB, pool.capacity());
+    EXPECT_EQ(2 * EVENT_POOL_BLOCKS_PER_SLAB - 2, pool.free_blocks());
+
+    /* A freed block should be reused by the next allocation of the same size class */
+    pool.deallocate(block_1, 48);
+    EXPECT_EQ(block_1, pool.allocate(64));
+    pool.deallocate(block_1, 64);
+    pool.deallocate(block_2, 100);
+    EXPECT_EQ(2 * EVENT_POOL_BLOCKS_PER_SLAB, pool.free_blocks());
+
+    /* Large objects are not pooled */
+    void* large_block = pool.allocate(EVENT_POOL_MAX_BLOCK_SIZE + 1);
+    EXPECT_EQ(2 * EVENT_POOL_BLOCKS_PER_SLAB, pool.capacity());
+    pool.deallocate(large_block, EVENT_POOL_MAX_BLOCK_SIZE + 1);
+}
+
+TEST(EventPoolTest, TestEventsArePooled)
+{
+    static_assert(sizeof(KeyboardEvent) <= EVENT_POOL_MAX_BLOCK_SIZE);
+    static_assert(sizeof(ParameterChangeNotificationEvent) <= EVENT_POOL_MAX_BLOCK_SIZE);
+    static_assert(sizeof(ParameterChangeEvent) <= EVENT_POOL_MAX_BLOCK_SIZE);
+
+    /* Warm up the pool, after that creating and deleting events should not grow it */
+    std::vector<Event*> events;
+    for (int i = 0; i < EVENT_POOL_BLOCKS_PER_SLAB; ++i)
+    {
+        events.push_back(new KeyboardEvent(KeyboardEvent::Subtype::NOTE_ON, 1, 0, 48, 1.0f, IMMEDIATE_PROCESS));
+    }
+    for (auto event : events)
+    {
+        delete event;
+    }
+    int capacity = event_pool().capacity();
+    for (int i = 0; i < 10 * EVENT_POOL_BLOCKS_PER_SLAB; ++i)
+    {
+        Event* event = new KeyboardEvent(KeyboardEvent::Subtype::NOTE_ON, 1, 0, 48, 1.0f, IMMEDIATE_PROCESS);
+        EXPECT_EQ(48, static_cast<KeyboardEvent*>(event)->note());
+        delete event;
+    }
+    EXPECT_EQ(capacity, event_pool().capacity());
+}
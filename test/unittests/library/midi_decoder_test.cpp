@@ -128,3 +128,79 @@ TEST (MidiDecoderTest, TestDecodeSongSelect)
     EXPECT_EQ(35, msg.index);
 }
 
+
+TEST (MidiDecoderTest, TestDecodeMessageSize)
+{
+    EXPECT_EQ(3, decode_message_size(TEST_NOTE_ON_MSG[0]));
+    EXPECT_EQ(3, decode_message_size(TEST_PITCH_B_MSG[0]));
+    EXPECT_EQ(2, decode_message_size(TEST_CHAN_PRES_MSG[0]));
+    EXPECT_EQ(2, decode_message_size(TEST_TIME_CODE_MSG[0]));
+    EXPECT_EQ(3, decode_message_size(TEST_SONG_POS_MSG[0]));
+    EXPECT_EQ(1, decode_message_size(TEST_CLOCK_MSG[0]));
+    EXPECT_EQ(0, decode_message_size(0xF0));
+}
+
+TEST (MidiDecoderTest, TestStreamParser)
+{
+    MidiStreamParser parser;
+    /* Note on followed by 2 note ons using running status and a program change */
+    const uint8_t stream[] = {0x92, 62, 55, 64, 100, 65, 0, 0xC5, 18};
+    std::vector<MidiDataByte> messages;
+    for (auto byte : stream)
+    {
+        if (parser.parse(byte))
+        {
+            messages.push_back(parser.message());
+        }
+    }
+    ASSERT_EQ(4u, messages.size());
+    EXPECT_EQ(TEST_NOTE_ON_MSG, messages[0]);
+    EXPECT_EQ(MidiDataByte({0x92, 64, 100, 0}), messages[1]);
+    EXPECT_EQ(MidiDataByte({0x92, 65, 0, 0}), messages[2]);
+    EXPECT_EQ(TEST_PROG_CH_MSG, messages[3]);
+    EXPECT_EQ(2, parser.message_size());
+
+    /* Running status for single data byte messages */
+    ASSERT_TRUE(parser.parse(19));
+    EXPECT_EQ(MidiDataByte({0xC5, 19, 0, 0}), parser.message());
+
+    /* Data without a preceding status byte should be ignored */
+    parser.reset();
+    EXPECT_FALSE(parser.parse(60));
+    EXPECT_FALSE(parser.parse(45));
+}
+
+TEST (MidiDecoderTest, TestStreamParserSystemMessages)
+{
+    MidiStreamParser parser;
+    /* Real time messages in the middle of a message don't interrupt it */
+    EXPECT_FALSE(parser.parse(0x81));
+    EXPECT_FALSE(parser.parse(60));
+    ASSERT_TRUE(parser.parse(0xF8));
+    EXPECT_EQ(TEST_CLOCK_MSG, parser.message());
+    EXPECT_EQ(1, parser.message_size());
+    ASSERT_TRUE(parser.parse(45));
+    EXPECT_EQ(TEST_NOTE_OFF_MSG, parser.message());
+
+    /* System common messages cancel running status */
+    EXPECT_FALSE(parser.parse(0xF2));
+    EXPECT_FALSE(parser.parse(0x05));
+    ASSERT_TRUE(parser.parse(0x02));
+    EXPECT_EQ(TEST_SONG_POS_MSG, parser.message());
+    EXPECT_FALSE(parser.parse(0x05));
+
+    /* Sysex data is skipped */
+    EXPECT_FALSE(parser.parse(0xF0));
+    EXPECT_FALSE(parser.parse(0x7D));
+    EXPECT_FALSE(parser.parse(0x10));
+    EXPECT_FALSE(parser.parse(0xF7));
+    EXPECT_FALSE(parser.parse(0x10));
+
+    /* A new status byte discards an incomplete message */
+    EXPECT_FALSE(parser.parse(0xB4));
+    EXPECT_FALSE(parser.parse(67));
+    EXPECT_FALSE(parser.parse(0xA3));
+    EXPECT_FALSE(parser.parse(70));
+    ASSERT_TRUE(parser.parse(65));
+    EXPECT_EQ(TEST_POLY_PRES_MSG, parser.message());
+}
@@ -0,0 +1,106 @@
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "library/mpsc_fifo.h"
+
+using namespace sushi;
+
+constexpr int FIFO_SIZE = 8;
+
+class TestMpscFifo : public ::testing::Test
+{
+protected:
+    TestMpscFifo() {}
+
+    MpscFifo<int> _module_under_test{FIFO_SIZE};
+};
+
+TEST_F(TestMpscFifo, TestOperation)
+{
+    int value;
+    EXPECT_TRUE(_module_under_test.empty());
+    EXPECT_FALSE(_module_under_test.pop(value));
+
+    for (int i = 0; i < FIFO_SIZE; ++i)
+    {
+        EXPECT_TRUE(_module_under_test.push(i));
+    }
+    EXPECT_FALSE(_module_under_test.push(FIFO_SIZE));
+    EXPECT_FALSE(_module_under_test.empty());
+    EXPECT_EQ(FIFO_SIZE, static_cast<int>(_module_under_test.size()));
+
+    // Wrap around a few times
+    for (int i = 0; i < 3 * FIFO_SIZE; ++i)
+    {
+        ASSERT_TRUE(_module_under_test.pop(value));
+        EXPECT_EQ(i, value);
+        EXPECT_TRUE(_module_under_test.push(i + FIFO_SIZE));
+    }
+    for (int i = 3 * FIFO_SIZE; i < 4 * FIFO_SIZE; ++i)
+    {
+        ASSERT_TRUE(_module_under_test.pop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_TRUE(_module_under_test.empty());
+}
+
+TEST_F(TestMpscFifo, TestResize)
+{
+    _module_under_test.push(1);
+    _module_under_test.resize(FIFO_SIZE + 1);
+    EXPECT_EQ(2u * FIFO_SIZE, _module_under_test.capacity());
+    EXPECT_TRUE(_module_under_test.empty());
+    for (int i = 0; i < 2 * FIFO_SIZE; ++i)
+    {
+        EXPECT_TRUE(_module_under_test.push(i));
+    }
+    EXPECT_FALSE(_module_under_test.push(0));
+}
+
+TEST_F(TestMpscFifo, TestMultipleProducers)
+{
+    constexpr int PRODUCERS = 4;
+    constexpr int VALUES_PER_PRODUCER = 1000;
+    MpscFifo<int> fifo(64);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&fifo, p]()
+        {
+            for (int i = 0; i < VALUES_PER_PRODUCER; ++i)
+            {
+                while (fifo.push(p * VALUES_PER_PRODUCER + i) == false)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Values from each producer should come out in order and none should be lost
+    std::vector<int> last_value(PRODUCERS, -1);
+    int received = 0;
+    while (received < PRODUCERS * VALUES_PER_PRODUCER)
+    {
+        int value;
+        if (fifo.pop(value))
+        {
+            int producer = value / VALUES_PER_PRODUCER;
+            ASSERT_GT(value % VALUES_PER_PRODUCER, last_value[producer]);
+            last_value[producer] = value % VALUES_PER_PRODUCER;
+            received++;
+        }
+    }
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+    EXPECT_TRUE(fifo.empty());
+    for (auto last : last_value)
+    {
+        EXPECT_EQ(VALUES_PER_PRODUCER - 1, last);
+    }
+}
@@ -1,3 +1,6 @@
+#include <future>
+#include <thread>
+
 #include "gtest/gtest.h"
 
 #define private public
@@ -103,3 +106,160 @@ TEST_F(TestPerformanceTimer, TestClearRecords)
     ASSERT_FLOAT_EQ(100.0f, t.min_case);
     ASSERT_FLOAT_EQ(0.0f, t.max_case);
 }
+
+TEST_F(TestPerformanceTimer, TestConcurrentLogging)
+{
+    auto log_from_thread = [&](int id)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            auto start = virtual_wait(_module_under_test.start_timer(), 2);
+            _module_under_test.stop_timer_rt_safe(start, id);
+        }
+    };
+    std::thread thread_1(log_from_thread, 1);
+    std::thread thread_2(log_from_thread, 2);
+    log_from_thread(3);
+    thread_1.join();
+    thread_2.join();
+    _module_under_test._update_timings();
+
+    for (int id : {1, 2, 3})
+    {
+        auto timings = _module_under_test.timings_for_node(id);
+        ASSERT_TRUE(timings.has_value());
+        ASSERT_GT(timings.value().avg_case, 0.0f);
+    }
+    /* Slots are released when their threads exit */
+    int claimed = 0;
+    for (const auto& slot : _module_under_test._thread_slots)
+    {
+        claimed += slot->claimed.load() ? 1 : 0;
+    }
+    ASSERT_EQ(1, claimed);
+}
+
+TEST(TestPerformanceTimerThreads, TestThreadSlotsAreReleased)
+{
+    PerformanceTimer module_under_test(2);
+    module_under_test.set_timing_period(TEST_PERIOD);
+    module_under_test._enabled = true;
+
+    auto log_from_thread = [&](int id)
+    {
+        auto start = virtual_wait(module_under_test.start_timer(), 2);
+        module_under_test.stop_timer_rt_safe(start, id);
+    };
+    /* More threads than slots over the lifetime of the timer, but never more than 2 at once */
+    for (int id = 1; id <= 5; ++id)
+    {
+        std::thread thread(log_from_thread, id);
+        thread.join();
+    }
+    module_under_test._update_timings();
+    for (int id = 1; id <= 5; ++id)
+    {
+        ASSERT_TRUE(module_under_test.timings_for_node(id).has_value());
+    }
+    ASSERT_FALSE(module_under_test._slots_exhausted.load());
+
+    /* This thread and a thread kept alive take both slots, a third thread is dropped */
+    log_from_thread(6);
+    std::promise<void> logged;
+    std::promise<void> release;
+    std::thread holding_thread([&]()
+    {
+        log_from_thread(7);
+        logged.set_value();
+        release.get_future().wait();
+    });
+    logged.get_future().wait();
+    std::thread dropped_thread(log_from_thread, 8);
+    dropped_thread.join();
+    release.set_value();
+    holding_thread.join();
+    module_under_test._update_timings();
+    ASSERT_TRUE(module_under_test.timings_for_node(7).has_value());
+    ASSERT_FALSE(module_under_test.timings_for_node(8).has_value());
+    ASSERT_TRUE(module_under_test._slots_exhausted.load());
+}
+
+TEST_F(TestPerformanceTimer, TestPercentilesAndOverruns)
+{
+    for (int i = 1; i <= 100; ++i)
+    {
+        auto start = _module_under_test.start_timer();
+        /* 1 in 100 timings is longer than the period */
+        _module_under_test.stop_timer(virtual_wait(start, i == 100 ? 20 : 1 + i / 20), 1);
+    }
+    _module_under_test._update_timings();
+
+    auto timings = _module_under_test.timings_for_node(1);
+    ASSERT_TRUE(timings.has_value());
+    auto t = timings.value();
+    EXPECT_EQ(1, t.overruns);
+    EXPECT_LE(t.p50_case, t.p90_case);
+    EXPECT_LE(t.p90_case, t.p99_case);
+    EXPECT_LE(t.p99_case, t.p999_case);
+    EXPECT_NEAR(0.3f, t.p50_case, 0.03f);
+    EXPECT_GT(t.p999_case, 1.0f);
+
+    ASSERT_TRUE(_module_under_test.clear_timings_for_node(1));
+    t = _module_under_test.timings_for_node(1).value();
+    EXPECT_EQ(0, t.overruns);
+    EXPECT_FLOAT_EQ(0.0f, t.p99_case);
+}
+
+TEST(TestTimingHistogram, TestPercentiles)
+{
+    TimingHistogram histogram;
+    ASSERT_EQ(0, histogram.percentile(0.5f));
+    for (int64_t i = 1; i <= 1000; ++i)
+    {
+        histogram.add(i * 1000);
+    }
+    ASSERT_EQ(1000u, histogram.count());
+    EXPECT_NEAR(500'000, histogram.percentile(0.5f), 500'000 / 32);
+    EXPECT_NEAR(990'000, histogram.percentile(0.99f), 990'000 / 32);
+    EXPECT_NEAR(1000, histogram.percentile(0.0f), 1000 / 32);
+
+    histogram.add(INT64_MAX);
+    EXPECT_GT(histogram.percentile(1.0f), 1'000'000);
+
+    histogram.clear();
+    ASSERT_EQ(0u, histogram.count());
+}
+
+TEST_F(TestPerformanceTimer, TestFlightRecorder)
+{
+    _module_under_test.enable_flight_recorder(-1, 2);
+    auto now = _module_under_test.start_timer();
+    /* Simulate 3 periods with one node and an engine node each. The engine records
+     * are logged directly with their durations, only the last period overruns */
+    for (int i = 0; i < 3; ++i)
+    {
+        auto period_start = now - (3 - i) * TEST_PERIOD * 2;
+        auto duration = i < 2 ? TEST_PERIOD / 2 : TEST_PERIOD * 3 / 2;
+        _module_under_test.stop_timer_rt_safe(period_start, 1);
+        _module_under_test._entry_queue.push({-1, period_start, duration});
+    }
+    _module_under_test._update_timings();
+    auto misses = _module_under_test.deadline_misses();
+    ASSERT_EQ(1u, misses.size());
+
+    auto& miss = misses.back();
+    EXPECT_EQ(-1, miss.trigger.id);
+    ASSERT_FALSE(miss.records.empty());
+    for (const auto& record : miss.records)
+    {
+        EXPECT_GE(record.start_time, miss.trigger.start_time - 2 * TEST_PERIOD);
+    }
+    /* The overrunning period and the one before it */
+    EXPECT_EQ(4u, miss.records.size());
+    EXPECT_TRUE(_module_under_test.deadline_misses().empty());
+
+    _module_under_test.enable_flight_recorder(-1, 0);
+    _module_under_test.stop_timer(now - TEST_PERIOD * 2, -1);
+    _module_under_test._update_timings();
+    EXPECT_TRUE(_module_under_test.deadline_misses().empty());
+}
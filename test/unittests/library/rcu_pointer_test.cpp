@@ -0,0 +1,65 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "library/rcu_pointer.h"
+
+using namespace sushi;
+
+constexpr int UPDATES = 1000;
+
+struct TestData
+{
+    int a;
+    int b;
+};
+
+class TestRcuPointer : public ::testing::Test
+{
+protected:
+    TestRcuPointer() {}
+
+    RcuPointer<TestData> _module_under_test{std::make_unique<TestData>(TestData{0, 0})};
+};
+
+TEST_F(TestRcuPointer, TestReadAndUpdate)
+{
+    {
+        auto data = _module_under_test.read();
+        EXPECT_EQ(0, data->a);
+    }
+    _module_under_test.update(std::make_unique<TestData>(TestData{1, -1}));
+    auto data = _module_under_test.read();
+    EXPECT_EQ(1, data->a);
+    EXPECT_EQ(-1, (*data).b);
+}
+
+TEST_F(TestRcuPointer, TestConcurrentReaders)
+{
+    std::atomic<bool> running{true};
+    std::atomic<int> inconsistent_reads{0};
+    auto reader = [&]()
+    {
+        while (running)
+        {
+            auto data = _module_under_test.read();
+            if (data->a != -data->b)
+            {
+                inconsistent_reads++;
+            }
+        }
+    };
+
+    std::thread reader_1(reader);
+    std::thread reader_2(reader);
+    for (int i = 1; i <= UPDATES; ++i)
+    {
+        _module_under_test.update(std::make_unique<TestData>(TestData{i, -i}));
+    }
+    running = false;
+    reader_1.join();
+    reader_2.join();
+
+    EXPECT_EQ(0, inconsistent_reads);
+    EXPECT_EQ(UPDATES, _module_under_test.read()->a);
+}
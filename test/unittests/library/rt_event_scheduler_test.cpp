@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+
+#include "library/rt_event_scheduler.h"
+
+using namespace sushi;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+constexpr int SCHEDULER_SIZE = 4;
+/* Chunk time rounded to microseconds, as calculated by the scheduler */
+constexpr Time CHUNK_TIME = std::chrono::microseconds(1000000 * AUDIO_CHUNK_SIZE / 48000);
+
+class TestRtEventScheduler : public ::testing::Test
+{
+protected:
+    TestRtEventScheduler() {}
+
+    RtEventScheduler<SCHEDULER_SIZE> _module_under_test{TEST_SAMPLE_RATE};
+};
+
+TEST_F(TestRtEventScheduler, TestOrdering)
+{
+    Time start = std::chrono::seconds(1);
+    EXPECT_TRUE(_module_under_test.empty());
+    EXPECT_TRUE(_module_under_test.schedule({start + 3 * CHUNK_TIME, RtEvent::make_note_on_event(3, 0, 0, 48, 1.0f)}));
+    EXPECT_TRUE(_module_under_test.schedule({start + CHUNK_TIME, RtEvent::make_note_on_event(1, 0, 0, 48, 1.0f)}));
+    EXPECT_TRUE(_module_under_test.schedule({start + CHUNK_TIME, RtEvent::make_note_off_event(2, 0, 0, 48, 1.0f)}));
+    EXPECT_TRUE(_module_under_test.schedule({start, RtEvent::make_note_on_event(0, 0, 0, 48, 1.0f)}));
+    EXPECT_TRUE(_module_under_test.full());
+    EXPECT_FALSE(_module_under_test.schedule({start, RtEvent::make_note_on_event(0, 0, 0, 48, 1.0f)}));
+
+    RtEvent event;
+    EXPECT_TRUE(_module_under_test.has_due_event(start));
+    ASSERT_TRUE(_module_under_test.pop_due_event(start, event));
+    EXPECT_EQ(0u, event.processor_id());
+    EXPECT_FALSE(_module_under_test.has_due_event(start));
+    EXPECT_FALSE(_module_under_test.pop_due_event(start, event));
+
+    /* Events with the same timestamp should come out in the order they were scheduled */
+    ASSERT_TRUE(_module_under_test.pop_due_event(start + CHUNK_TIME, event));
+    EXPECT_EQ(1u, event.processor_id());
+    ASSERT_TRUE(_module_under_test.pop_due_event(start + CHUNK_TIME, event));
+    EXPECT_EQ(2u, event.processor_id());
+    EXPECT_EQ(RtEventType::NOTE_OFF, event.type());
+    EXPECT_FALSE(_module_under_test.pop_due_event(start + CHUNK_TIME, event));
+
+    /* Overdue events should be released with offset 0 */
+    ASSERT_TRUE(_module_under_test.pop_due_event(start + 5 * CHUNK_TIME, event));
+    EXPECT_EQ(3u, event.processor_id());
+    EXPECT_EQ(0, event.sample_offset());
+    EXPECT_TRUE(_module_under_test.empty());
+}
+
+TEST_F(TestRtEventScheduler, TestSampleOffset)
+{
+    Time chunk_start = std::chrono::seconds(1);
+    _module_under_test.schedule({chunk_start + CHUNK_TIME / 2, RtEvent::make_parameter_change_event(1, 0, 2, 0.5f)});
+
+    RtEvent event;
+    EXPECT_FALSE(_module_under_test.pop_due_event(chunk_start - CHUNK_TIME, event));
+    ASSERT_TRUE(_module_under_test.pop_due_event(chunk_start, event));
+    EXPECT_EQ(RtEventType::FLOAT_PARAMETER_CHANGE, event.type());
+    EXPECT_NEAR(AUDIO_CHUNK_SIZE / 2, event.sample_offset(), 1);
+    EXPECT_FLOAT_EQ(0.5f, event.parameter_change_event()->value());
+}
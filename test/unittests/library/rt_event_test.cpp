@@ -132,6 +132,11 @@ TEST (TestRealtimeEvents, TestFactoryFunction)
     EXPECT_EQ(123u, event.processor_reorder_event()->processor());
     EXPECT_EQ(456u, event.processor_reorder_event()->track());
 
+    event = RtEvent::make_add_track_event(ObjectId(456), 2);
+    EXPECT_EQ(RtEventType::ADD_TRACK, event.type());
+    EXPECT_EQ(456u, event.add_track_event()->track());
+    EXPECT_EQ(2, event.add_track_event()->core().value_or(-1));
+
     event = RtEvent::make_tempo_event(25, 130);
     EXPECT_EQ(RtEventType::TEMPO, event.type());
     EXPECT_EQ(25, event.tempo_event()->sample_offset());
@@ -219,6 +224,19 @@ TEST (TestRealtimeEvents, TestFactoryFunction)
     EXPECT_TRUE(event.gate_connection_event()->output_connection());
 }
 
+TEST(TestRealtimeEvents, TestFactoryFunctionGraphTransaction)
+{
+    std::vector<RtEvent> graph_events = {RtEvent::make_add_track_event(12), RtEvent::make_remove_track_event(13)};
+    std::vector<RtEvent> undo_events;
+    auto event = RtEvent::make_graph_transaction_event(&graph_events, &undo_events);
+    EXPECT_EQ(RtEventType::GRAPH_TRANSACTION, event.type());
+    auto typed_event = event.graph_transaction_event();
+    EXPECT_EQ(&graph_events, typed_event->events());
+    EXPECT_EQ(&undo_events, typed_event->undo_events());
+    EXPECT_EQ(2u, typed_event->events()->size());
+    EXPECT_EQ(ReturnableRtEvent::EventStatus::UNHANDLED, typed_event->status());
+}
+
 TEST(TestRealtimeEvents, TestReturnableEvents)
 {
     auto event = RtEvent::make_stop_engine_event();
@@ -0,0 +1,41 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "library/rt_safe_notifier.h"
+
+using namespace sushi;
+
+constexpr auto SHORT_TIMEOUT = std::chrono::milliseconds(1);
+constexpr auto LONG_TIMEOUT = std::chrono::seconds(5);
+
+TEST(TestRtSafeNotifier, TestTimeout)
+{
+    RtSafeNotifier module_under_test;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(module_under_test.wait_for(SHORT_TIMEOUT));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, SHORT_TIMEOUT);
+}
+
+TEST(TestRtSafeNotifier, TestNotificationsAreCoalesced)
+{
+    RtSafeNotifier module_under_test;
+    module_under_test.notify();
+    module_under_test.notify();
+    EXPECT_TRUE(module_under_test.wait_for(SHORT_TIMEOUT));
+    EXPECT_FALSE(module_under_test.wait_for(SHORT_TIMEOUT));
+}
+
+TEST(TestRtSafeNotifier, TestWakeupFromOtherThread)
+{
+    RtSafeNotifier module_under_test;
+    auto start = std::chrono::steady_clock::now();
+    std::thread notifying_thread([&]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        module_under_test.notify();
+    });
+    EXPECT_TRUE(module_under_test.wait_for(LONG_TIMEOUT));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, LONG_TIMEOUT);
+    notifying_thread.join();
+}
@@ -423,3 +423,76 @@ TEST (TestSampleBuffer, TestRMSCalculation)
     EXPECT_FLOAT_EQ(1, buffer.calc_rms_value(0));
     EXPECT_NEAR(1.0f / std::sqrt(2), buffer.calc_rms_value(1), 0.01);
 }
+
+TEST (TestSampleBuffer, TestAlignment)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> buffer(3);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(buffer.channel(0)) % SAMPLE_BUFFER_ALIGNMENT);
+    SampleBuffer<AUDIO_CHUNK_SIZE> copy(buffer);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(copy.channel(0)) % SAMPLE_BUFFER_ALIGNMENT);
+}
+
+TEST (TestSampleBuffer, TestAddWithRampFromOtherBuffer)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> buffer(2);
+    SampleBuffer<AUDIO_CHUNK_SIZE> source(2);
+    std::fill(source.channel(0), source.channel(0) + AUDIO_CHUNK_SIZE, 1.0f);
+    std::fill(source.channel(1), source.channel(1) + AUDIO_CHUNK_SIZE, 2.0f);
+
+    buffer.add_with_ramp(source, 0.0f, 1.0f);
+    EXPECT_FLOAT_EQ(0.0f, buffer.channel(0)[0]);
+    EXPECT_FLOAT_EQ(1.0f, buffer.channel(0)[AUDIO_CHUNK_SIZE - 1]);
+    EXPECT_FLOAT_EQ(2.0f, buffer.channel(1)[AUDIO_CHUNK_SIZE - 1]);
+}
+
+TEST (TestSampleBufferKernels, TestOddSampleCounts)
+{
+    /* Unaligned and not a multiple of the vector size to exercise the scalar tails */
+    constexpr int SAMPLES = 13;
+    float source[SAMPLES + 1];
+    float dest[SAMPLES + 1];
+    float* unaligned_source = source + 1;
+    float* unaligned_dest = dest + 1;
+    std::fill(unaligned_source, unaligned_source + SAMPLES, 2.0f);
+
+    std::fill(unaligned_dest, unaligned_dest + SAMPLES, 1.0f);
+    kernels::add(unaligned_dest, unaligned_source, SAMPLES);
+    kernels::add_with_gain(unaligned_dest, unaligned_source, 0.5f, SAMPLES);
+    kernels::apply_gain(unaligned_dest, 2.0f, SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        ASSERT_FLOAT_EQ(8.0f, unaligned_dest[i]);
+    }
+
+    std::fill(unaligned_dest, unaligned_dest + SAMPLES, 0.0f);
+    kernels::add_with_ramp(unaligned_dest, unaligned_source, 1.0f, 0.5f, SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        ASSERT_FLOAT_EQ(2.0f * (1.0f + i * 0.5f), unaligned_dest[i]);
+    }
+    kernels::ramp(unaligned_dest, 0.0f, 1.0f, SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        ASSERT_FLOAT_EQ(2.0f * (1.0f + i * 0.5f) * i, unaligned_dest[i]);
+    }
+
+    float left[SAMPLES];
+    float right[SAMPLES];
+    float interleaved[SAMPLES * 2];
+    for (int i = 0; i < SAMPLES * 2; ++i)
+    {
+        interleaved[i] = static_cast<float>(i);
+    }
+    kernels::deinterleave_stereo(left, right, interleaved, SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        ASSERT_FLOAT_EQ(2.0f * i, left[i]);
+        ASSERT_FLOAT_EQ(2.0f * i + 1, right[i]);
+    }
+    std::fill(interleaved, interleaved + SAMPLES * 2, 0.0f);
+    kernels::interleave_stereo(interleaved, left, right, SAMPLES);
+    for (int i = 0; i < SAMPLES * 2; ++i)
+    {
+        ASSERT_FLOAT_EQ(static_cast<float>(i), interleaved[i]);
+    }
+}
@@ -32,7 +32,8 @@ constexpr PlayingMode           DEFAULT_PLAYING_MODE = PlayingMode::PLAYING;
 constexpr SyncMode              DEFAULT_SYNC_MODE = SyncMode::INTERNAL;
 constexpr TimeSignature         DEFAULT_TIME_SIGNATURE = TimeSignature{4, 4};
 constexpr ControlStatus         DEFAULT_CONTROL_STATUS = ControlStatus::OK;
-constexpr CpuTimings            DEFAULT_TIMINGS = CpuTimings{1.0f, 0.5f, 1.5f};
+constexpr CpuTimings            DEFAULT_TIMINGS = CpuTimings{1.0f, 0.5f, 1.5f, 0.9f, 1.2f, 1.4f, 1.5f, 2};
+constexpr RtEventQueueStatistics DEFAULT_QUEUE_STATISTICS = RtEventQueueStatistics{1024, 12, 0, 1, 0, 0};
 constexpr int                   DEFAULT_PROGRAM_ID = 1;
 constexpr auto                  DEFAULT_PROGRAM_NAME = "program 1";
 const std::vector<std::string>  DEFAULT_PROGRAMS = {DEFAULT_PROGRAM_NAME, "program 2"};
@@ -192,6 +193,10 @@ public:
         return _return_status;
     }
 
+    RtEventQueueStatistics get_rt_event_queue_statistics() const override
+    {
+        return DEFAULT_QUEUE_STATISTICS;
+    }
 };
 
 class KeyboardControllerMockup : public KeyboardController, public TestableController
@@ -456,6 +461,20 @@ class ParameterControllerMockup : public ParameterController, public TestableCon
         return _return_status;
     }
 
+    ControlStatus set_parameter_values(const std::vector<ParameterValueChange>& changes) override
+    {
+        _args_from_last_call.clear();
+        _args_from_last_call["changes"] = std::to_string(changes.size());
+        if (changes.empty() == false)
+        {
+            _args_from_last_call["processor id"] = std::to_string(changes.back().processor_id);
+            _args_from_last_call["parameter id"] = std::to_string(changes.back().parameter_id);
+            _args_from_last_call["value"] = std::to_string(changes.back().value);
+        }
+        _recently_called = true;
+        return _return_status;
+    }
+
     std::pair<ControlStatus, std::vector<PropertyInfo>> get_processor_properties(int /*processor_id*/) const override
     {
         return {ControlStatus::OK, std::vector<PropertyInfo>({property_1})};
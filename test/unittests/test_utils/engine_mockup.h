@@ -200,6 +200,15 @@ public:
         return EngineReturnStatus::OK;
     }
 
+    EngineReturnStatus send_scheduled_rt_event(const RtEvent& event, Time timestamp) override
+    {
+        got_rt_event = true;
+        last_rt_event = event;
+        last_rt_event_time = timestamp;
+        scheduled_rt_events.push_back(event);
+        return EngineReturnStatus::OK;
+    }
+
     dispatcher::BaseEventDispatcher* event_dispatcher() override
     {
         return &_event_dispatcher;
@@ -213,6 +222,9 @@ public:
     bool process_called{false};
     bool got_event{false};
     bool got_rt_event{false};
+    RtEvent last_rt_event;
+    Time last_rt_event_time{IMMEDIATE_PROCESS};
+    std::vector<RtEvent> scheduled_rt_events;
 private:
     EventDispatcherMockup       _event_dispatcher;
     ProcessorContainerMockup    _processor_container;